@@ -0,0 +1,160 @@
+// CLOCK
+
+// Gives the modules one idea of what the time is
+// The time is read once at the start of each frame and kept in three forms.
+// Wall time is real time for things the user sees and hears, such as speech.
+// Sim time follows the simulation, it stops while paused and runs faster with
+// time compression, for anything that measures or controls the aircraft.
+// Unpaused time is real time that stops while paused, for effects the user
+// feels, which shouldn't speed up with the sim but shouldn't carry on while
+// everything is frozen
+// A long gap between frames, such as loading or the plugin being disabled,
+// only moves the wall time on
+// The time can be read from a function other than x-plane's, so a sequence of
+// frames can be replayed with exactly the same times
+
+#include "Clock.h"
+#include "Timing.h"
+
+// data references that we need
+static XPLMDataRef PausedRef      = NULL;
+static XPLMDataRef SimSpeedRef    = NULL;
+static XPLMDataRef GroundSpeedRef = NULL;
+
+static clock_source_f Source = NULL;
+static bool HaveSample;
+static double LastWall;
+// real time when the module was initialized, so the wall clock starts at 0
+static double WallStart;
+
+// the time at the start of the frame and the length of the frame
+static double Now[NUM_CLOCK_BASES];
+static float FrameTime[NUM_CLOCK_BASES];
+static bool Paused;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// reads the time from x-plane
+static void ReadSim
+  (
+  clock_sample_t *Sample  // filled with the time
+  )
+{
+  Sample->Wall = Timing_GetTime() - WallStart;
+  Sample->Paused = XPLMGetDatai(PausedRef) != 0;
+  // the sim speed is below 1 when x-plane can't keep up, the ground speed is the time compression
+  Sample->SimRate = XPLMGetDataf(SimSpeedRef) * XPLMGetDatai(GroundSpeedRef);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int Clock_Init
+  (
+  void
+  )
+{
+  Source = NULL;
+  HaveSample = FALSE;
+  WallStart = Timing_GetTime();
+  Paused = FALSE;
+  for (int b = 0; b < NUM_CLOCK_BASES; b++)
+  {
+    Now[b] = 0;
+    FrameTime[b] = 0;
+  }
+
+  // get datarefs
+  PausedRef = XPLMFindDataRef("sim/time/paused");
+  if (PausedRef == NULL)
+  {
+    return FALSE;
+  }
+  SimSpeedRef = XPLMFindDataRef("sim/time/sim_speed_actual");
+  if (SimSpeedRef == NULL)
+  {
+    return FALSE;
+  }
+  GroundSpeedRef = XPLMFindDataRef("sim/time/ground_speed");
+  if (GroundSpeedRef == NULL)
+  {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+// reads the time, called by the scheduler at the start of every frame
+void Clock_Update
+  (
+  void
+  )
+{
+  clock_sample_t Sample;
+  if (Source != NULL) Source(&Sample);
+  else ReadSim(&Sample);
+
+  float Elapsed = HaveSample ? (float)(Sample.Wall - LastWall) : 0;
+  if (Elapsed < 0) Elapsed = 0;
+  LastWall = Sample.Wall;
+  HaveSample = TRUE;
+  Paused = Sample.Paused;
+
+  FrameTime[CLOCK_WALL] = Elapsed;
+  if ((Paused) || (Elapsed > CLOCK_MAX_FRAME_TIME))
+  {
+    FrameTime[CLOCK_SIM] = 0;
+    FrameTime[CLOCK_UNPAUSED] = 0;
+  }
+  else
+  {
+    FrameTime[CLOCK_SIM] = Elapsed * (Sample.SimRate > 0 ? Sample.SimRate : 0);
+    FrameTime[CLOCK_UNPAUSED] = Elapsed;
+  }
+
+  for (int b = 0; b < NUM_CLOCK_BASES; b++) Now[b] += FrameTime[b];
+}
+
+// changes where the time is read from, NULL for x-plane
+// the clocks carry on from where they are, the next frame takes no time
+void Clock_SetSource
+  (
+  clock_source_f NewSource
+  )
+{
+  Source = NewSource;
+  HaveSample = FALSE;
+}
+
+// gets the time at the start of the frame
+// returns the time in seconds from an arbitrary starting point
+double Clock_Get
+  (
+  clock_base_t Base
+  )
+{
+  return Now[Base];
+}
+
+// gets the length of the last frame
+// returns the time in seconds, 0 while paused for the paused aware clocks
+float Clock_GetFrameTime
+  (
+  clock_base_t Base
+  )
+{
+  return FrameTime[Base];
+}
+
+// returns TRUE if the sim is paused
+bool Clock_IsPaused
+  (
+  void
+  )
+{
+  return Paused;
+}
@@ -0,0 +1,72 @@
+#ifndef _CLOCKH_
+#define _CLOCKH_
+
+#include "Global.h"
+
+// a frame longer than this, in seconds, is loading or the plugin being disabled, not flying
+#define CLOCK_MAX_FRAME_TIME 1.0f
+
+// the ways of measuring time
+typedef enum _clock_base_t
+{
+  CLOCK_WALL,      // real time, always runs
+  CLOCK_SIM,       // simulated time, stops while paused and runs faster with time compression
+  CLOCK_UNPAUSED,  // real time that stops while the sim is paused
+  NUM_CLOCK_BASES
+} clock_base_t;
+
+// what the clock reads once per frame
+typedef struct _clock_sample_t
+{
+  double Wall;     // real time in seconds from an arbitrary starting point, never goes backwards
+  bool Paused;     // TRUE if the sim is paused
+  float SimRate;   // seconds of simulated time per second of real time when not paused
+} clock_sample_t;
+
+// function that reads the time, so a recorded or made up time can be used instead of x-plane's
+typedef void (*clock_source_f)
+  (
+  clock_sample_t *Sample  // filled with the time
+  );
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int Clock_Init
+  (
+  void
+  );
+
+// reads the time, called by the scheduler at the start of every frame
+extern void Clock_Update
+  (
+  void
+  );
+
+// changes where the time is read from, NULL for x-plane
+// the clocks carry on from where they are, the next frame takes no time
+extern void Clock_SetSource
+  (
+  clock_source_f NewSource
+  );
+
+// gets the time at the start of the frame
+// returns the time in seconds from an arbitrary starting point
+extern double Clock_Get
+  (
+  clock_base_t Base
+  );
+
+// gets the length of the last frame
+// returns the time in seconds, 0 while paused for the paused aware clocks
+extern float Clock_GetFrameTime
+  (
+  clock_base_t Base
+  );
+
+// returns TRUE if the sim is paused
+extern bool Clock_IsPaused
+  (
+  void
+  );
+
+#endif // _CLOCKH_
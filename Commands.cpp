@@ -0,0 +1,360 @@
+// COMMANDS
+
+// Owns every x-plane command the plugin holds down or presses
+// The modules say which commands they want held and the commands are begun
+// and ended once per frame, so a command that is released and held again in
+// the same frame isn't ended and begun, and a command can't be left held
+// when a state is skipped. Everything is released straight away when the
+// session is reset, and when the plugin is disabled or stopped
+// The handlers for our own commands are also kept here, so they can be
+// unregistered while the plugin is disabled and registered again when enabled
+
+#include "Commands.h"
+#include "Diagnostic.h"
+#include "Profile.h"
+#include "Scheduler.h"
+#include "Clock.h"
+
+// a command that is held or pulsed
+typedef struct _command_slot_t
+{
+  XPLMCommandRef Command;  // NULL when the slot is free
+  bool Wanted;             // TRUE if the module wants it held
+  bool Held;               // TRUE if we have begun it
+  bool Pulse;              // TRUE to press it once on the next frame
+  double ReleaseTime;      // elapsed time to release a timed hold, 0 if not timed
+} command_slot_t;
+
+// a handler for one of our commands
+typedef struct _command_handler_t
+{
+  XPLMCommandRef Command;
+  XPLMCommandCallback_f Handler;
+  int Before;
+  void *Refcon;
+} command_handler_t;
+
+static command_slot_t Slots[COMMANDS_MAX_ACTIVE];
+static int IssueTask = -1;
+
+static command_handler_t Handlers[COMMANDS_MAX_HANDLERS];
+static int NumHandlers;
+// TRUE while the handlers are registered with x-plane
+static bool HandlersRegistered;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// finds the slot of a command
+// returns the slot, or NULL if the command isn't held or pulsed
+static command_slot_t *FindSlot
+  (
+  XPLMCommandRef Command
+  )
+{
+  for (int s = 0; s < COMMANDS_MAX_ACTIVE; s++)
+  {
+    if (Slots[s].Command == Command) return &Slots[s];
+  }
+
+  return NULL;
+}
+
+// finds the slot of a command, or a free slot for it
+// returns the slot, or NULL if there is no more space
+static command_slot_t *GetSlot
+  (
+  XPLMCommandRef Command
+  )
+{
+  command_slot_t *Slot = FindSlot(Command);
+  if (Slot != NULL) return Slot;
+
+  Slot = FindSlot(NULL);
+  if (Slot == NULL)
+  {
+#if DIAGNOSTIC == 1
+    Diagnostic_printf("No room for another command\n");
+#endif // DIAGNOSTIC
+    return NULL;
+  }
+
+  Slot->Command = Command;
+  Slot->Wanted = FALSE;
+  Slot->Held = FALSE;
+  Slot->Pulse = FALSE;
+  Slot->ReleaseTime = 0;
+  return Slot;
+}
+
+// begins and ends the commands that have changed, called by x-plane once per frame while there are changes
+// returns the time to the next timed release, or 0 if there isn't one
+static float IssueCommands
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  double Now = Clock_Get(CLOCK_WALL);
+  double NextRelease = 0;
+
+  // releases first, so switching from one command to another doesn't hold both
+  for (int s = 0; s < COMMANDS_MAX_ACTIVE; s++)
+  {
+    command_slot_t *Slot = &Slots[s];
+    if (Slot->Command == NULL) continue;
+
+    if ((Slot->ReleaseTime > 0) && (Now >= Slot->ReleaseTime))
+    {
+      Slot->Wanted = FALSE;
+      Slot->ReleaseTime = 0;
+    }
+
+    if (Slot->Held && (Slot->Wanted == FALSE))
+    {
+      XPLMCommandEnd(Slot->Command);
+      Slot->Held = FALSE;
+    }
+  }
+
+  for (int s = 0; s < COMMANDS_MAX_ACTIVE; s++)
+  {
+    command_slot_t *Slot = &Slots[s];
+    if (Slot->Command == NULL) continue;
+
+    if (Slot->Wanted && (Slot->Held == FALSE))
+    {
+      XPLMCommandBegin(Slot->Command);
+      Slot->Held = TRUE;
+    }
+
+    // a command that is held down can't also be pressed
+    if (Slot->Pulse && (Slot->Held == FALSE)) XPLMCommandOnce(Slot->Command);
+    Slot->Pulse = FALSE;
+
+    if (Slot->ReleaseTime > 0)
+    {
+      if ((NextRelease == 0) || (Slot->ReleaseTime < NextRelease)) NextRelease = Slot->ReleaseTime;
+    }
+
+    if ((Slot->Wanted == FALSE) && (Slot->Held == FALSE)) Slot->Command = NULL;
+  }
+
+  if (NextRelease == 0) return 0;
+  return (float)(NextRelease - Now) > 0 ? (float)(NextRelease - Now) : -1.0f;
+}
+
+// issues the changes on the next frame
+static void ScheduleIssue
+  (
+  void
+  )
+{
+  Scheduler_Schedule(IssueTask, -1.0f);
+}
+
+// registers all of the command handlers with x-plane again, does nothing if they are registered
+static void RegisterHandlers
+  (
+  void
+  )
+{
+  if (HandlersRegistered) return;
+
+  for (int h = 0; h < NumHandlers; h++)
+  {
+    XPLMRegisterCommandHandler(Handlers[h].Command, Handlers[h].Handler, Handlers[h].Before, Handlers[h].Refcon);
+  }
+  HandlersRegistered = TRUE;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int Commands_Init
+  (
+  void
+  )
+{
+  for (int s = 0; s < COMMANDS_MAX_ACTIVE; s++) Slots[s].Command = NULL;
+  NumHandlers = 0;
+  HandlersRegistered = TRUE;
+
+  // only scheduled when there is something to issue
+  IssueTask = Scheduler_AddTask(IssueCommands, PROFILE_COMMANDS, 0);
+
+  return IssueTask >= 0;
+}
+
+// holds a command down until it is released, from the next frame
+// does nothing if it is already held
+void Commands_Hold
+  (
+  XPLMCommandRef Command
+  )
+{
+  if (Command == NULL) return;
+
+  command_slot_t *Slot = GetSlot(Command);
+  if (Slot == NULL) return;
+
+  Slot->Wanted = TRUE;
+  Slot->ReleaseTime = 0;
+  ScheduleIssue();
+}
+
+// holds a command down for a time, then releases it
+void Commands_HoldFor
+  (
+  XPLMCommandRef Command,
+  float Seconds
+  )
+{
+  if (Command == NULL) return;
+
+  command_slot_t *Slot = GetSlot(Command);
+  if (Slot == NULL) return;
+
+  Slot->Wanted = TRUE;
+  Slot->ReleaseTime = Clock_Get(CLOCK_WALL) + Seconds;
+  ScheduleIssue();
+}
+
+// releases a held command on the next frame, does nothing if it isn't held
+void Commands_Release
+  (
+  XPLMCommandRef Command
+  )
+{
+  if (Command == NULL) return;
+
+  command_slot_t *Slot = FindSlot(Command);
+  if ((Slot == NULL) || (Slot->Wanted == FALSE)) return;
+
+  Slot->Wanted = FALSE;
+  Slot->ReleaseTime = 0;
+  ScheduleIssue();
+}
+
+// presses and releases a command once on the next frame
+// several pulses of the same command in one frame are only sent once
+void Commands_Pulse
+  (
+  XPLMCommandRef Command
+  )
+{
+  if (Command == NULL) return;
+
+  command_slot_t *Slot = GetSlot(Command);
+  if (Slot == NULL) return;
+
+  Slot->Pulse = TRUE;
+  ScheduleIssue();
+}
+
+// returns TRUE if a command is held or will be held on the next frame
+bool Commands_IsHeld
+  (
+  XPLMCommandRef Command
+  )
+{
+  command_slot_t *Slot = FindSlot(Command);
+  return (Command != NULL) && (Slot != NULL) && Slot->Wanted;
+}
+
+// releases every held command now, used when the plugin is disabled or stopped
+void Commands_ReleaseAll
+  (
+  void
+  )
+{
+  for (int s = 0; s < COMMANDS_MAX_ACTIVE; s++)
+  {
+    command_slot_t *Slot = &Slots[s];
+    if (Slot->Command == NULL) continue;
+
+    if (Slot->Held)
+    {
+#if DIAGNOSTIC == 1
+      Diagnostic_printf("Releasing a command that was still held\n");
+#endif // DIAGNOSTIC
+      XPLMCommandEnd(Slot->Command);
+    }
+    Slot->Command = NULL;
+  }
+
+  Scheduler_Schedule(IssueTask, 0);
+}
+
+// registers a handler for one of our commands, it is unregistered while the plugin is disabled
+// returns TRUE for success, FALSE if there is no more space
+int Commands_RegisterHandler
+  (
+  XPLMCommandRef Command,
+  XPLMCommandCallback_f Handler,
+  int Before,                     // 1 to receive the command before x-plane
+  void *Refcon                    // passed to the handler
+  )
+{
+  if ((Command == NULL) || (NumHandlers == COMMANDS_MAX_HANDLERS))
+  {
+#if DIAGNOSTIC == 1
+    Diagnostic_printf("Unable to register a command handler\n");
+#endif // DIAGNOSTIC
+    return FALSE;
+  }
+
+  command_handler_t *Entry = &Handlers[NumHandlers++];
+  Entry->Command = Command;
+  Entry->Handler = Handler;
+  Entry->Before = Before;
+  Entry->Refcon = Refcon;
+
+  if (HandlersRegistered) XPLMRegisterCommandHandler(Command, Handler, Before, Refcon);
+
+  return TRUE;
+}
+
+// unregisters all of the command handlers, called when the plugin is stopped
+void Commands_UnregisterHandlers
+  (
+  void
+  )
+{
+  if (HandlersRegistered == FALSE) return;
+
+  for (int h = 0; h < NumHandlers; h++)
+  {
+    XPLMUnregisterCommandHandler(Handlers[h].Command, Handlers[h].Handler, Handlers[h].Before, Handlers[h].Refcon);
+  }
+  HandlersRegistered = FALSE;
+}
+
+// called when an event is published, see Events.cpp
+void Commands_HandleEvent
+  (
+  const event_t *Event
+  )
+{
+  // nothing the modules were doing in the last flight should carry on, and
+  // nothing is left held down while we aren't running
+  if ((Event->Type == EVENT_SESSION_RESET) || (Event->Type == EVENT_PLUGIN_DISABLED))
+  {
+    Commands_ReleaseAll();
+  }
+
+  // the user's commands do nothing while we aren't running
+  if (Event->Type == EVENT_PLUGIN_DISABLED)
+  {
+    Commands_UnregisterHandlers();
+  }
+  else if (Event->Type == EVENT_PLUGIN_ENABLED)
+  {
+    RegisterHandlers();
+  }
+}
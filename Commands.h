@@ -0,0 +1,80 @@
+#ifndef _COMMANDSH_
+#define _COMMANDSH_
+
+#include "Global.h"
+#include "Events.h"
+
+// most commands that can be held or pulsed at the same time
+#define COMMANDS_MAX_ACTIVE 8
+// most command handlers the modules can register
+#define COMMANDS_MAX_HANDLERS 8
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int Commands_Init
+  (
+  void
+  );
+
+// holds a command down until it is released, from the next frame
+// does nothing if it is already held
+extern void Commands_Hold
+  (
+  XPLMCommandRef Command
+  );
+
+// holds a command down for a time, then releases it
+extern void Commands_HoldFor
+  (
+  XPLMCommandRef Command,
+  float Seconds
+  );
+
+// releases a held command on the next frame, does nothing if it isn't held
+extern void Commands_Release
+  (
+  XPLMCommandRef Command
+  );
+
+// presses and releases a command once on the next frame
+// several pulses of the same command in one frame are only sent once
+extern void Commands_Pulse
+  (
+  XPLMCommandRef Command
+  );
+
+// returns TRUE if a command is held or will be held on the next frame
+extern bool Commands_IsHeld
+  (
+  XPLMCommandRef Command
+  );
+
+// releases every held command now, used when the plugin is disabled or stopped
+extern void Commands_ReleaseAll
+  (
+  void
+  );
+
+// registers a handler for one of our commands, it is unregistered while the plugin is disabled
+// returns TRUE for success, FALSE if there is no more space
+extern int Commands_RegisterHandler
+  (
+  XPLMCommandRef Command,
+  XPLMCommandCallback_f Handler,
+  int Before,                     // 1 to receive the command before x-plane
+  void *Refcon                    // passed to the handler
+  );
+
+// unregisters all of the command handlers, called when the plugin is stopped
+extern void Commands_UnregisterHandlers
+  (
+  void
+  );
+
+// called when an event is published, see Events.cpp
+extern void Commands_HandleEvent
+  (
+  const event_t *Event
+  );
+
+#endif // _COMMANDSH_
@@ -0,0 +1,431 @@
+// CONFIG
+
+// Reads the tunable values of the modules from a text file in the x-plane
+// preferences folder, so they can be changed without rebuilding the plugin
+// The file is watched by a background thread. When it changes, the thread
+// reads it into a new snapshot and swaps the published pointer, so the sim
+// thread never waits for the disk or the parsing and always sees a complete
+// set of values
+// The file has one "name = value" per line, lines starting with # are
+// comments. If it doesn't exist it is created with the default values
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <stddef.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#if IBM
+#include <windows.h>
+#elif LIN
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+#include "Config.h"
+#include "Diagnostic.h"
+#include "Scheduler.h"
+
+// time in milliseconds the watcher waits for a change before checking again
+#define WATCH_TIMEOUT_MS 1000
+// time between checks on the sim thread for a new snapshot, in seconds
+#define REPORT_INTERVAL 1.0f
+// longest line in the file
+#define MAX_LINE_LENGTH 256
+
+// a snapshot and the one it replaced, old snapshots are kept until the
+// plugin stops so a pointer held by the sim thread is always valid
+typedef struct _snapshot_t
+{
+  config_t Config;
+  struct _snapshot_t *Previous;
+  int BadLines;           // lines in the file that could not be used
+  unsigned int Rejected;  // bit for each item whose value was out of range, the default is used
+} snapshot_t;
+
+// describes a value in the file
+typedef struct _config_item_t
+{
+  const char *Name;
+  size_t Offset;
+  float Min;
+  float Max;
+} config_item_t;
+
+// values used when there is no file or the file doesn't set them
+static const config_t Defaults =
+{
+  160.0f,   // MaxAirspeed
+  18.0f,    // MinFlapAngle
+  152.4f,   // MaxAltitude
+  60.0f,    // MinSpeedReverseThrust
+  1.0f,     // ReverseThrustRatio
+  0.25f,    // ThrottleManagerInterval
+  10.0f,    // IdleThrottleTimeout
+
+  0.7f,     // ShakeSinkRate
+  0.08f,    // ShakeAmplitude
+  0.250f,   // HeadMotionInterval
+  0.005f,   // HeadMotionFastInterval
+  1.0f,     // HeadMoveTimeout
+
+  1.7f,     // AutobrakeLow
+  3.0f,     // AutobrakeMedium
+  4.5f,     // AutobrakeHigh
+  8.0f,     // RolloutEndSpeed
+
+  1.0f,     // BrakeRampTime
+  0.5f      // BrakePulseHoldTime
+};
+
+// all of the values in the file and the range that can be used
+// the intervals are returned to the scheduler, where 0 would stop a state machine
+// for good and a negative value would run it every frame
+static const config_item_t Items[] =
+{
+  {"max_airspeed",              offsetof(config_t, MaxAirspeed),              0.0f,   500.0f},
+  {"min_flap_angle",            offsetof(config_t, MinFlapAngle),             0.0f,   90.0f},
+  {"max_altitude",              offsetof(config_t, MaxAltitude),              0.0f,   3000.0f},
+  {"min_speed_reverse_thrust",  offsetof(config_t, MinSpeedReverseThrust),    0.0f,   200.0f},
+  {"reverse_thrust_ratio",      offsetof(config_t, ReverseThrustRatio),       0.0f,   1.0f},
+  {"throttle_manager_interval", offsetof(config_t, ThrottleManagerInterval),  0.01f,  5.0f},
+  {"idle_throttle_timeout",     offsetof(config_t, IdleThrottleTimeout),      0.0f,   120.0f},
+  {"shake_sink_rate",           offsetof(config_t, ShakeSinkRate),            0.0f,   10.0f},
+  {"shake_amplitude",           offsetof(config_t, ShakeAmplitude),           0.0f,   0.3f},
+  {"head_motion_interval",      offsetof(config_t, HeadMotionInterval),       0.001f, 5.0f},
+  {"head_motion_fast_interval", offsetof(config_t, HeadMotionFastInterval),   0.001f, 1.0f},
+  {"head_move_timeout",         offsetof(config_t, HeadMoveTimeout),          0.1f,   10.0f},
+  {"autobrake_low",             offsetof(config_t, AutobrakeLow),             0.1f,   15.0f},
+  {"autobrake_medium",          offsetof(config_t, AutobrakeMedium),          0.1f,   15.0f},
+  {"autobrake_high",            offsetof(config_t, AutobrakeHigh),            0.1f,   15.0f},
+  {"rollout_end_speed",         offsetof(config_t, RolloutEndSpeed),          0.0f,   50.0f},
+  {"brake_ramp_time",           offsetof(config_t, BrakeRampTime),            0.0f,   10.0f},
+  {"brake_pulse_hold_time",     offsetof(config_t, BrakePulseHoldTime),       0.0f,   10.0f},
+};
+
+#define NUM_ITEMS (int)(sizeof(Items) / sizeof(config_item_t))
+
+// x-plane's paths are up to 512 characters, the file path also has a separator and the file name
+#define MAX_FOLDER_LENGTH 512
+#define MAX_FILE_PATH_LENGTH (MAX_FOLDER_LENGTH + 8 + sizeof(CONFIG_FILE_NAME))
+
+static char FolderPath[MAX_FOLDER_LENGTH];
+static char FilePath[MAX_FILE_PATH_LENGTH];
+
+// the published snapshot
+static std::atomic<snapshot_t *> Current(NULL);
+// the last snapshot reported to Log.txt, only used on the sim thread
+static snapshot_t *Reported = NULL;
+
+static std::thread Watcher;
+static std::atomic<bool> StopWatcher(false);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// removes spaces from the start and end of a string
+// returns the start of the string
+static char *Trim
+  (
+  char *Text
+  )
+{
+  while ((*Text == ' ') || (*Text == '\t')) Text++;
+
+  char *End = Text + strlen(Text);
+  while ((End > Text) && ((End[-1] == ' ') || (End[-1] == '\t') || (End[-1] == '\r') || (End[-1] == '\n'))) End--;
+  *End = '\0';
+
+  return Text;
+}
+
+// reads the file into a new snapshot
+// returns the snapshot, or NULL if the file can't be opened
+static snapshot_t *LoadFile
+  (
+  void
+  )
+{
+  FILE *File;
+  if (fopen_s(&File, FilePath, "r") != 0) return NULL;
+
+  snapshot_t *Snapshot = new snapshot_t;
+  Snapshot->Config = Defaults;
+  Snapshot->Previous = NULL;
+  Snapshot->BadLines = 0;
+  Snapshot->Rejected = 0;
+
+  char Line[MAX_LINE_LENGTH];
+  while (fgets(Line, MAX_LINE_LENGTH, File) != NULL)
+  {
+    char *Name = Trim(Line);
+    if ((Name[0] == '\0') || (Name[0] == '#')) continue;
+
+    char *Equals = strchr(Name, '=');
+    if (Equals == NULL)
+    {
+      Snapshot->BadLines++;
+      continue;
+    }
+    *Equals = '\0';
+    Name = Trim(Name);
+    char *ValueText = Trim(Equals + 1);
+
+    char *End;
+    float Value = strtof(ValueText, &End);
+    bool Found = FALSE;
+    if ((End != ValueText) && (*End == '\0'))
+    {
+      for (int i = 0; i < NUM_ITEMS; i++)
+      {
+        if (strcmp(Name, Items[i].Name) == 0)
+        {
+          // out of range values keep the default, they are reported on the sim thread
+          if ((Value >= Items[i].Min) && (Value <= Items[i].Max))
+          {
+            *(float *)((char *)&Snapshot->Config + Items[i].Offset) = Value;
+          }
+          else
+          {
+            Snapshot->Rejected |= 1u << i;
+          }
+          Found = TRUE;
+          break;
+        }
+      }
+    }
+    if (Found == FALSE) Snapshot->BadLines++;
+  }
+
+  fclose(File);
+  return Snapshot;
+}
+
+// writes a file with the default values, so the user can see what can be changed
+static void WriteDefaults
+  (
+  void
+  )
+{
+  FILE *File;
+  if (fopen_s(&File, FilePath, "w") != 0) return;
+
+  fprintf(File, "# %s configuration, changes are used straight away\n", PLUGIN_NAME);
+  for (int i = 0; i < NUM_ITEMS; i++)
+  {
+    fprintf(File, "%s = %g\n", Items[i].Name, *(const float *)((const char *)&Defaults + Items[i].Offset));
+  }
+
+  fclose(File);
+}
+
+#if DIAGNOSTIC == 1
+// writes the values that were out of range to Log.txt, only used on the sim thread
+static void ReportRejected
+  (
+  const snapshot_t *Snapshot
+  )
+{
+  for (int i = 0; i < NUM_ITEMS; i++)
+  {
+    if ((Snapshot->Rejected & (1u << i)) == 0) continue;
+
+    Diagnostic_printf("Configuration %s must be from %g to %g, using %g\n", Items[i].Name, Items[i].Min, Items[i].Max,
+      *(const float *)((const char *)&Defaults + Items[i].Offset));
+  }
+}
+#endif // DIAGNOSTIC
+
+// makes a snapshot the current configuration
+static void Publish
+  (
+  snapshot_t *Snapshot
+  )
+{
+  Snapshot->Previous = Current.load();
+  Current.store(Snapshot);
+}
+
+// gets the modification time and size of the file
+// returns FALSE if the file doesn't exist
+static bool GetFileStamp
+  (
+  time_t *ModifiedTime,
+  long long *Size
+  )
+{
+  struct stat Info;
+  if (stat(FilePath, &Info) != 0) return FALSE;
+
+  *ModifiedTime = Info.st_mtime;
+  *Size = Info.st_size;
+  return TRUE;
+}
+
+// watches the file and publishes a new snapshot when it changes, runs on its own thread
+// the x-plane SDK must not be used here
+static void WatchFile
+  (
+  void
+  )
+{
+  time_t LastModified = 0;
+  long long LastSize = -1;
+  GetFileStamp(&LastModified, &LastSize);
+
+#if IBM
+  HANDLE Change = FindFirstChangeNotificationA(FolderPath, FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+#elif LIN
+  int Notify = inotify_init1(IN_NONBLOCK);
+  if (Notify >= 0) inotify_add_watch(Notify, FolderPath, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+#endif
+
+  while (StopWatcher.load() == false)
+  {
+    // wait for something in the folder to change, or check again after a while
+#if IBM
+    if (Change != INVALID_HANDLE_VALUE)
+    {
+      if (WaitForSingleObject(Change, WATCH_TIMEOUT_MS) == WAIT_OBJECT_0) FindNextChangeNotification(Change);
+    }
+    else
+    {
+      Sleep(WATCH_TIMEOUT_MS);
+    }
+#elif LIN
+    if (Notify >= 0)
+    {
+      struct pollfd Poll = { Notify, POLLIN, 0 };
+      if (poll(&Poll, 1, WATCH_TIMEOUT_MS) > 0)
+      {
+        char Events[4096];
+        while (read(Notify, Events, sizeof(Events)) > 0);
+      }
+    }
+    else
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_TIMEOUT_MS));
+    }
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_TIMEOUT_MS));
+#endif
+
+    // the folder holds other files too, only read ours if it has changed
+    time_t Modified;
+    long long Size;
+    if (GetFileStamp(&Modified, &Size) == FALSE) continue;
+    if ((Modified == LastModified) && (Size == LastSize)) continue;
+    LastModified = Modified;
+    LastSize = Size;
+
+    snapshot_t *Snapshot = LoadFile();
+    if (Snapshot != NULL) Publish(Snapshot);
+  }
+
+#if IBM
+  if (Change != INVALID_HANDLE_VALUE) FindCloseChangeNotification(Change);
+#elif LIN
+  if (Notify >= 0) close(Notify);
+#endif
+}
+
+// reports a new configuration to Log.txt, called periodically by x-plane
+// returns the number of seconds to the next execution
+static float ReportChanges
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  snapshot_t *Snapshot = Current.load();
+  if (Snapshot != Reported)
+  {
+    Reported = Snapshot;
+#if DIAGNOSTIC == 1
+    Diagnostic_printf("Configuration loaded from %s, %d lines not used\n", FilePath, Snapshot->BadLines);
+    ReportRejected(Snapshot);
+#endif // DIAGNOSTIC
+  }
+
+  return REPORT_INTERVAL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module, loads the configuration file and starts watching it
+// returns TRUE for success, FALSE for error
+int Config_Init
+  (
+  void
+  )
+{
+  // the preferences path is the path of a file in the preferences folder
+  char PrefsPath[MAX_FOLDER_LENGTH];
+  XPLMGetPrefsPath(PrefsPath);
+  XPLMExtractFileAndPath(PrefsPath);
+  strcpy_s(FolderPath, MAX_FOLDER_LENGTH, PrefsPath);
+  sprintf_s(FilePath, MAX_FILE_PATH_LENGTH, "%s%s%s", FolderPath, XPLMGetDirectorySeparator(), CONFIG_FILE_NAME);
+
+  // the first read is done here so the modules start with the right values
+  snapshot_t *Snapshot = LoadFile();
+  if (Snapshot == NULL)
+  {
+    WriteDefaults();
+    Snapshot = new snapshot_t;
+    Snapshot->Config = Defaults;
+    Snapshot->BadLines = 0;
+    Snapshot->Rejected = 0;
+  }
+  Snapshot->Previous = NULL;
+  Current.store(Snapshot);
+  Reported = Snapshot;
+
+#if DIAGNOSTIC == 1
+  Diagnostic_printf("Configuration from %s, %d lines not used\n", FilePath, Snapshot->BadLines);
+  ReportRejected(Snapshot);
+#endif // DIAGNOSTIC
+
+  StopWatcher.store(false);
+  Watcher = std::thread(WatchFile);
+
+  Scheduler_AddTask(ReportChanges, SCHEDULER_NOT_PROFILED, REPORT_INTERVAL);
+
+  return TRUE;
+}
+
+// stops watching the configuration file, called when the plugin is stopped
+void Config_Stop
+  (
+  void
+  )
+{
+  StopWatcher.store(true);
+  if (Watcher.joinable()) Watcher.join();
+
+  // nothing can be using the snapshots now
+  snapshot_t *Snapshot = Current.exchange(NULL);
+  while (Snapshot != NULL)
+  {
+    snapshot_t *Previous = Snapshot->Previous;
+    delete Snapshot;
+    Snapshot = Previous;
+  }
+  Reported = NULL;
+}
+
+// gets the current configuration
+// the snapshot can be used until the end of the current callback, get it again
+// in the next callback to pick up changes to the file
+const config_t *Config_Get
+  (
+  void
+  )
+{
+  snapshot_t *Snapshot = Current.load(std::memory_order_acquire);
+  if (Snapshot == NULL) return &Defaults;
+  return &Snapshot->Config;
+}
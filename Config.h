@@ -0,0 +1,60 @@
+#ifndef _CONFIGH_
+#define _CONFIGH_
+
+#include "Global.h"
+
+// name of the configuration file, in the x-plane preferences folder
+#define CONFIG_FILE_NAME "XVRTools.cfg"
+
+// the tunable values, a snapshot is never changed once it has been published
+typedef struct _config_t
+{
+  // landing throttle manager
+  float MaxAirspeed;               // knots
+  float MinFlapAngle;              // degrees
+  float MaxAltitude;               // meters above ground
+  float MinSpeedReverseThrust;     // knots
+  float ReverseThrustRatio;        // 0 = idle reverse to 1 = maximum reverse
+  float ThrottleManagerInterval;   // seconds between state machine executions
+  float IdleThrottleTimeout;       // seconds to wait for the throttles to reach idle
+
+  // touch down head motion
+  float ShakeSinkRate;             // sink rate in m/s that gives the shake amplitude
+  float ShakeAmplitude;            // head movement in m at the shake sink rate
+  float HeadMotionInterval;        // seconds between state machine executions
+  float HeadMotionFastInterval;    // seconds between executions while moving the head
+  float HeadMoveTimeout;           // longest time in seconds to move the head up or down
+
+  // autobrake
+  float AutobrakeLow;              // target decelerations in m/s^2
+  float AutobrakeMedium;
+  float AutobrakeHigh;
+  float RolloutEndSpeed;           // ground speed in m/s at which the rollout is complete
+
+  // parking brake
+  float BrakeRampTime;             // seconds to move the brake fully on or off
+  float BrakePulseHoldTime;        // seconds the brake is held on during a pulse
+} config_t;
+
+// initalizes the module, loads the configuration file and starts watching it
+// returns TRUE for success, FALSE for error
+extern int Config_Init
+  (
+  void
+  );
+
+// stops watching the configuration file, called when the plugin is stopped
+extern void Config_Stop
+  (
+  void
+  );
+
+// gets the current configuration
+// the snapshot can be used until the end of the current callback, get it again
+// in the next callback to pick up changes to the file
+extern const config_t *Config_Get
+  (
+  void
+  );
+
+#endif // _CONFIGH_
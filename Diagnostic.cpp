@@ -1,4 +1,6 @@
 #include "Diagnostic.h"
+#include "Profile.h"
+#include "Timing.h"
 
 // prints a diagnostic line to Log.txt
 // accepts the same arguments as printf
@@ -8,6 +10,7 @@ void Diagnostic_printf
   ...
   )
 {
+  double StartTime = Timing_GetTime();
   va_list lst;
   char line[256];
 
@@ -17,4 +20,6 @@ void Diagnostic_printf
   XPLMDebugString(": ");
   XPLMDebugString(line);
   va_end(lst);
+
+  Profile_Record(PROFILE_DIAGNOSTIC, 0, Timing_GetTime() - StartTime);
 }
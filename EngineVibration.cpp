@@ -0,0 +1,341 @@
+// ENGINE VIBRATION
+
+// Shakes the pilots head with the vibration of the running engines
+// Each engine contributes a shaft tone and a propeller blade pass tone whose
+// amplitudes follow the engine power. The tones are generated from phase
+// accumulators and a sine lookup table so the phase is continuous from frame
+// to frame and no trigonometry is done while running.
+// The real frequencies are far above what can be shown at VR frame rates, so
+// each tone is lowered by octaves into the range that can be felt, which keeps
+// the beating between unsynchronized engines
+
+#include <math.h>
+#include <stdint.h>
+#include "EngineVibration.h"
+#include "HeadCompositor.h"
+#include "Diagnostic.h"
+#include "Settings.h"
+#include "Profile.h"
+#include "Scheduler.h"
+#include "Clock.h"
+
+#define MODULE_NAME "Engine Vibration"
+
+// time between executions of the state machine, in seconds
+// when no engine is running
+#define STATE_MACHINE_EXECUTION_INTERVAL 0.25f
+// when an engine is running the state machine runs every frame
+#define STATE_MACHINE_EXECUTION_EVERY_FRAME -1.0f
+
+// maximum number of engines supported by x-plane
+#define MAX_ENGINES 8
+
+// configuration section
+// maximum head movement at full power of all engines, in m
+#define MAX_AMPLITUDE 0.0015f
+// share of the amplitude when the engines are idling
+#define IDLE_AMPLITUDE_RATIO 0.3f
+// highest tone frequency that is shown, in Hz
+#define MAX_TONE_FREQUENCY 12.0f
+// engines below this speed in RPM are not running
+#define MIN_RUNNING_RPM 100.0f
+// smallest power in W used to normalize the power of an engine
+#define MIN_REFERENCE_POWER 50000.0f
+// longest frame time used to advance the tones, in seconds
+#define MAX_FRAME_TIME 0.1f
+
+// size of the sine lookup table, must be a power of two
+#define SINE_TABLE_BITS 10
+#define SINE_TABLE_SIZE (1 << SINE_TABLE_BITS)
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// menu item IDs
+#define MENU_ITEM_ID_ENABLE 1
+
+// commands and data references that we need
+static XPLMDataRef NumEnginesRef    = NULL;
+static XPLMDataRef NumBladesRef     = NULL;
+static XPLMDataRef EngineSpeedRef   = NULL;
+static XPLMDataRef PropSpeedRef     = NULL;
+static XPLMDataRef EnginePowerRef   = NULL;
+
+// prototype for the function that handles menu choices
+static void	MenuHandlerCallback(void *inMenuRef, void *inItemRef);
+
+static float SineTable[SINE_TABLE_SIZE];
+
+// per-engine state
+static int      NumEngines;
+static float    NumBlades[MAX_ENGINES];
+static float    ReferencePower[MAX_ENGINES];
+static uint32_t ShaftPhase[MAX_ENGINES];
+static uint32_t BladePhase[MAX_ENGINES];
+
+// our slot in the head compositor
+static int HeadSourceId;
+static bool Enabled;
+static XPLMMenuID myMenu;
+static int MenuItem_Enable;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// sets the offsets of the pilots head
+static void ApplyOffset
+  (
+  float OffsetX,  // new lateral offset in m
+  float OffsetY   // new vertical offset in m
+  )
+{
+  float *Offsets = HeadCompositor_GetOffsets(HeadSourceId);
+  Offsets[HEAD_X] = OffsetX;
+  Offsets[HEAD_Y] = OffsetY;
+}
+
+// lowers a frequency by octaves until it can be shown
+// returns the phase increment for the phase accumulator, where one turn is 2^32
+static uint32_t PhaseIncrement
+  (
+  float Frequency,  // in Hz
+  float FrameTime   // time since the last frame in seconds
+  )
+{
+  // an infinite frequency can't be lowered and nothing compares with NaN,
+  // so a bad value from the sim or an add-on gives no tone
+  if (!isfinite(Frequency) || (Frequency <= 0)) return 0;
+
+  while (Frequency > MAX_TONE_FREQUENCY) Frequency *= 0.5f;
+
+  // whole turns make no difference to the phase, in double so what is left
+  // is always less than a turn and fits the accumulator
+  double Turns = (double)Frequency * (double)FrameTime;
+  Turns -= floor(Turns);
+
+  return (uint32_t)((uint64_t)ldexp(Turns, 32) & 0xFFFFFFFFu);
+}
+
+// looks up the sine of a phase
+static float Sine
+  (
+  uint32_t Phase
+  )
+{
+  return SineTable[Phase >> (32 - SINE_TABLE_BITS)];
+}
+
+// reads the aircraft configuration for the current aircraft
+static void ReadAircraft
+  (
+  void
+  )
+{
+  NumEngines = XPLMGetDatai(NumEnginesRef);
+  if (NumEngines < 0) NumEngines = 0;
+  if (NumEngines > MAX_ENGINES) NumEngines = MAX_ENGINES;
+
+  for (int e = 0; e < MAX_ENGINES; e++)
+  {
+    NumBlades[e] = 0;
+    ReferencePower[e] = MIN_REFERENCE_POWER;
+    ShaftPhase[e] = 0;
+    // spread the starting phases so the engines are not in step
+    BladePhase[e] = 0x9E3779B9u * (uint32_t)e;
+  }
+  if (NumEngines > 0)
+  {
+    XPLMGetDatavf(NumBladesRef, NumBlades, 0, NumEngines);
+  }
+}
+
+// execute the state machine, called periodically by x-plane
+// returns the number of seconds to the next execution
+static float StateMachine
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  if ((Enabled == FALSE) || (NumEngines == 0)) return STATE_MACHINE_EXECUTION_INTERVAL;
+
+  float EngineSpeed[MAX_ENGINES];
+  float PropSpeed[MAX_ENGINES];
+  float Power[MAX_ENGINES];
+  XPLMGetDatavf(EngineSpeedRef, EngineSpeed, 0, NumEngines);
+  XPLMGetDatavf(PropSpeedRef, PropSpeed, 0, NumEngines);
+  XPLMGetDatavf(EnginePowerRef, Power, 0, NumEngines);
+
+  // the vibration is felt, so it doesn't speed up with time compression
+  float FrameTime = Clock_GetFrameTime(CLOCK_UNPAUSED);
+  if (FrameTime < 0) FrameTime = 0;
+  if (FrameTime > MAX_FRAME_TIME) FrameTime = MAX_FRAME_TIME;
+
+  float VibrationX = 0;
+  float VibrationY = 0;
+  int NumRunning = 0;
+
+  for (int e = 0; e < NumEngines; e++)
+  {
+    if (EngineSpeed[e] < MIN_RUNNING_RPM) continue;
+    NumRunning++;
+
+    // normalize the power to the most power seen from this engine
+    if (Power[e] > ReferencePower[e]) ReferencePower[e] = Power[e];
+    float PowerRatio = Power[e] > 0 ? Power[e] / ReferencePower[e] : 0;
+    float Amplitude = IDLE_AMPLITUDE_RATIO + (1.0f - IDLE_AMPLITUDE_RATIO) * PowerRatio;
+
+    // advance the tones, wrapping of the accumulators keeps the phase continuous
+    ShaftPhase[e] += PhaseIncrement(EngineSpeed[e] * (1.0f / 60.0f), FrameTime);
+    BladePhase[e] += PhaseIncrement(PropSpeed[e] * NumBlades[e] * (1.0f / 60.0f), FrameTime);
+
+    float Shaft = Sine(ShaftPhase[e]);
+    float Blade = PropSpeed[e] > 0 ? Sine(BladePhase[e]) : 0;
+
+    VibrationY += Amplitude * (0.6f * Shaft + 0.4f * Blade);
+    VibrationX += Amplitude * (0.4f * Shaft - 0.6f * Blade);
+  }
+
+  if (NumRunning == 0)
+  {
+    ApplyOffset(0, 0);
+    return STATE_MACHINE_EXECUTION_INTERVAL;
+  }
+
+  // the total amplitude does not grow with the number of engines
+  float Scale = MAX_AMPLITUDE / (float)NumEngines;
+  ApplyOffset(VibrationX * Scale, VibrationY * Scale);
+
+  return STATE_MACHINE_EXECUTION_EVERY_FRAME;
+}
+
+// called when the user chooses a menu item
+static void MenuHandlerCallback
+(
+  void *inMenuRef,
+  void *inItemRef
+)
+{
+  // user chose to toggle the engine vibration
+  if ((intptr_t)inItemRef == MENU_ITEM_ID_ENABLE)
+  {
+    Enabled = !Enabled;
+    Settings_Get()->EngineVibrationEnabled = Enabled;
+    Settings_Changed();
+    if (Enabled == FALSE) ApplyOffset(0, 0);
+
+    XPLMCheckMenuItem(myMenu, MenuItem_Enable, Enabled ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int EngineVibration_Init
+  (
+  XPLMMenuID ParentMenuId
+  )
+{
+  Enabled = Settings_Get()->EngineVibrationEnabled;
+  NumEngines = 0;
+
+  int mySubMenuItem = XPLMAppendMenuItem(
+    ParentMenuId,
+    MODULE_NAME,
+    0,
+    1);
+
+  myMenu = XPLMCreateMenu(
+    MODULE_NAME,
+    ParentMenuId,
+    mySubMenuItem,
+    MenuHandlerCallback,
+    0
+  );
+
+  // Append menu items to our submenu
+  MenuItem_Enable = XPLMAppendMenuItem(
+    myMenu,
+    "Enable engine vibration",
+    (void *)MENU_ITEM_ID_ENABLE,
+    1);
+
+  if (Enabled == TRUE)
+  {
+    XPLMCheckMenuItem(myMenu, MenuItem_Enable, xplm_Menu_Checked);
+  }
+
+  // get datarefs
+  NumEnginesRef = XPLMFindDataRef("sim/aircraft/engine/acf_num_engines");
+  if (NumEnginesRef == NULL)
+  {
+    return FALSE;
+  }
+  NumBladesRef = XPLMFindDataRef("sim/aircraft/prop/acf_num_blades");
+  if (NumBladesRef == NULL)
+  {
+    return FALSE;
+  }
+  EngineSpeedRef = XPLMFindDataRef("sim/cockpit2/engine/indicators/engine_speed_rpm");
+  if (EngineSpeedRef == NULL)
+  {
+    return FALSE;
+  }
+  PropSpeedRef = XPLMFindDataRef("sim/cockpit2/engine/indicators/prop_speed_rpm");
+  if (PropSpeedRef == NULL)
+  {
+    return FALSE;
+  }
+  EnginePowerRef = XPLMFindDataRef("sim/cockpit2/engine/indicators/power_watts");
+  if (EnginePowerRef == NULL)
+  {
+    return FALSE;
+  }
+
+  // the only time sin() is used
+  for (int i = 0; i < SINE_TABLE_SIZE; i++)
+  {
+    SineTable[i] = (float)sin(2.0 * M_PI * (double)i / (double)SINE_TABLE_SIZE);
+  }
+
+  ReadAircraft();
+
+  HeadSourceId = HeadCompositor_RegisterSource(MODULE_NAME);
+  if (HeadSourceId < 0)
+  {
+    return FALSE;
+  }
+
+  // run the state machine periodically
+  Scheduler_AddTask(StateMachine, PROFILE_ENGINE_VIBRATION, STATE_MACHINE_EXECUTION_INTERVAL);
+
+  return TRUE;
+}
+
+// called when an event is published, see Events.cpp
+void EngineVibration_HandleEvent
+  (
+  const event_t *Event
+  )
+{
+  // start again from still for a new flight
+  if (Event->Type == EVENT_SESSION_RESET)
+  {
+    HeadCompositor_ClearOffsets(HeadSourceId);
+  }
+  // a new aircraft has been loaded
+  else if (Event->Type == EVENT_PLANE_LOADED)
+  {
+    ReadAircraft();
+  }
+  else if (Event->Type == EVENT_PLANE_UNLOADED)
+  {
+    NumEngines = 0;
+  }
+}
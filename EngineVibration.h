@@ -0,0 +1,20 @@
+#ifndef _ENGINEVIBRATIONH_
+#define _ENGINEVIBRATIONH_
+
+#include "Global.h"
+#include "Events.h"
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int EngineVibration_Init
+  (
+  XPLMMenuID ParentMenuId
+  );
+
+// called when an event is published, see Events.cpp
+extern void EngineVibration_HandleEvent
+  (
+  const event_t *Event
+  );
+
+#endif // _ENGINEVIBRATIONH_
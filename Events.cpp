@@ -0,0 +1,216 @@
+// EVENTS
+
+// Sends things that happen, such as a new aircraft, a crash or a touch down,
+// to the modules that need to react to them
+// The modules are listed in a table below so sending an event to them is a
+// direct call each, in the same order every time. Anything that needs events
+// for a while can subscribe, using one of a fixed number of slots. Nothing
+// is allocated while an event is sent, and listeners can publish, subscribe
+// and unsubscribe from inside a listener
+
+#include <stdint.h>
+#include "Events.h"
+#include "Diagnostic.h"
+#include "Speech.h"
+#include "HeadCompositor.h"
+#include "LandingThrottleManager.h"
+#include "ParkingBrake.h"
+#include "RolloutController.h"
+#include "HeadMotion.h"
+#include "GSeat.h"
+#include "EngineVibration.h"
+#include "TextWindow.h"
+#include "Scorecard.h"
+#include "Commands.h"
+#include "Session.h"
+
+// the events that come from x-plane
+#define AIRCRAFT_EVENTS (EVENT_MASK(EVENT_PLANE_LOADED) | EVENT_MASK(EVENT_PLANE_UNLOADED) | EVENT_MASK(EVENT_PLANE_CRASHED))
+#define LOCATION_EVENTS (EVENT_MASK(EVENT_AIRPORT_LOADED) | EVENT_MASK(EVENT_SCENERY_LOADED))
+#define VR_EVENTS       (EVENT_MASK(EVENT_ENTERED_VR) | EVENT_MASK(EVENT_EXITING_VR))
+// the plugin being disabled and enabled
+#define PLUGIN_EVENTS   (EVENT_MASK(EVENT_PLUGIN_DISABLED) | EVENT_MASK(EVENT_PLUGIN_ENABLED))
+// the flight starting again, see Session.cpp
+#define SESSION_EVENTS  EVENT_MASK(EVENT_SESSION_RESET)
+
+// a module that is sent events
+typedef struct _module_listener_t
+{
+  unsigned int TypeMask;
+  void (*HandleEvent)(const event_t *Event);
+} module_listener_t;
+
+// a subscription
+typedef struct _subscriber_t
+{
+  unsigned int TypeMask;
+  event_listener_f Listener;     // NULL when the slot is free
+  void *Refcon;
+  unsigned int SubscribedDuring; // the event being sent when it subscribed
+} subscriber_t;
+
+// the modules, in the order they are sent events
+// the session is first so the reset is finished before the modules set up a new aircraft,
+// then speech so a new aircraft can't hear phrases about the last one
+static const module_listener_t Modules[] =
+{
+  {AIRCRAFT_EVENTS | LOCATION_EVENTS,                 Session_HandleEvent},
+  {SESSION_EVENTS | PLUGIN_EVENTS,                    Speech_HandleEvent},
+  {SESSION_EVENTS | PLUGIN_EVENTS,                    HeadCompositor_HandleEvent},
+  {AIRCRAFT_EVENTS | SESSION_EVENTS | PLUGIN_EVENTS,  LandingThrottleManager_HandleEvent},
+  {SESSION_EVENTS | PLUGIN_EVENTS,                    ParkingBrake_HandleEvent},
+  {SESSION_EVENTS | PLUGIN_EVENTS,                    RolloutController_HandleEvent},
+  {SESSION_EVENTS | PLUGIN_EVENTS,                    HeadMotion_HandleEvent},
+  {SESSION_EVENTS,                                    GSeat_HandleEvent},
+  {AIRCRAFT_EVENTS | SESSION_EVENTS,                  EngineVibration_HandleEvent},
+  {SESSION_EVENTS | PLUGIN_EVENTS,                    Commands_HandleEvent},
+  {VR_EVENTS | PLUGIN_EVENTS,                         TextWindow_HandleEvent},
+  {AIRCRAFT_EVENTS | SESSION_EVENTS | PLUGIN_EVENTS | EVENT_MASK(EVENT_TOUCHDOWN) | EVENT_MASK(EVENT_ROLLOUT_COMPLETE), Scorecard_HandleEvent},
+};
+
+#define NUM_MODULES (int)(sizeof(Modules) / sizeof(module_listener_t))
+
+static subscriber_t Subscribers[EVENTS_MAX_SUBSCRIBERS];
+// counts the events sent, so a subscriber added during an event can be skipped
+static unsigned int EventNumber;
+// the event being sent, 0 if none
+static unsigned int CurrentEvent;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int Events_Init
+  (
+  void
+  )
+{
+  for (int s = 0; s < EVENTS_MAX_SUBSCRIBERS; s++) Subscribers[s].Listener = NULL;
+  EventNumber = 0;
+  CurrentEvent = 0;
+
+  return TRUE;
+}
+
+// sends an event to the modules and then to the subscribers
+// can be used from inside a listener
+void Events_Publish
+  (
+  const event_t *Event
+  )
+{
+  unsigned int Mask = EVENT_MASK(Event->Type);
+
+  // an event sent from inside a listener is finished before the outer one carries on
+  unsigned int OuterEvent = CurrentEvent;
+  if (++EventNumber == 0) EventNumber = 1;
+  CurrentEvent = EventNumber;
+
+  for (int m = 0; m < NUM_MODULES; m++)
+  {
+    if (Modules[m].TypeMask & Mask) Modules[m].HandleEvent(Event);
+  }
+
+  // slots are checked each time as a listener may have unsubscribed itself or another
+  for (int s = 0; s < EVENTS_MAX_SUBSCRIBERS; s++)
+  {
+    subscriber_t *Subscriber = &Subscribers[s];
+    if ((Subscriber->Listener == NULL) || ((Subscriber->TypeMask & Mask) == 0)) continue;
+    if (Subscriber->SubscribedDuring == CurrentEvent) continue;
+
+    Subscriber->Listener(Event, Subscriber->Refcon);
+  }
+
+  CurrentEvent = OuterEvent;
+}
+
+// publishes an event that has no details
+void Events_PublishType
+  (
+  event_type_t Type
+  )
+{
+  event_t Event;
+  Event.Type = Type;
+  Events_Publish(&Event);
+}
+
+// adds a listener for some events
+// returns the ID of the subscription, or -1 if there is no room
+// a listener added while an event is being sent doesn't receive that event
+int Events_Subscribe
+  (
+  unsigned int TypeMask,     // EVENT_MASK of the events wanted
+  event_listener_f Listener,
+  void *Refcon               // passed to the listener
+  )
+{
+  for (int s = 0; s < EVENTS_MAX_SUBSCRIBERS; s++)
+  {
+    if (Subscribers[s].Listener == NULL)
+    {
+      Subscribers[s].TypeMask = TypeMask;
+      Subscribers[s].Refcon = Refcon;
+      Subscribers[s].SubscribedDuring = CurrentEvent;
+      Subscribers[s].Listener = Listener;
+      return s;
+    }
+  }
+
+#if DIAGNOSTIC == 1
+  Diagnostic_printf("No room for another event subscriber\n");
+#endif // DIAGNOSTIC
+  return -1;
+}
+
+// removes a listener, can be used from inside a listener
+void Events_Unsubscribe
+  (
+  int SubscriptionId
+  )
+{
+  if ((SubscriptionId < 0) || (SubscriptionId >= EVENTS_MAX_SUBSCRIBERS)) return;
+  Subscribers[SubscriptionId].Listener = NULL;
+}
+
+// called when a message is received from X-plane, turns it into an event
+void Events_ReceiveMessage
+  (
+  XPLMPluginID inFromWho,
+  int	inMessage,
+  void *inParam
+  )
+{
+  switch (inMessage)
+  {
+    // the parameter is the index of the aircraft, we only fly the user's
+    case XPLM_MSG_PLANE_LOADED:
+      if ((intptr_t)inParam == 0) Events_PublishType(EVENT_PLANE_LOADED);
+      break;
+
+    case XPLM_MSG_PLANE_UNLOADED:
+      if ((intptr_t)inParam == 0) Events_PublishType(EVENT_PLANE_UNLOADED);
+      break;
+
+    case XPLM_MSG_PLANE_CRASHED:
+      Events_PublishType(EVENT_PLANE_CRASHED);
+      break;
+
+    case XPLM_MSG_AIRPORT_LOADED:
+      Events_PublishType(EVENT_AIRPORT_LOADED);
+      break;
+
+    case XPLM_MSG_SCENERY_LOADED:
+      Events_PublishType(EVENT_SCENERY_LOADED);
+      break;
+
+    case XPLM_MSG_ENTERED_VR:
+      Events_PublishType(EVENT_ENTERED_VR);
+      break;
+
+    case XPLM_MSG_EXITING_VR:
+      Events_PublishType(EVENT_EXITING_VR);
+      break;
+  }
+}
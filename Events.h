@@ -0,0 +1,107 @@
+#ifndef _EVENTSH_
+#define _EVENTSH_
+
+#include "Global.h"
+
+// maximum number of listeners that can subscribe while the plugin runs
+#define EVENTS_MAX_SUBSCRIBERS 8
+
+// things that happen that modules may need to react to
+typedef enum _event_type_t
+{
+  EVENT_PLANE_LOADED,       // the user's aircraft has been loaded
+  EVENT_PLANE_UNLOADED,     // the user's aircraft is about to be unloaded
+  EVENT_PLANE_CRASHED,      // the user's aircraft has crashed
+  EVENT_AIRPORT_LOADED,     // the user's aircraft has been placed at an airport
+  EVENT_SCENERY_LOADED,     // new scenery has been loaded
+  EVENT_ENTERED_VR,         // the user has put on the headset
+  EVENT_EXITING_VR,         // the user is about to leave VR
+  EVENT_PLUGIN_DISABLED,    // the plugin is being disabled, stop controlling the aircraft
+  EVENT_PLUGIN_ENABLED,     // the plugin has been enabled again
+  EVENT_SESSION_RESET,      // the flight has started again, forget everything about the last one
+  EVENT_TOUCHDOWN,          // the first wheel touched the ground at the end of a flight
+  EVENT_ROLLOUT_COMPLETE,   // the aircraft has slowed to taxi speed after landing
+  NUM_EVENT_TYPES
+} event_type_t;
+
+// makes the bit for an event type, listeners are given a mask of the events they want
+#define EVENT_MASK(Type) (1u << (Type))
+#define EVENT_MASK_ALL   ((1u << NUM_EVENT_TYPES) - 1)
+
+// an event and its details
+typedef struct _event_t
+{
+  event_type_t Type;
+  union
+  {
+    // EVENT_SESSION_RESET
+    struct
+    {
+      event_type_t Cause;    // the event that caused the reset
+    } Reset;
+    // EVENT_TOUCHDOWN
+    struct
+    {
+      float SinkRateMS;      // vertical speed at touch down in m/s, positive down
+      float GForce;          // downward G at touch down
+    } Touchdown;
+    // EVENT_ROLLOUT_COMPLETE
+    struct
+    {
+      float GroundSpeedMS;   // ground speed when the rollout was complete
+    } Rollout;
+  };
+} event_t;
+
+// function that is called for an event
+typedef void (*event_listener_f)
+  (
+  const event_t *Event,
+  void *Refcon
+  );
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int Events_Init
+  (
+  void
+  );
+
+// sends an event to the modules and then to the subscribers
+// can be used from inside a listener
+extern void Events_Publish
+  (
+  const event_t *Event
+  );
+
+// publishes an event that has no details
+extern void Events_PublishType
+  (
+  event_type_t Type
+  );
+
+// adds a listener for some events
+// returns the ID of the subscription, or -1 if there is no room
+// a listener added while an event is being sent doesn't receive that event
+extern int Events_Subscribe
+  (
+  unsigned int TypeMask,     // EVENT_MASK of the events wanted
+  event_listener_f Listener,
+  void *Refcon               // passed to the listener
+  );
+
+// removes a listener, can be used from inside a listener
+extern void Events_Unsubscribe
+  (
+  int SubscriptionId
+  );
+
+// called when a message is received from X-plane, turns it into an event
+extern void Events_ReceiveMessage
+  (
+  XPLMPluginID inFromWho,
+  int	inMessage,
+  void *inParam
+  );
+
+#endif // _EVENTSH_
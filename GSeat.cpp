@@ -0,0 +1,281 @@
+// G-SEAT
+
+// Moves the pilots head in response to sustained load factors, like a g-seat
+// Uses the classic motion cueing washout filters:
+// - a high pass filter gives the onset cue of a change in load, which then
+//   washes out back to the neutral position
+// - a low pass filter gives the sustained cue, which for the axial and side
+//   loads is shown as a small tilt of the head (tilt coordination)
+// The filters are discretized exactly so they are stable at any frame rate
+
+#include <math.h>
+#include "GSeat.h"
+#include "HeadCompositor.h"
+#include "Diagnostic.h"
+#include "Settings.h"
+#include "Profile.h"
+#include "Scheduler.h"
+#include "Clock.h"
+
+#define MODULE_NAME "G-Seat"
+
+// time between executions of the state machine, in seconds
+// when not active
+#define STATE_MACHINE_EXECUTION_INTERVAL 0.25f
+// when active the state machine runs every frame
+#define STATE_MACHINE_EXECUTION_EVERY_FRAME -1.0f
+
+// configuration section
+// time constants of the washout filters, in seconds
+#define ONSET_TIME_CONSTANT     0.5f
+#define SUSTAINED_TIME_CONSTANT 2.0f
+// head translation in m per g of onset load
+#define ONSET_TRANSLATION_GAIN  0.02f
+// head translation in m per g of sustained normal load
+#define SUSTAINED_TRANSLATION_GAIN 0.01f
+// head tilt in degrees per g of sustained axial or side load
+#define SUSTAINED_ROTATION_GAIN 4.0f
+// limits of the head movement in m and degrees
+#define MAX_TRANSLATION 0.03f
+#define MAX_ROTATION    3.0f
+// offsets smaller than this are considered to be back at the neutral position
+#define NEUTRAL_THRESHOLD 0.0001f
+// longest frame time that will be used for the filters, in seconds
+#define MAX_FRAME_TIME 0.1f
+
+// menu item IDs
+#define MENU_ITEM_ID_ENABLE 1
+
+// commands and data references that we need
+static XPLMDataRef LoadRefs[NUM_LOAD_AXES];
+
+// prototype for the function that handles menu choices
+static void	MenuHandlerCallback(void *inMenuRef, void *inItemRef);
+
+// washout filter state
+static float PreviousLoad[NUM_LOAD_AXES];
+static float OnsetLoad[NUM_LOAD_AXES];
+static float SustainedLoad[NUM_LOAD_AXES];
+static bool HaveFilterState;
+
+// our slot in the head compositor
+static int HeadSourceId;
+
+static bool Enabled;
+static XPLMMenuID myMenu;
+static int MenuItem_Enable;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// limits a value to +/- a maximum
+static float Clamp
+  (
+  float Value,
+  float Limit
+  )
+{
+  if (Value > Limit) return Limit;
+  if (Value < -Limit) return -Limit;
+  return Value;
+}
+
+// clears the filters so the next maneuver starts from neutral
+static void ResetFilters
+  (
+  void
+  )
+{
+  for (int l = 0; l < NUM_LOAD_AXES; l++)
+  {
+    PreviousLoad[l] = 0;
+    OnsetLoad[l] = 0;
+    SustainedLoad[l] = 0;
+  }
+  HaveFilterState = FALSE;
+}
+
+// execute the state machine, called periodically by x-plane
+// returns the number of seconds to the next execution
+static float StateMachine
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  if (Enabled == FALSE) return STATE_MACHINE_EXECUTION_INTERVAL;
+
+  float Load[NUM_LOAD_AXES];
+  Load[LOAD_NORMAL] = XPLMGetDataf(LoadRefs[LOAD_NORMAL]) - 1.0f;
+  Load[LOAD_AXIAL]  = XPLMGetDataf(LoadRefs[LOAD_AXIAL]);
+  Load[LOAD_SIDE]   = XPLMGetDataf(LoadRefs[LOAD_SIDE]);
+
+  // first frame, start the filters at the current load so there is no jump
+  if (HaveFilterState == FALSE)
+  {
+    for (int l = 0; l < NUM_LOAD_AXES; l++)
+    {
+      PreviousLoad[l] = Load[l];
+      SustainedLoad[l] = 0;
+      OnsetLoad[l] = 0;
+    }
+    HaveFilterState = TRUE;
+    return STATE_MACHINE_EXECUTION_EVERY_FRAME;
+  }
+
+  // the seat is felt, so it doesn't speed up with time compression
+  float FrameTime = Clock_GetFrameTime(CLOCK_UNPAUSED);
+  if (FrameTime <= 0) return STATE_MACHINE_EXECUTION_EVERY_FRAME;
+  if (FrameTime > MAX_FRAME_TIME) FrameTime = MAX_FRAME_TIME;
+
+  GSeat_StepFilters(Load, FrameTime);
+
+  float *Offsets = HeadCompositor_GetOffsets(HeadSourceId);
+  // more g pushes the head down into the seat
+  Offsets[HEAD_Y] = Clamp(-(OnsetLoad[LOAD_NORMAL] * ONSET_TRANSLATION_GAIN + SustainedLoad[LOAD_NORMAL] * SUSTAINED_TRANSLATION_GAIN), MAX_TRANSLATION);
+  // acceleration pushes the head back, side load pushes it sideways
+  Offsets[HEAD_Z] = Clamp(OnsetLoad[LOAD_AXIAL] * ONSET_TRANSLATION_GAIN, MAX_TRANSLATION);
+  Offsets[HEAD_X] = Clamp(OnsetLoad[LOAD_SIDE] * ONSET_TRANSLATION_GAIN, MAX_TRANSLATION);
+  // sustained loads tilt the head
+  Offsets[HEAD_PITCH] = Clamp(SustainedLoad[LOAD_AXIAL] * SUSTAINED_ROTATION_GAIN, MAX_ROTATION);
+  Offsets[HEAD_ROLL]  = Clamp(SustainedLoad[LOAD_SIDE] * SUSTAINED_ROTATION_GAIN, MAX_ROTATION);
+
+  // snap back to neutral so the compositor restores the head exactly
+  bool Neutral = TRUE;
+  for (int a = 0; a < NUM_HEAD_AXES; a++)
+  {
+    if (fabsf(Offsets[a]) >= NEUTRAL_THRESHOLD) Neutral = FALSE;
+  }
+  if (Neutral) HeadCompositor_ClearOffsets(HeadSourceId);
+
+  return STATE_MACHINE_EXECUTION_EVERY_FRAME;
+}
+
+// called when the user chooses a menu item
+static void MenuHandlerCallback
+(
+  void *inMenuRef,
+  void *inItemRef
+)
+{
+  // user chose to toggle the g-seat
+  if ((intptr_t)inItemRef == MENU_ITEM_ID_ENABLE)
+  {
+    Enabled = !Enabled;
+    Settings_Get()->GSeatEnabled = Enabled;
+    Settings_Changed();
+    if (Enabled == FALSE)
+    {
+      HeadCompositor_ClearOffsets(HeadSourceId);
+      ResetFilters();
+    }
+
+    XPLMCheckMenuItem(myMenu, MenuItem_Enable, Enabled ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int GSeat_Init
+  (
+  XPLMMenuID ParentMenuId
+  )
+{
+  Enabled = Settings_Get()->GSeatEnabled;
+  ResetFilters();
+
+  int mySubMenuItem = XPLMAppendMenuItem(
+    ParentMenuId,
+    MODULE_NAME,
+    0,
+    1);
+
+  myMenu = XPLMCreateMenu(
+    MODULE_NAME,
+    ParentMenuId,
+    mySubMenuItem,
+    MenuHandlerCallback,
+    0
+  );
+
+  // Append menu items to our submenu
+  MenuItem_Enable = XPLMAppendMenuItem(
+    myMenu,
+    "Enable g-seat motion",
+    (void *)MENU_ITEM_ID_ENABLE,
+    1);
+
+  if (Enabled == TRUE)
+  {
+    XPLMCheckMenuItem(myMenu, MenuItem_Enable, xplm_Menu_Checked);
+  }
+
+  // get datarefs
+  static const char *LoadRefNames[NUM_LOAD_AXES] =
+  {
+    "sim/flightmodel/forces/g_nrml",
+    "sim/flightmodel/forces/g_axil",
+    "sim/flightmodel/forces/g_side"
+  };
+  for (int l = 0; l < NUM_LOAD_AXES; l++)
+  {
+    LoadRefs[l] = XPLMFindDataRef(LoadRefNames[l]);
+    if (LoadRefs[l] == NULL)
+    {
+      return FALSE;
+    }
+  }
+
+  HeadSourceId = HeadCompositor_RegisterSource(MODULE_NAME);
+  if (HeadSourceId < 0)
+  {
+    return FALSE;
+  }
+
+  // run the state machine periodically
+  Scheduler_AddTask(StateMachine, PROFILE_GSEAT, STATE_MACHINE_EXECUTION_INTERVAL);
+
+  return TRUE;
+}
+
+// called when an event is published, see Events.cpp
+void GSeat_HandleEvent
+  (
+  const event_t *Event
+  )
+{
+  // start again from neutral for a new flight, and the loads during a crash
+  // are not something we want to follow
+  if (Event->Type == EVENT_SESSION_RESET)
+  {
+    HeadCompositor_ClearOffsets(HeadSourceId);
+    ResetFilters();
+  }
+}
+
+// advances the washout filters by one frame, it doesn't use the x-plane SDK
+// so it can be measured without the sim
+void GSeat_StepFilters
+  (
+  const float *Load,  // NUM_LOAD_AXES load factors relative to level flight
+  float FrameTime     // time since the last step in seconds
+  )
+{
+  // exact discretization of the first order filters, the coefficients
+  // stay between 0 and 1 for any frame time
+  float OnsetDecay = expf(-FrameTime / ONSET_TIME_CONSTANT);
+  float SustainedGain = 1.0f - expf(-FrameTime / SUSTAINED_TIME_CONSTANT);
+
+  for (int l = 0; l < NUM_LOAD_AXES; l++)
+  {
+    OnsetLoad[l] = OnsetDecay * (OnsetLoad[l] + Load[l] - PreviousLoad[l]);
+    SustainedLoad[l] += SustainedGain * (Load[l] - SustainedLoad[l]);
+    PreviousLoad[l] = Load[l];
+  }
+}
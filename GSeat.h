@@ -0,0 +1,37 @@
+#ifndef _GSEATH_
+#define _GSEATH_
+
+#include "Global.h"
+#include "Events.h"
+
+// load factor inputs
+typedef enum _load_axis_t
+{
+  LOAD_NORMAL,
+  LOAD_AXIAL,
+  LOAD_SIDE,
+  NUM_LOAD_AXES
+} load_axis_t;
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int GSeat_Init
+  (
+  XPLMMenuID ParentMenuId
+  );
+
+// called when an event is published, see Events.cpp
+extern void GSeat_HandleEvent
+  (
+  const event_t *Event
+  );
+
+// advances the washout filters by one frame, it doesn't use the x-plane SDK
+// so it can be measured without the sim
+extern void GSeat_StepFilters
+  (
+  const float *Load,  // NUM_LOAD_AXES load factors relative to level flight
+  float FrameTime     // time since the last step in seconds
+  );
+
+#endif // _GSEATH_
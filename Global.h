@@ -21,4 +21,7 @@
 // set to 1 to enable diagnostic output to Log.txt
 #define DIAGNOSTIC 1
 
+// set to 1 to collect execution time statistics, see Profile.cpp
+#define PROFILE 1
+
 #endif // _GLOBALH_
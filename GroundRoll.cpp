@@ -0,0 +1,251 @@
+// GROUND ROLL
+
+// Shakes the pilots head while the aircraft is rolling on the ground
+// The vibration is synthesized from filtered noise, one noise generator per
+// gear, scaled by the load on each tire and by the ground speed so the rumble
+// builds up as the aircraft speeds up and dies away as it slows down
+
+#include <math.h>
+#include <stdint.h>
+#include "GroundRoll.h"
+#include "HeadCompositor.h"
+#include "Diagnostic.h"
+#include "Settings.h"
+#include "Profile.h"
+#include "Scheduler.h"
+#include "Clock.h"
+
+#define MODULE_NAME "Ground Roll"
+
+// time between executions of the state machine, in seconds
+// when not rolling on the ground
+#define STATE_MACHINE_EXECUTION_INTERVAL 0.25f
+// when rolling the state machine runs every frame
+#define STATE_MACHINE_EXECUTION_EVERY_FRAME -1.0f
+
+// maximum number of gears supported by x-plane
+#define MAX_GEARS 10
+
+// configuration section
+// minimum ground speed in m/s for the rumble to be felt
+#define MIN_GROUND_SPEED 1.0f
+// ground speed in m/s at which the rumble reaches full amplitude
+#define REFERENCE_GROUND_SPEED 40.0f
+// tire load in N at which a gear contributes fully to the rumble
+#define REFERENCE_TIRE_LOAD 50000.0f
+// maximum vertical head movement in m
+#define MAX_AMPLITUDE 0.004f
+// gear contributions are normalized to a typical tricycle gear
+#define GEAR_NORMALIZATION 3.0f
+// rumble frequency in Hz when stationary and increase in Hz per m/s of ground speed
+#define BASE_FREQUENCY 4.0f
+#define FREQUENCY_PER_SPEED 0.25f
+// longest frame time that will be used for the filters, in seconds
+#define MAX_FRAME_TIME 0.1f
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// menu item IDs
+#define MENU_ITEM_ID_ENABLE 1
+
+// commands and data references that we need
+static XPLMDataRef AnyWheelOnGroundRef    = NULL;
+static XPLMDataRef GroundSpeedRef         = NULL;
+static XPLMDataRef GearVerticalForceNmRef = NULL;
+
+// prototype for the function that handles menu choices
+static void	MenuHandlerCallback(void *inMenuRef, void *inItemRef);
+
+// per-gear state, laid out as arrays so all gears are processed together
+static uint32_t NoiseState[MAX_GEARS];
+static float    FilteredNoise[MAX_GEARS];
+static float    GearForces[MAX_GEARS];
+
+// our slot in the head compositor
+static int HeadSourceId;
+static bool Enabled;
+static XPLMMenuID myMenu;
+static int MenuItem_Enable;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// sets the vertical offset of the pilots head
+static void ApplyOffset
+  (
+  float Offset  // new vertical offset in m
+  )
+{
+  HeadCompositor_GetOffsets(HeadSourceId)[HEAD_Y] = Offset;
+}
+
+// advances the noise generators and filters of all gears by one frame
+// returns the combined vertical offset before speed scaling
+static float SynthesizeRumble
+  (
+  float FilterCoefficient,  // one-pole low pass coefficient for this frame
+  float FilterGain          // gain that keeps the filtered noise at unit level
+  )
+{
+  float Sum = 0;
+
+  // no branches so the compiler can process the gears in parallel
+  for (int g = 0; g < MAX_GEARS; g++)
+  {
+    // xorshift noise generator
+    uint32_t s = NoiseState[g];
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    NoiseState[g] = s;
+    float Noise = (float)(int32_t)s * (1.0f / 2147483648.0f);
+
+    FilteredNoise[g] += FilterCoefficient * (Noise - FilteredNoise[g]);
+
+    float Load = GearForces[g] * (1.0f / REFERENCE_TIRE_LOAD);
+    Load = Load < 0.0f ? 0.0f : (Load > 1.0f ? 1.0f : Load);
+
+    Sum += Load * FilteredNoise[g] * FilterGain;
+  }
+
+  return Sum * (1.0f / GEAR_NORMALIZATION);
+}
+
+// execute the state machine, called periodically by x-plane
+// returns the number of seconds to the next execution
+static float StateMachine
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  if (Enabled == FALSE) return STATE_MACHINE_EXECUTION_INTERVAL;
+
+  float GroundSpeed = XPLMGetDataf(GroundSpeedRef);
+  if ((XPLMGetDatai(AnyWheelOnGroundRef) == FALSE) || (GroundSpeed < MIN_GROUND_SPEED))
+  {
+    ApplyOffset(0);
+    return STATE_MACHINE_EXECUTION_INTERVAL;
+  }
+
+  // the rumble is felt, so it doesn't speed up with time compression
+  float FrameTime = Clock_GetFrameTime(CLOCK_UNPAUSED);
+  if (FrameTime <= 0) return STATE_MACHINE_EXECUTION_EVERY_FRAME;
+  if (FrameTime > MAX_FRAME_TIME) FrameTime = MAX_FRAME_TIME;
+
+  // rumble frequency rises with speed
+  float Frequency = BASE_FREQUENCY + GroundSpeed * FREQUENCY_PER_SPEED;
+  float FilterCoefficient = 1.0f - expf(-2.0f * (float)M_PI * Frequency * FrameTime);
+  float FilterGain = sqrtf((2.0f - FilterCoefficient) / FilterCoefficient);
+
+  XPLMGetDatavf(GearVerticalForceNmRef, GearForces, 0, MAX_GEARS);
+
+  float SpeedScale = GroundSpeed / REFERENCE_GROUND_SPEED;
+  if (SpeedScale > 1.0f) SpeedScale = 1.0f;
+
+  float Offset = SynthesizeRumble(FilterCoefficient, FilterGain) * SpeedScale * MAX_AMPLITUDE;
+  if (Offset > MAX_AMPLITUDE) Offset = MAX_AMPLITUDE;
+  if (Offset < -MAX_AMPLITUDE) Offset = -MAX_AMPLITUDE;
+
+  ApplyOffset(Offset);
+
+  return STATE_MACHINE_EXECUTION_EVERY_FRAME;
+}
+
+// called when the user chooses a menu item
+static void MenuHandlerCallback
+(
+  void *inMenuRef,
+  void *inItemRef
+)
+{
+  // user chose to toggle the rumble
+  if ((intptr_t)inItemRef == MENU_ITEM_ID_ENABLE)
+  {
+    Enabled = !Enabled;
+    Settings_Get()->GroundRollEnabled = Enabled;
+    Settings_Changed();
+    if (Enabled == FALSE) ApplyOffset(0);
+
+    XPLMCheckMenuItem(myMenu, MenuItem_Enable, Enabled ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int GroundRoll_Init
+  (
+  XPLMMenuID ParentMenuId
+  )
+{
+  Enabled = Settings_Get()->GroundRollEnabled;
+
+  int mySubMenuItem = XPLMAppendMenuItem(
+    ParentMenuId,
+    MODULE_NAME,
+    0,
+    1);
+
+  myMenu = XPLMCreateMenu(
+    MODULE_NAME,
+    ParentMenuId,
+    mySubMenuItem,
+    MenuHandlerCallback,
+    0
+  );
+
+  // Append menu items to our submenu
+  MenuItem_Enable = XPLMAppendMenuItem(
+    myMenu,
+    "Enable runway rumble",
+    (void *)MENU_ITEM_ID_ENABLE,
+    1);
+
+  if (Enabled == TRUE)
+  {
+    XPLMCheckMenuItem(myMenu, MenuItem_Enable, xplm_Menu_Checked);
+  }
+
+  // get datarefs
+  AnyWheelOnGroundRef = XPLMFindDataRef("sim/flightmodel/failures/onground_any");
+  if (AnyWheelOnGroundRef == NULL)
+  {
+    return FALSE;
+  }
+  GroundSpeedRef = XPLMFindDataRef("sim/flightmodel/position/groundspeed");
+  if (GroundSpeedRef == NULL)
+  {
+    return FALSE;
+  }
+  GearVerticalForceNmRef = XPLMFindDataRef("sim/flightmodel2/gear/tire_vertical_force_n_mtr");
+  if (GearVerticalForceNmRef == NULL)
+  {
+    return FALSE;
+  }
+
+  HeadSourceId = HeadCompositor_RegisterSource(MODULE_NAME);
+  if (HeadSourceId < 0)
+  {
+    return FALSE;
+  }
+
+  // each gear gets its own noise sequence, seeds must be non-zero
+  for (int g = 0; g < MAX_GEARS; g++)
+  {
+    NoiseState[g] = 0x9E3779B9u * (uint32_t)(g + 1);
+    FilteredNoise[g] = 0;
+  }
+
+  // run the state machine periodically
+  Scheduler_AddTask(StateMachine, PROFILE_GROUND_ROLL, STATE_MACHINE_EXECUTION_INTERVAL);
+
+  return TRUE;
+}
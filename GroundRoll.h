@@ -0,0 +1,13 @@
+#ifndef _GROUNDROLLH_
+#define _GROUNDROLLH_
+
+#include "Global.h"
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int GroundRoll_Init
+  (
+  XPLMMenuID ParentMenuId
+  );
+
+#endif // _GROUNDROLLH_
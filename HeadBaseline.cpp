@@ -0,0 +1,100 @@
+// HEAD BASELINE
+
+// Estimates the neutral position of the pilots head
+// The base head position (without the motion source offsets) is followed by
+// a slow exponential filter, so a VR recenter or the user settling into a new
+// seating position is picked up after a few seconds while looking around
+// the cockpit has little effect. Following is held while a motion such as the
+// touch down bounce moves the base position, so the motion does not end
+// up in the estimate
+
+#include <math.h>
+#include "HeadBaseline.h"
+#include "Diagnostic.h"
+
+// configuration section
+// time constant of the filter, in seconds
+#define BASELINE_TIME_CONSTANT 10.0f
+// longest frame time that will be used for the filter, in seconds
+#define MAX_FRAME_TIME 0.1f
+
+// the neutral head position
+static float Neutral[NUM_HEAD_AXES];
+// TRUE once the estimate has been started
+static bool HaveNeutral;
+// TRUE while following is stopped
+static bool Held;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int HeadBaseline_Init
+  (
+  void
+  )
+{
+  HaveNeutral = FALSE;
+  Held = FALSE;
+
+  return TRUE;
+}
+
+// updates the estimate of the neutral head position, called every frame
+void HeadBaseline_Update
+  (
+  const float *BasePosition,  // NUM_HEAD_AXES head position without motion source offsets
+  float FrameTime             // time since the last update in seconds
+  )
+{
+  if (HaveNeutral == FALSE)
+  {
+    for (int a = 0; a < NUM_HEAD_AXES; a++) Neutral[a] = BasePosition[a];
+    HaveNeutral = TRUE;
+    return;
+  }
+
+  if (Held) return;
+  if (FrameTime <= 0) return;
+  if (FrameTime > MAX_FRAME_TIME) FrameTime = MAX_FRAME_TIME;
+
+  // exact discretization so the filter behaves the same at any frame rate
+  float Gain = 1.0f - expf(-FrameTime / BASELINE_TIME_CONSTANT);
+  for (int a = 0; a < NUM_HEAD_AXES; a++)
+  {
+    Neutral[a] += Gain * (BasePosition[a] - Neutral[a]);
+  }
+}
+
+// stops or restarts following the head, used while a motion is moving
+// the base position of the head
+void HeadBaseline_Hold
+  (
+  bool Hold  // TRUE to stop following, FALSE to follow again
+  )
+{
+  Held = Hold;
+}
+
+// gets the neutral head position for one axis
+float HeadBaseline_GetAxis
+  (
+  head_axis_t Axis
+  )
+{
+  // no estimate yet, the base position is the best we have
+  if (HaveNeutral == FALSE) return HeadCompositor_GetBaseAxis(Axis);
+
+  return Neutral[Axis];
+}
+
+// starts estimating again from the current head position, used when
+// x-plane resets the head
+void HeadBaseline_Reset
+  (
+  void
+  )
+{
+  HaveNeutral = FALSE;
+}
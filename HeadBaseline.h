@@ -0,0 +1,41 @@
+#ifndef _HEADBASELINEH_
+#define _HEADBASELINEH_
+
+#include "Global.h"
+#include "HeadCompositor.h"
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int HeadBaseline_Init
+  (
+  void
+  );
+
+// updates the estimate of the neutral head position, called every frame
+extern void HeadBaseline_Update
+  (
+  const float *BasePosition,  // NUM_HEAD_AXES head position without motion source offsets
+  float FrameTime             // time since the last update in seconds
+  );
+
+// stops or restarts following the head, used while a motion is moving
+// the base position of the head
+extern void HeadBaseline_Hold
+  (
+  bool Hold  // TRUE to stop following, FALSE to follow again
+  );
+
+// gets the neutral head position for one axis
+extern float HeadBaseline_GetAxis
+  (
+  head_axis_t Axis
+  );
+
+// starts estimating again from the current head position, used when
+// x-plane resets the head
+extern void HeadBaseline_Reset
+  (
+  void
+  );
+
+#endif // _HEADBASELINEH_
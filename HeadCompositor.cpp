@@ -0,0 +1,243 @@
+// HEAD COMPOSITOR
+
+// Combines the head offsets of all of the motion sources (rumble, g-seat,
+// vibration etc.) and applies them to the pilots head once per frame
+// Each source owns a slot in a fixed size table that it fills with its
+// offsets. Every frame the slots are summed, clamped and written with one
+// write per axis. The position of the head without offsets (the base
+// position) is tracked separately so movement by the user, by x-plane or by
+// head commands is kept and the head goes back exactly to the base position
+// when all of the offsets are zero
+// The base position is also passed on to the head baseline to estimate the
+// neutral head position
+
+#include <math.h>
+#include "HeadCompositor.h"
+#include "HeadBaseline.h"
+#include "Diagnostic.h"
+#include "SharedData.h"
+#include "Timing.h"
+#include "Profile.h"
+#include "Scheduler.h"
+#include "Clock.h"
+
+// the compositor runs every frame
+#define STATE_MACHINE_EXECUTION_EVERY_FRAME -1.0f
+
+// configuration section
+// limits of the combined offsets in m and degrees
+#define MAX_TRANSLATION 0.05f
+#define MAX_ROTATION    5.0f
+
+// data references that we need
+static XPLMDataRef HeadRefs[NUM_HEAD_AXES];
+
+// offsets of each source
+static float SourceOffsets[HEAD_COMPOSITOR_MAX_SOURCES][NUM_HEAD_AXES];
+static int NumSources;
+
+// head position without offsets and what we last wrote to x-plane
+static float BasePosition[NUM_HEAD_AXES];
+static float WrittenPosition[NUM_HEAD_AXES];
+// true for each axis that is moved away from the base position
+static bool AxisApplied[NUM_HEAD_AXES];
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// limits a value to +/- a maximum
+static float Clamp
+  (
+  float Value,
+  float Limit
+  )
+{
+  if (Value > Limit) return Limit;
+  if (Value < -Limit) return -Limit;
+  return Value;
+}
+
+// combines and applies the offsets, called every frame by x-plane
+// returns the number of seconds to the next execution
+static float Compositor
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  double StartTime = Timing_GetTime();
+  float Total[NUM_HEAD_AXES];
+
+  // single pass over all sources
+  for (int a = 0; a < NUM_HEAD_AXES; a++) Total[a] = 0;
+  for (int s = 0; s < NumSources; s++)
+  {
+    for (int a = 0; a < NUM_HEAD_AXES; a++) Total[a] += SourceOffsets[s][a];
+  }
+
+  for (int a = 0; a < NUM_HEAD_AXES; a++)
+  {
+    float Offset = Clamp(Total[a], a < HEAD_HEADING ? MAX_TRANSLATION : MAX_ROTATION);
+
+    float Current = XPLMGetDataf(HeadRefs[a]);
+    if (AxisApplied[a] == FALSE)
+    {
+      // the head is at the base position
+      BasePosition[a] = Current;
+    }
+    else
+    {
+      // follow any movement made by the user, x-plane or head commands
+      BasePosition[a] += Current - WrittenPosition[a];
+    }
+
+    // nothing to write for axes that are not moved
+    if ((Offset == 0) && (AxisApplied[a] == FALSE)) continue;
+
+    WrittenPosition[a] = BasePosition[a] + Offset;
+    if (WrittenPosition[a] != Current) XPLMSetDataf(HeadRefs[a], WrittenPosition[a]);
+    AxisApplied[a] = (Offset != 0);
+  }
+
+  HeadBaseline_Update(BasePosition, Clock_GetFrameTime(CLOCK_WALL));
+
+  Profile_Record(PROFILE_HEAD_COMPOSITOR, 0, Timing_GetTime() - StartTime);
+
+  return STATE_MACHINE_EXECUTION_EVERY_FRAME;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int HeadCompositor_Init
+  (
+  void
+  )
+{
+  NumSources = 0;
+  for (int a = 0; a < NUM_HEAD_AXES; a++) AxisApplied[a] = FALSE;
+
+  if (!HeadBaseline_Init())
+  {
+    return FALSE;
+  }
+
+  // get datarefs
+  static const char *HeadRefNames[NUM_HEAD_AXES] =
+  {
+    "sim/graphics/view/pilots_head_x",
+    "sim/graphics/view/pilots_head_y",
+    "sim/graphics/view/pilots_head_z",
+    "sim/graphics/view/pilots_head_psi",
+    "sim/graphics/view/pilots_head_the",
+    "sim/graphics/view/pilots_head_phi"
+  };
+  for (int a = 0; a < NUM_HEAD_AXES; a++)
+  {
+    HeadRefs[a] = XPLMFindDataRef(HeadRefNames[a]);
+    if (HeadRefs[a] == NULL)
+    {
+      return FALSE;
+    }
+  }
+
+  // run the compositor every frame, it records its own timing
+  Scheduler_AddTask(Compositor, SCHEDULER_NOT_PROFILED, STATE_MACHINE_EXECUTION_EVERY_FRAME);
+
+  return TRUE;
+}
+
+// registers a motion source, call once when the source is initialized
+// returns the source ID or -1 if there is no more space
+int HeadCompositor_RegisterSource
+  (
+  const char *Name  // name of the source for diagnostics
+  )
+{
+  if (NumSources >= HEAD_COMPOSITOR_MAX_SOURCES)
+  {
+#if DIAGNOSTIC == 1
+    Diagnostic_printf("No space for head motion source %s\n", Name);
+#endif // DIAGNOSTIC
+    return -1;
+  }
+
+  int SourceId = NumSources++;
+  HeadCompositor_ClearOffsets(SourceId);
+
+#if DIAGNOSTIC == 1
+  Diagnostic_printf("Registered head motion source %d: %s\n", SourceId, Name);
+#endif // DIAGNOSTIC
+
+  return SourceId;
+}
+
+// gets the offsets of a motion source
+// the source writes NUM_HEAD_AXES offsets (m and degrees) here whenever they change
+// and they are applied to the head on the next frame
+float *HeadCompositor_GetOffsets
+  (
+  int SourceId  // ID returned by HeadCompositor_RegisterSource
+  )
+{
+  return SourceOffsets[SourceId];
+}
+
+// sets all offsets of a motion source to zero
+void HeadCompositor_ClearOffsets
+  (
+  int SourceId  // ID returned by HeadCompositor_RegisterSource
+  )
+{
+  for (int a = 0; a < NUM_HEAD_AXES; a++) SourceOffsets[SourceId][a] = 0;
+}
+
+// gets the position of the pilots head without any motion source offsets
+void HeadCompositor_GetBasePosition
+  (
+  float *Position  // filled with NUM_HEAD_AXES values
+  )
+{
+  for (int a = 0; a < NUM_HEAD_AXES; a++) Position[a] = HeadCompositor_GetBaseAxis((head_axis_t)a);
+}
+
+// gets the position of the pilots head without any motion source offsets for one axis
+float HeadCompositor_GetBaseAxis
+  (
+  head_axis_t Axis
+  )
+{
+  float Current = XPLMGetDataf(HeadRefs[Axis]);
+  if (AxisApplied[Axis] == FALSE) return Current;
+
+  // include any movement since our last write
+  return BasePosition[Axis] + (Current - WrittenPosition[Axis]);
+}
+
+// called when an event is published, see Events.cpp
+void HeadCompositor_HandleEvent
+  (
+  const event_t *Event
+  )
+{
+  // x-plane resets the head position when it places the aircraft so our offsets are gone,
+  // a crash leaves the head where it is
+  if ((Event->Type == EVENT_SESSION_RESET) && (Event->Reset.Cause != EVENT_PLANE_CRASHED))
+  {
+    for (int a = 0; a < NUM_HEAD_AXES; a++) AxisApplied[a] = FALSE;
+    HeadBaseline_Reset();
+  }
+  // the compositor won't run while disabled so put the head back where it belongs
+  else if (Event->Type == EVENT_PLUGIN_DISABLED)
+  {
+    for (int a = 0; a < NUM_HEAD_AXES; a++)
+    {
+      if (AxisApplied[a]) XPLMSetDataf(HeadRefs[a], BasePosition[a]);
+      AxisApplied[a] = FALSE;
+    }
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef _HEADCOMPOSITORH_
+#define _HEADCOMPOSITORH_
+
+#include "Global.h"
+#include "Events.h"
+
+// maximum number of motion sources that can be registered
+#define HEAD_COMPOSITOR_MAX_SOURCES 8
+
+// axes of the pilots head that can be moved
+typedef enum _head_axis_t
+{
+  HEAD_X,
+  HEAD_Y,
+  HEAD_Z,
+  HEAD_HEADING,
+  HEAD_PITCH,
+  HEAD_ROLL,
+  NUM_HEAD_AXES
+} head_axis_t;
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int HeadCompositor_Init
+  (
+  void
+  );
+
+// registers a motion source, call once when the source is initialized
+// returns the source ID or -1 if there is no more space
+extern int HeadCompositor_RegisterSource
+  (
+  const char *Name  // name of the source for diagnostics
+  );
+
+// gets the offsets of a motion source
+// the source writes NUM_HEAD_AXES offsets (m and degrees) here whenever they change
+// and they are applied to the head on the next frame
+extern float *HeadCompositor_GetOffsets
+  (
+  int SourceId  // ID returned by HeadCompositor_RegisterSource
+  );
+
+// sets all offsets of a motion source to zero
+extern void HeadCompositor_ClearOffsets
+  (
+  int SourceId  // ID returned by HeadCompositor_RegisterSource
+  );
+
+// gets the position of the pilots head without any motion source offsets
+extern void HeadCompositor_GetBasePosition
+  (
+  float *Position  // filled with NUM_HEAD_AXES values
+  );
+
+// gets the position of the pilots head without any motion source offsets for one axis
+extern float HeadCompositor_GetBaseAxis
+  (
+  head_axis_t Axis
+  );
+
+// called when an event is published, see Events.cpp
+extern void HeadCompositor_HandleEvent
+  (
+  const event_t *Event
+  );
+
+#endif // _HEADCOMPOSITORH_
@@ -4,33 +4,32 @@
 
 #include <math.h>
 #include "HeadMotion.h"
+#include "HeadCompositor.h"
+#include "HeadBaseline.h"
 #include "Diagnostic.h"
+#include "SharedData.h"
+#include "Timing.h"
+#include "Config.h"
+#include "Settings.h"
+#include "Profile.h"
+#include "Scheduler.h"
+#include "Clock.h"
+#include "Commands.h"
 
 #define MODULE_NAME "Head Motion"
 
-// time between executions of the state machine, in seconds
-#define STATE_MACHINE_EXECUTION_INTERVAL_NORMAL      0.250f
-#define STATE_MACHINE_EXECUTION_INTERVAL_PERFORMANCE 0.005f
+// the time between executions of the state machine and the shake amplitude
+// are in the configuration file, see Config.cpp
 
 // menu item IDs
 #define MENU_ITEM_ID_TOUCHDOWN_ENABLE 1
 
-// custom commands
-static XPLMCommandRef DisableTouchDownCmd = NULL;
-
 // commands and data references that we need
-static XPLMDataRef    PilotXRef                 = NULL;
-static XPLMDataRef    PilotYRef                 = NULL;
-static XPLMDataRef    PilotZRef                 = NULL;
-static XPLMDataRef    PilotHeadingRef           = NULL;
-static XPLMDataRef    PilotPitchRef             = NULL;
-static XPLMDataRef    PilotRollRef              = NULL;
 static XPLMDataRef    AnyWheelOnGroundRef       = NULL;
 static XPLMDataRef    UpwardGearGroundForceNRef = NULL;
 static XPLMDataRef    TotalDownwardGForceRef    = NULL;
 static XPLMDataRef    GearVerticalForceNmRef    = NULL;
 static XPLMDataRef    VerticalSpeedRef          = NULL;
-static XPLMDataRef    FlightTimeRef             = NULL;
 static XPLMDataRef    AllWheelsOnGroundRef      = NULL;
 static XPLMCommandRef RegularDownCmd            = NULL;
 static XPLMCommandRef RegularUpCmd              = NULL;
@@ -66,44 +65,61 @@ typedef struct _pilots_head_t
 static states_t CurrentState;
 // flag to indicate if we are ready for use
 static bool Ready = FALSE;
-static float TouchdownTime;
-static float BottomTime;
+// times the head started moving down and back up, the movement is felt so it
+// doesn't speed up with time compression
+static double TouchdownTime;
+static double BottomTime;
+// sim time the aircraft was placed for the flight
+static double PlacedTime;
 static pilots_head_t InitialHeadPosition;
 static double LandingShakeAmplitude;
 static double TargetPilotY;
 static XPLMCommandRef UpCommand;
 static XPLMCommandRef DownCommand;
-static bool HaveInitialHeadPosition;
-static bool FastMovement;
+// the command we are holding down, or NULL
+static XPLMCommandRef HeldCommand = NULL;
 static bool Enabled;
 static XPLMMenuID myMenu;
 static int MenuItem_Enable;
 static bool Terminate_Motion;
-static double PreviousFlightTime;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // INTERNAL FUNCTIONS
 
-// enables the touch down motion
-static void DisableTouchDownMotion
+// starts moving the head, ending any movement that is still going
+static void BeginHeadCommand
+  (
+  XPLMCommandRef Command
+  )
+{
+  if (HeldCommand != Command) Commands_Release(HeldCommand);
+  Commands_Hold(Command);
+  HeldCommand = Command;
+}
+
+// stops moving the head, does nothing if it is not moving
+static void EndHeadCommand
   (
   void
   )
 {
+  Commands_Release(HeldCommand);
+  HeldCommand = NULL;
 }
 
-// gets the current position of the pilots' head
+// gets the neutral position of the pilots' head, without the offsets of
+// the other motion sources
 static void GetHeadPosition
   (
-  pilots_head_t *Position  // filled with the current position
+  pilots_head_t *Position  // filled with the neutral position
   )
 {
-  Position->x       = XPLMGetDataf(PilotXRef);
-  Position->y       = XPLMGetDataf(PilotYRef);
-  Position->z       = XPLMGetDataf(PilotZRef);
-  Position->Heading = XPLMGetDataf(PilotHeadingRef);
-  Position->Pitch   = XPLMGetDataf(PilotPitchRef);
-  Position->Roll    = XPLMGetDataf(PilotRollRef);
+  Position->x       = HeadBaseline_GetAxis(HEAD_X);
+  Position->y       = HeadBaseline_GetAxis(HEAD_Y);
+  Position->z       = HeadBaseline_GetAxis(HEAD_Z);
+  Position->Heading = HeadBaseline_GetAxis(HEAD_HEADING);
+  Position->Pitch   = HeadBaseline_GetAxis(HEAD_PITCH);
+  Position->Roll    = HeadBaseline_GetAxis(HEAD_ROLL);
 }
 
 // execute the state machine, called periodically by x-plane
@@ -116,23 +132,11 @@ static float StateMachine
   void *refcon
   )
 {
+  double StartTime = Timing_GetTime();
+  states_t StepState = CurrentState;
   float GearForces[3];
-  float NextInterval = STATE_MACHINE_EXECUTION_INTERVAL_NORMAL;
-  float FlightTime = XPLMGetDataf(FlightTimeRef);
-
-  // new aircraft or location loaded, initialize
-  if (FlightTime < PreviousFlightTime)
-  {
-    Ready = TRUE;
-    CurrentState = START;
-    HaveInitialHeadPosition = FALSE;
-#if DIAGNOSTIC == 1
-    Diagnostic_printf("Start\n");
-#endif // DIAGNOSTIC
-  }
-  PreviousFlightTime = FlightTime;
-
-  if (Enabled == FALSE) return NextInterval;
+  const config_t *Config = Config_Get();
+  float NextInterval = Config->HeadMotionInterval;
   if (Ready == FALSE) return NextInterval;
 
   switch (CurrentState)
@@ -140,7 +144,7 @@ static float StateMachine
     case START:
       // wait for x-plane to drop the plane onto the ground at the start
       // of the simulation
-      if (FlightTime >= 3.0)
+      if (Clock_Get(CLOCK_SIM) - PlacedTime >= 3.0)
       {
 #if DIAGNOSTIC == 1
         Diagnostic_printf("Waiting for X-plane to finish initial aircraft drop\n");
@@ -164,10 +168,6 @@ static float StateMachine
           Diagnostic_printf("All wheels off the ground, waiting for landing...\n");
 #endif // DIAGNOSTIC
           CurrentState = WAIT_FOR_LANDING;
-          if (HaveInitialHeadPosition == FALSE)
-          {
-            GetHeadPosition(&InitialHeadPosition);
-          }
         }
       }
       break;
@@ -188,12 +188,21 @@ static float StateMachine
           Diagnostic_printf("%fN %fG %fNm %fNm %fNm\n", XPLMGetDataf(UpwardGearGroundForceNRef), XPLMGetDataf(TotalDownwardGForceRef), GearForces[0], GearForces[1], GearForces[2]);
 #endif // DIAGNOSTIC
           CurrentState = TOUCHDOWN;
-          TouchdownTime = XPLMGetElapsedTime();
+          TouchdownTime = Clock_Get(CLOCK_UNPAUSED);
+          // the neutral position follows any VR recentering during the flight
+          GetHeadPosition(&InitialHeadPosition);
 #if DIAGNOSTIC == 1
           Diagnostic_printf("Got head height of = %f\n", InitialHeadPosition.y);
 #endif // DIAGNOSTIC
 
           double VerticalSpeedMS = fabs(XPLMGetDataf(VerticalSpeedRef));
+          SharedData_SetLanding((float)VerticalSpeedMS, XPLMGetDataf(TotalDownwardGForceRef));
+
+          event_t Touchdown;
+          Touchdown.Type = EVENT_TOUCHDOWN;
+          Touchdown.Touchdown.SinkRateMS = (float)VerticalSpeedMS;
+          Touchdown.Touchdown.GForce = XPLMGetDataf(TotalDownwardGForceRef);
+          Events_Publish(&Touchdown);
 
           // greater than 2m/s is considered a hard landing:
           // https://en.wikipedia.org/wiki/Hard_landing#:~:text=Landing%20is%20the%20final%20phase,classed%20by%20crew%20as%20hard.
@@ -223,24 +232,31 @@ static float StateMachine
           }
 
           // scale shaking amplitude so 0.0 -> 0.7 m/s = shake amplitude 0.0 -> 0.08 m
+          // (by default, see the configuration file)
 
-          double Slope = 0.7 / 0.08;
-          LandingShakeAmplitude = VerticalSpeedMS / Slope;
+          LandingShakeAmplitude = 0;
+          if (Config->ShakeSinkRate > 0)
+          {
+            double Slope = Config->ShakeSinkRate / Config->ShakeAmplitude;
+            LandingShakeAmplitude = VerticalSpeedMS / Slope;
+          }
           if (LandingShakeAmplitude < 0) LandingShakeAmplitude = 0;
 
 #if DIAGNOSTIC == 1
           Diagnostic_printf("Landing shake amplitude = %fm\n", LandingShakeAmplitude);
 #endif // DIAGNOSTIC
 
-          if (LandingShakeAmplitude > 0)
+          // the touch down is measured and published even when the motion is off,
+          // only moving the head needs it to be on
+          if (Enabled && (LandingShakeAmplitude > 0))
           {
             TargetPilotY = InitialHeadPosition.y - LandingShakeAmplitude;
-            XPLMCommandBegin(DownCommand);
+            BeginHeadCommand(DownCommand);
 #if DIAGNOSTIC == 1
             Diagnostic_printf("Moving head down, target position of %f\n", TargetPilotY);
 #endif // DIAGNOSTIC
 
-            NextInterval = STATE_MACHINE_EXECUTION_INTERVAL_PERFORMANCE;
+            NextInterval = Config->HeadMotionFastInterval;
           }
           else
           {
@@ -253,24 +269,26 @@ static float StateMachine
     case TOUCHDOWN:
       if (Terminate_Motion)
       {
-        XPLMCommandEnd(DownCommand);
+        EndHeadCommand();
         CurrentState = WAIT_FOR_FLYING;
       }
       else
       {
-        double CurrentPilotY = XPLMGetDataf(PilotYRef);
+        double CurrentPilotY = HeadCompositor_GetBaseAxis(HEAD_Y);
 
-        if (CurrentPilotY <= TargetPilotY)
+        // the head may never reach the target, e.g. if something else holds
+        // it, so only go down for a limited time
+        if ((CurrentPilotY <= TargetPilotY) || (Clock_Get(CLOCK_UNPAUSED) - TouchdownTime > Config->HeadMoveTimeout))
         {
-          XPLMCommandEnd(DownCommand);
+          EndHeadCommand();
 #if DIAGNOSTIC == 1
           Diagnostic_printf("Bottom of bounce, current position is %f, going back to %f\n", CurrentPilotY, InitialHeadPosition.y);
 #endif // DIAGNOSTIC
           CurrentState = MOVE_UP;
-          BottomTime = XPLMGetElapsedTime();
+          BottomTime = Clock_Get(CLOCK_UNPAUSED);
         }
 
-        NextInterval = STATE_MACHINE_EXECUTION_INTERVAL_PERFORMANCE;
+        NextInterval = Config->HeadMotionFastInterval;
       }
       break;
 
@@ -281,28 +299,29 @@ static float StateMachine
       }
       else
       {
-        XPLMCommandBegin(UpCommand);
+        BeginHeadCommand(UpCommand);
         CurrentState = RESTORING_POSITION;
-        NextInterval = STATE_MACHINE_EXECUTION_INTERVAL_PERFORMANCE;
+        NextInterval = Config->HeadMotionFastInterval;
       }
       break;
 
     case RESTORING_POSITION:
       if (Terminate_Motion)
       {
-        XPLMCommandEnd(UpCommand);
+        EndHeadCommand();
         CurrentState = WAIT_FOR_FLYING;
       }
       else
       {
-        double CurrentPilotY = XPLMGetDataf(PilotYRef);
+        double CurrentPilotY = HeadCompositor_GetBaseAxis(HEAD_Y);
 
-        if (CurrentPilotY >= InitialHeadPosition.y)
+        // going up takes about as long as going down, don't hold the command for ever
+        if ((CurrentPilotY >= InitialHeadPosition.y) || (Clock_Get(CLOCK_UNPAUSED) - BottomTime > 2 * Config->HeadMoveTimeout))
         {
 #if DIAGNOSTIC == 1
           Diagnostic_printf("End of movement, current position is %f\n", CurrentPilotY);
 #endif // DIAGNOSTIC
-          XPLMCommandEnd(UpCommand);
+          EndHeadCommand();
 
           // check if nose wheel is down
           XPLMGetDatavf(GearVerticalForceNmRef, GearForces, 0, 3);
@@ -318,7 +337,7 @@ static float StateMachine
         }
         else
         {
-          NextInterval = STATE_MACHINE_EXECUTION_INTERVAL_PERFORMANCE;
+          NextInterval = Config->HeadMotionFastInterval;
         }
       }
       break;
@@ -328,6 +347,11 @@ static float StateMachine
       {
         CurrentState = WAIT_FOR_FLYING;
       }
+      // bounced or went around before the nose wheel came down
+      else if (XPLMGetDatai(AnyWheelOnGroundRef) == FALSE)
+      {
+        CurrentState = WAIT_FOR_LANDING;
+      }
       else
       {
         // wait for all wheels on the ground
@@ -335,37 +359,26 @@ static float StateMachine
         {
           // small bump
           TargetPilotY = InitialHeadPosition.y - 0.005;
-          XPLMCommandBegin(DownCommand);
+          TouchdownTime = Clock_Get(CLOCK_UNPAUSED);
+          BeginHeadCommand(DownCommand);
 #if DIAGNOSTIC == 1
           Diagnostic_printf("Nose down so moving head down, target position of %f\n", TargetPilotY);
 #endif // DIAGNOSTIC
 
           CurrentState = TOUCHDOWN;
-          NextInterval = STATE_MACHINE_EXECUTION_INTERVAL_PERFORMANCE;
+          NextInterval = Config->HeadMotionFastInterval;
         }
       }
       break;
   }
 
-  return NextInterval;
-}
+  // keep the touch down motion out of the neutral head position
+  HeadBaseline_Hold((CurrentState == TOUCHDOWN) || (CurrentState == MOVE_UP) || (CurrentState == RESTORING_POSITION));
 
-// handles the release command
-static int ReleaseCmdHandler
-(
-  XPLMCommandRef inCommand,
-  XPLMCommandPhase inPhase,
-  void *inRefcon
-)
-{
-  // If inPhase == 0 the command is executed once on button down.
-  if (inPhase == 0)
-  {
-    DisableTouchDownMotion();
-  }
+  SharedData_SetHeadMotionState(CurrentState, Enabled);
+  Profile_Record(PROFILE_HEAD_MOTION, StepState, Timing_GetTime() - StartTime);
 
-  // disable further processing of this command
-  return 0;
+  return NextInterval;
 }
 
 // called when the user chooses a menu item
@@ -376,11 +389,9 @@ static void MenuHandlerCallback
 )
 {
   // user chose to release the parking brake
-  if ((int)inItemRef == MENU_ITEM_ID_TOUCHDOWN_ENABLE)
+  if ((intptr_t)inItemRef == MENU_ITEM_ID_TOUCHDOWN_ENABLE)
   {
-    Enabled = !Enabled;
-
-    XPLMCheckMenuItem(myMenu, MenuItem_Enable, Enabled ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+    HeadMotion_SetEnabled(!Enabled);
   }
 }
 
@@ -395,7 +406,7 @@ int HeadMotion_Init
   XPLMMenuID ParentMenuId
   )
 {
-  Enabled = FALSE;
+  Enabled = Settings_Get()->TouchdownMotionEnabled;
 
   int mySubMenuItem = XPLMAppendMenuItem(
     ParentMenuId,
@@ -424,36 +435,6 @@ int HeadMotion_Init
   }
 
   // get datarefs
-  PilotXRef = XPLMFindDataRef("sim/graphics/view/pilots_head_x");
-  if (PilotXRef == NULL)
-  {
-    return FALSE;
-  }
-  PilotYRef = XPLMFindDataRef("sim/graphics/view/pilots_head_y");
-  if (PilotYRef == NULL)
-  {
-    return FALSE;
-  }
-  PilotZRef = XPLMFindDataRef("sim/graphics/view/pilots_head_z");
-  if (PilotZRef == NULL)
-  {
-    return FALSE;
-  }
-  PilotHeadingRef = XPLMFindDataRef("sim/graphics/view/pilots_head_psi");
-  if (PilotHeadingRef == NULL)
-  {
-    return FALSE;
-  }
-  PilotPitchRef = XPLMFindDataRef("sim/graphics/view/pilots_head_the");
-  if (PilotPitchRef == NULL)
-  {
-    return FALSE;
-  }
-  PilotRollRef = XPLMFindDataRef("sim/graphics/view/pilots_head_phi");
-  if (PilotRollRef == NULL)
-  {
-    return FALSE;
-  }
   AnyWheelOnGroundRef = XPLMFindDataRef("sim/flightmodel/failures/onground_any");
   if (AnyWheelOnGroundRef == NULL)
   {
@@ -485,11 +466,6 @@ int HeadMotion_Init
   {
     return FALSE;
   }
-  FlightTimeRef = XPLMFindDataRef("sim/time/total_flight_time_sec");
-  if (FlightTimeRef == NULL)
-  {
-    return FALSE;
-  }
   RegularDownCmd = XPLMFindCommand("sim/general/down");
   if (RegularDownCmd == NULL)
   {
@@ -511,38 +487,68 @@ int HeadMotion_Init
     return FALSE;
   }
 
-  // register the state machine callback
-  XPLMRegisterFlightLoopCallback(StateMachine, STATE_MACHINE_EXECUTION_INTERVAL_NORMAL, NULL);
-
-  HaveInitialHeadPosition = FALSE;
+  // run the state machine periodically, it records its own timing
+  Scheduler_AddTask(StateMachine, SCHEDULER_NOT_PROFILED, Config_Get()->HeadMotionInterval);
 
   return TRUE;
 }
 
-// called when a message is received from X-plane
-void HeadMotion_ReceiveMessage
+// enables or disables the touch down motion
+void HeadMotion_SetEnabled
+  (
+  bool Enable  // TRUE to enable
+  )
+{
+  Enabled = Enable;
+
+  // the head isn't moved while disabled, so stop any movement now
+  if ((Enabled == FALSE) && ((CurrentState == TOUCHDOWN) || (CurrentState == MOVE_UP) || (CurrentState == RESTORING_POSITION)))
+  {
+    EndHeadCommand();
+    CurrentState = WAIT_FOR_FLYING;
+    HeadBaseline_Hold(FALSE);
+  }
+  SharedData_SetHeadMotionState(CurrentState, Enabled);
+
+  Settings_Get()->TouchdownMotionEnabled = Enabled;
+  Settings_Changed();
+
+  XPLMCheckMenuItem(myMenu, MenuItem_Enable, Enabled ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+}
+
+// called when an event is published, see Events.cpp
+void HeadMotion_HandleEvent
   (
-  XPLMPluginID inFromWho,
-  int	inMessage,
-  void *inParam
+  const event_t *Event
   )
 {
-  // a new aircraft has been loaded
-  if (inMessage == XPLM_MSG_PLANE_LOADED)
+  // the aircraft has been placed for a new flight, initialize
+  if ((Event->Type == EVENT_SESSION_RESET) && (Event->Reset.Cause != EVENT_PLANE_UNLOADED) && (Event->Reset.Cause != EVENT_PLANE_CRASHED))
   {
-//#if DIAGNOSTIC == 1
-    //Diagnostic_printf("Ready to go\n");
-//#endif // DIAGNOSTIC
-    //Ready = TRUE;
-    //CurrentState = START;
-    //HaveInitialHeadPosition = FALSE;
-    PreviousFlightTime = 10;
+    EndHeadCommand();
+    Ready = TRUE;
+    CurrentState = START;
+    PlacedTime = Clock_Get(CLOCK_SIM);
+#if DIAGNOSTIC == 1
+    Diagnostic_printf("Start\n");
+#endif // DIAGNOSTIC
   }
-  else if ((inMessage == XPLM_MSG_PLANE_UNLOADED) || (inMessage == XPLM_MSG_PLANE_CRASHED))
+  // wait for the aircraft to be placed again
+  else if (Event->Type == EVENT_SESSION_RESET)
   {
 #if DIAGNOSTIC == 1
     Diagnostic_printf("Aircraft crashed or unloaded\n");
 #endif // DIAGNOSTIC
     Terminate_Motion = TRUE;
+    EndHeadCommand();
+  }
+  // stop any movement, when enabled again carry on with the same flight from waiting to fly
+  else if (Event->Type == EVENT_PLUGIN_DISABLED)
+  {
+#if DIAGNOSTIC == 1
+    Diagnostic_printf("Plugin disabled\n");
+#endif // DIAGNOSTIC
+    EndHeadCommand();
+    if (CurrentState != START) CurrentState = WAIT_FOR_FLYING;
   }
 }
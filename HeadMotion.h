@@ -2,6 +2,7 @@
 #define _HEADMOTIONH_
 
 #include "Global.h"
+#include "Events.h"
 
 // initalizes the module
 // returns TRUE for success, FALSE for error
@@ -10,12 +11,16 @@ extern int HeadMotion_Init
   XPLMMenuID ParentMenuId
   );
 
-// called when a message is received from X-plane
-extern void HeadMotion_ReceiveMessage
+// enables or disables the touch down motion
+extern void HeadMotion_SetEnabled
   (
-  XPLMPluginID inFromWho,
-  int	inMessage,
-  void *inParam
+  bool Enable  // TRUE to enable
+  );
+
+// called when an event is published, see Events.cpp
+extern void HeadMotion_HandleEvent
+  (
+  const event_t *Event
   );
 
 #endif // _HEADMOTIONH_
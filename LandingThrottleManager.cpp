@@ -13,32 +13,47 @@
 // when all wheels are down the reverse thrust is applied until a speed of 60KIAS
 // is reached at which point reverse thrust is disabled and the throttle
 // returned to idle
+// the reversers of each engine are handled separately so aircraft with any
+// number of engines can be used, and an engine that has failed is left out
+// together with the engine on the opposite side
 // if the conditions are not met to enable the plugin then voice guidance will be given
 // as to which conditions are not being met
+// the conditions are checked in the background while waiting for the user and kept
+// as a bit mask, so enabling is just a look up of the mask and of a phrase that was
+// made when the plugin started. optionally the plugin will say once per approach
+// when all of the conditions have been met
 
 #include "LandingThrottleManager.h"
 #include "Diagnostic.h"
+#include "SharedData.h"
+#include "Timing.h"
+#include "RolloutController.h"
+#include "ReverseThrust.h"
+#include "Speech.h"
+#include "Config.h"
+#include "Settings.h"
+#include "Profile.h"
+#include "Scheduler.h"
+#include "Clock.h"
+#include "Commands.h"
 
 #define MODULE_NAME "Landing Throttle Manager"
 
-// configuration section
-// minimum speed in knots at which the reverse thrust can be enabled
-#define MIN_SPEED_REVERSE_THRUST 60.0f
-// maximum speed in knots at which the manager can be enabled
-#define MAX_AIRSPEED 160.0f
-// minimum flap angle at which the manager can be enabled
-#define MIN_FLAP_ANGLE 18.0f
-// maximum height above ground in meters at which the manager can be enabled
-#define MAX_ALTITUDE 152.4f
-
-// time between executions of the state machine, in seconds
-#define STATE_MACHINE_EXECUTION_INTERVAL 0.25f
+// the speeds, flap angle, altitude, reverse thrust and state machine interval
+// are in the configuration file, see Config.cpp
+
 // the ratio of the gears when they are down
 #define GEAR_DOWN_RATIO 1.0f
 
 // menu item IDs
-#define MENU_ITEM_ID_ENABLE 1
-#define MENU_ITEM_ID_STOP   2
+#define MENU_ITEM_ID_ENABLE   1
+#define MENU_ITEM_ID_STOP     2
+#define MENU_ITEM_ID_ANNOUNCE 3
+
+// every combination of the conditions that stop the manager being enabled
+#define NUM_CONDITION_COMBINATIONS (1 << NUM_CONDITIONS)
+// longest phrase for a combination of conditions
+#define MAX_CONDITION_PHRASE 100
 
 // state machine states
 typedef enum _states_t
@@ -49,14 +64,16 @@ typedef enum _states_t
   WAIT_FOR_IDLE_THROTTLE,
   WAIT_FOR_TOUCHDOWN,
   APPLY_REVERSE,
-  WAIT_FOR_END_OF_REVERSE
+  WAIT_FOR_END_OF_REVERSE,
+  WAIT_FOR_END_OF_ROLLOUT
 } states_t;
 
 // identifiers of known aircraft
 typedef enum _aircraft_id_t
 {
   AIRCRAFT_UNKNOWN,
-  AIRCRAFT_XCRAFTS_ERJ_FAMILY
+  AIRCRAFT_XCRAFTS_ERJ_FAMILY,
+  AIRCRAFT_LAMINAR_737
 } aircraft_id_t;
 
 // describes a know aircraft
@@ -68,9 +85,7 @@ typedef struct _known_aircraft_t
 } known_aircraft_t;
 
 // commands and data references that we need
-static XPLMCommandRef ReverseThrustCmd = NULL;
 static XPLMCommandRef ThrottleDownCmd = NULL;
-static XPLMDataRef    ThrottleRatioRef = NULL;
 static XPLMDataRef    IndicatedAirSpeedRef = NULL;
 static XPLMDataRef    AllWheelsOnGroundRef = NULL;
 static XPLMDataRef    FlapsAngleRef = NULL;
@@ -88,16 +103,117 @@ static bool DeactivationRequested = FALSE;
 static void	MenuHandlerCallback(void *inMenuRef, void *inItemRef);
 // flag to indicate if we are ready for use
 static bool Ready = FALSE;
+// time the current state was entered, for states that can time out
+static double StateStartTime;
+static XPLMMenuID myMenu;
+static int MenuItem_Announce;
+
+// conditions that are not met, updated while waiting for the user
+static int FailedConditions;
+static bool FailedConditionsValid = FALSE;
+// flag to indicate if the user wants to be told when the conditions are met
+static bool AnnounceWhenReady = FALSE;
+// flag to indicate if we have already told the user on this approach
+static bool Announced = FALSE;
+
+// what is said for each condition that is not met, in bit order
+static const char *ConditionPhrases[NUM_CONDITIONS] =
+{
+  " Airspeed too high",
+  " Flaps too low",
+  " Gear not down",
+  " Altitude too high"
+};
+// what is said for each combination of conditions that are not met
+static char CombinationPhrases[NUM_CONDITION_COMBINATIONS][MAX_CONDITION_PHRASE];
 
 // all the known aircraft
 static _known_aircraft_t KnownAircrafts[] =
 {
   {AIRCRAFT_XCRAFTS_ERJ_FAMILY, "x-crafts erj", "X-Crafts ERJ Family"},
+  {AIRCRAFT_LAMINAR_737, "boeing 737-800", "Boeing 737-800"},
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // INTERNAL FUNCTIONS
 
+// makes the phrases for every combination of conditions that are not met
+static void MakeCombinationPhrases
+  (
+  void
+  )
+{
+  for (int m = 0; m < NUM_CONDITION_COMBINATIONS; m++)
+  {
+    CombinationPhrases[m][0] = '\0';
+    for (int c = 0; c < NUM_CONDITIONS; c++)
+    {
+      if (m & (1 << c)) strcat_s(CombinationPhrases[m], MAX_CONDITION_PHRASE, ConditionPhrases[c]);
+    }
+  }
+}
+
+// checks which conditions for enabling the manager are not met
+static void EvaluateConditions
+  (
+  void
+  )
+{
+  const config_t *Config = Config_Get();
+  float IndicatedAirSpeed = XPLMGetDataf(IndicatedAirSpeedRef);
+  float FlapAngles[1];
+  XPLMGetDatavf(FlapsAngleRef, FlapAngles, 0, 1);
+  float GearDeployRatio[1];
+  XPLMGetDatavf(GearDeployRatioRef, GearDeployRatio, 0, 1);
+  float AltitudeAboveGround = XPLMGetDataf(AltitudeAboveGroundRef);
+
+  int Failed = 0;
+  if (IndicatedAirSpeed > Config->MaxAirspeed) Failed |= CONDITION_AIRSPEED;
+  if (FlapAngles[0] < Config->MinFlapAngle) Failed |= CONDITION_FLAPS;
+  if (GearDeployRatio[0] != GEAR_DOWN_RATIO) Failed |= CONDITION_GEAR;
+  if (AltitudeAboveGround > Config->MaxAltitude) Failed |= CONDITION_ALTITUDE;
+
+  // tell the user once per approach when everything is ready, the approach
+  // starts again when the aircraft climbs above the maximum altitude
+  if (Failed & CONDITION_ALTITUDE)
+  {
+    Announced = FALSE;
+  }
+  else if ((Failed == 0) && (FailedConditions != 0) && AnnounceWhenReady && (Announced == FALSE) &&
+    (XPLMGetDatai(AllWheelsOnGroundRef) == FALSE))
+  {
+    Speech_Say("Ready to enable", SPEECH_PRIORITY_NORMAL);
+    Announced = TRUE;
+  }
+
+  FailedConditions = Failed;
+  FailedConditionsValid = TRUE;
+  SharedData_SetThrottleManagerConditions(Failed);
+}
+
+// stops whatever the manager is doing and releases everything it holds
+static void Reset
+  (
+  void
+  )
+{
+  Commands_Release(ThrottleDownCmd);
+  ReverseThrust_Stow();
+  RolloutController_Stop();
+
+  DeactivationRequested = FALSE;
+  CurrentState = WAIT_FOR_USER;
+}
+
+// makes the current state available to other plugins
+static void PublishState
+  (
+  void
+  )
+{
+  SharedData_SetThrottleManagerState(CurrentState, CurrentState != WAIT_FOR_USER, Ready);
+}
+
 // execute the state machine, called periodically by x-plane
 // returns the number of seconds to the next execution
 static float StateMachine
@@ -108,21 +224,30 @@ static float StateMachine
   void *refcon
   )
 {
-  if (Ready == FALSE) return STATE_MACHINE_EXECUTION_INTERVAL;
+  double StartTime = Timing_GetTime();
+  states_t StepState = CurrentState;
+  const config_t *Config = Config_Get();
+
+  if (Ready == FALSE)
+  {
+    PublishState();
+    return Config->ThrottleManagerInterval;
+  }
 
   switch (CurrentState)
   {
     // the current state needs to be set to START to exit
     // this state
   case WAIT_FOR_USER:
+    EvaluateConditions();
     break;
 
     // start the manager
   case START:
   {
-    float ThrottleRatio = XPLMGetDataf(ThrottleRatioRef);
+    ReverseThrust_Update();
 
-    if (ThrottleRatio > 0)
+    if (ReverseThrust_IsIdle() == FALSE)
     {
       CurrentState = THROTTLE_DOWN;
 #if DIAGNOSTIC == 1
@@ -145,8 +270,9 @@ static float StateMachine
 #if DIAGNOSTIC == 1
     Diagnostic_printf("Throttling down, waiting for idle throttle\n");
 #endif // DIAGNOSTIC
-    XPLMCommandBegin(ThrottleDownCmd);
+    Commands_Hold(ThrottleDownCmd);
     CurrentState = WAIT_FOR_IDLE_THROTTLE;
+    StateStartTime = Clock_Get(CLOCK_SIM);
   }
   break;
 
@@ -155,7 +281,7 @@ static float StateMachine
   {
     if (DeactivationRequested == TRUE)
     {
-      XPLMCommandEnd(ThrottleDownCmd);
+      Commands_Release(ThrottleDownCmd);
       DeactivationRequested = FALSE;
       CurrentState = WAIT_FOR_USER;
 #if DIAGNOSTIC == 1
@@ -164,15 +290,26 @@ static float StateMachine
     }
     else
     {
-      float ThrottleRatio = XPLMGetDataf(ThrottleRatioRef);
-      if (ThrottleRatio == 0)
+      ReverseThrust_Update();
+      if (ReverseThrust_IsIdle())
       {
-        XPLMCommandEnd(ThrottleDownCmd);
+        Commands_Release(ThrottleDownCmd);
 #if DIAGNOSTIC == 1
         Diagnostic_printf("Throttle now at idle, waiting for touch down of all three wheels\n");
 #endif // DIAGNOSTIC
         CurrentState = WAIT_FOR_TOUCHDOWN;
       }
+      // something is holding the throttles, e.g. a hardware throttle, so give up
+      // rather than holding the command for ever
+      else if (Clock_Get(CLOCK_SIM) - StateStartTime > Config->IdleThrottleTimeout)
+      {
+        Commands_Release(ThrottleDownCmd);
+#if DIAGNOSTIC == 1
+        Diagnostic_printf("Throttle did not reach idle, disabling\n");
+#endif // DIAGNOSTIC
+        Speech_Say("Throttle not at idle, disabled", SPEECH_PRIORITY_HIGH);
+        CurrentState = WAIT_FOR_USER;
+      }
     }
   }
   break;
@@ -183,7 +320,6 @@ static float StateMachine
   {
     if (DeactivationRequested == TRUE)
     {
-      XPLMCommandEnd(ReverseThrustCmd);
       DeactivationRequested = FALSE;
       CurrentState = WAIT_FOR_USER;
 #if DIAGNOSTIC == 1
@@ -200,6 +336,15 @@ static float StateMachine
 #endif // DIAGNOSTIC
         CurrentState = APPLY_REVERSE;
       }
+      // climbed away, so this is a go around and there will be no touch down
+      else if (XPLMGetDataf(AltitudeAboveGroundRef) > Config->MaxAltitude)
+      {
+#if DIAGNOSTIC == 1
+        Diagnostic_printf("Go around while waiting for touch down\n");
+#endif // DIAGNOSTIC
+        Speech_Say("Go around, disabled", SPEECH_PRIORITY_HIGH);
+        CurrentState = WAIT_FOR_USER;
+      }
     }
   }
   break;
@@ -208,13 +353,32 @@ static float StateMachine
   case APPLY_REVERSE:
   {
     float IndicatedAirSpeed = XPLMGetDataf(IndicatedAirSpeedRef);
-    if (IndicatedAirSpeed > MIN_SPEED_REVERSE_THRUST)
+    if (RolloutController_Start(Config->MinSpeedReverseThrust))
+    {
+      // the autobrake will manage the reverse thrust and brakes
+#if DIAGNOSTIC == 1
+      Diagnostic_printf("Autobrake is on, waiting for end of rollout\n");
+#endif // DIAGNOSTIC
+      CurrentState = WAIT_FOR_END_OF_ROLLOUT;
+    }
+    else if (IndicatedAirSpeed > Config->MinSpeedReverseThrust)
     {
-      XPLMCommandBegin(ReverseThrustCmd);
+      ReverseThrust_Update();
+      if (ReverseThrust_Deploy())
+      {
+        ReverseThrust_SetRatio(Config->ReverseThrustRatio);
+#if DIAGNOSTIC == 1
+        Diagnostic_printf("Indicated air speed=%f which is above the minimum of %f, waiting for end condition\n", IndicatedAirSpeed, Config->MinSpeedReverseThrust);
+#endif // DIAGNOSTIC
+        CurrentState = WAIT_FOR_END_OF_REVERSE;
+      }
+      else
+      {
 #if DIAGNOSTIC == 1
-      Diagnostic_printf("Indicated air speed=%f which is above the minimum of %f, waiting for end condition\n", IndicatedAirSpeed, MIN_SPEED_REVERSE_THRUST);
+        Diagnostic_printf("No engines can be used for reverse thrust\n");
 #endif // DIAGNOSTIC
-      CurrentState = WAIT_FOR_END_OF_REVERSE;
+        CurrentState = WAIT_FOR_USER;
+      }
     }
     else
     {
@@ -228,7 +392,7 @@ static float StateMachine
   {
     if (DeactivationRequested == TRUE)
     {
-      XPLMCommandEnd(ReverseThrustCmd);
+      ReverseThrust_Stow();
       DeactivationRequested = FALSE;
       CurrentState = WAIT_FOR_USER;
 #if DIAGNOSTIC == 1
@@ -237,21 +401,61 @@ static float StateMachine
     }
     else
     {
+      // stows the reversers of an engine that has failed and the engine opposite it
+      ReverseThrust_Update();
+
       float IndicatedAirSpeed = XPLMGetDataf(IndicatedAirSpeedRef);
-      if (IndicatedAirSpeed <= MIN_SPEED_REVERSE_THRUST)
+      if (ReverseThrust_IsDeployed() == FALSE)
+      {
+#if DIAGNOSTIC == 1
+        Diagnostic_printf("No engines left for reverse thrust\n");
+#endif // DIAGNOSTIC
+        CurrentState = WAIT_FOR_USER;
+      }
+      else if (IndicatedAirSpeed <= Config->MinSpeedReverseThrust)
       {
-        XPLMCommandEnd(ReverseThrustCmd);
+        ReverseThrust_Stow();
 #if DIAGNOSTIC == 1
-        Diagnostic_printf("Indicated air speed is %f, which is less than %f, end of reverse thrust\n", IndicatedAirSpeed, MIN_SPEED_REVERSE_THRUST);
+        Diagnostic_printf("Indicated air speed is %f, which is less than %f, end of reverse thrust\n", IndicatedAirSpeed, Config->MinSpeedReverseThrust);
 #endif // DIAGNOSTIC
         CurrentState = WAIT_FOR_USER;
       }
+      else
+      {
+        // reverse thrust is applied to each engine once its reversers are out
+        ReverseThrust_SetRatio(Config->ReverseThrustRatio);
+      }
+    }
+  }
+  break;
+
+  // wait for the autobrake to bring the aircraft to taxi speed
+  case WAIT_FOR_END_OF_ROLLOUT:
+  {
+    if (DeactivationRequested == TRUE)
+    {
+      RolloutController_Stop();
+      DeactivationRequested = FALSE;
+      CurrentState = WAIT_FOR_USER;
+#if DIAGNOSTIC == 1
+      Diagnostic_printf("Deactivation while waiting for end of rollout\n");
+#endif // DIAGNOSTIC
+    }
+    else if (RolloutController_IsActive() == FALSE)
+    {
+#if DIAGNOSTIC == 1
+      Diagnostic_printf("End of rollout\n");
+#endif // DIAGNOSTIC
+      CurrentState = WAIT_FOR_USER;
     }
   }
   break;
   }
 
-  return STATE_MACHINE_EXECUTION_INTERVAL;
+  PublishState();
+  Profile_Record(PROFILE_LANDING_THROTTLE_MANAGER, StepState, Timing_GetTime() - StartTime);
+
+  return Config->ThrottleManagerInterval;
 }
 
 // enables the manager
@@ -265,42 +469,46 @@ static void Enable
   // trigger the state machine
   if (CurrentState == WAIT_FOR_USER)
   {
-    float IndicatedAirSpeed = XPLMGetDataf(IndicatedAirSpeedRef);
-    float FlapAngles[1];
-    XPLMGetDatavf(FlapsAngleRef, FlapAngles, 0, 1);
-    float GearDeployRatio[1];
-    XPLMGetDatavf(GearDeployRatioRef, GearDeployRatio, 0, 1);
-    float AltitudeAboveGround = XPLMGetDataf(AltitudeAboveGroundRef);
+    // the conditions are normally already known from the state machine
+    if (FailedConditionsValid == FALSE) EvaluateConditions();
 
 #if DIAGNOSTIC == 1
-    Diagnostic_printf("Enable requested by user\n");
-    Diagnostic_printf("Current IAS=%f (require %f or below)\n", IndicatedAirSpeed, MAX_AIRSPEED);
-    Diagnostic_printf("Current flap angle=%f (require %f or above)\n", FlapAngles[0], MIN_FLAP_ANGLE);
-    Diagnostic_printf("Current gears are down=%s (require yes)\n", GearDeployRatio[0] == GEAR_DOWN_RATIO ? "yes" : "no");
-    Diagnostic_printf("Current altitude=%fm (require %fm or below)\n", AltitudeAboveGround, MAX_ALTITUDE);
+    Diagnostic_printf("Enable requested by user, conditions not met=0x%02X\n", FailedConditions);
 #endif // DIAGNOSTIC
 
-    if ((IndicatedAirSpeed <= MAX_AIRSPEED) && (FlapAngles[0] >= MIN_FLAP_ANGLE) && (GearDeployRatio[0] == GEAR_DOWN_RATIO) && (AltitudeAboveGround <= MAX_ALTITUDE))
+    if (FailedConditions == 0)
     {
       DeactivationRequested = FALSE;
       CurrentState = START;
+      FailedConditionsValid = FALSE;
+      PublishState();
 #if DIAGNOSTIC == 1
       Diagnostic_printf("Conditions met, now enabled\n");
 #endif // DIAGNOSTIC
     }
     else
     {
-      char Errors[256] = "";
-      if (IndicatedAirSpeed > MAX_AIRSPEED) strcat_s(Errors, 256, " Airspeed too high");
-      if (FlapAngles[0] < MIN_FLAP_ANGLE) strcat_s(Errors, 256, " Flaps too low");
-      if (GearDeployRatio[0] != GEAR_DOWN_RATIO) strcat_s(Errors, 256, " Gear not down");
-      if (AltitudeAboveGround > MAX_ALTITUDE) strcat_s(Errors, 256, " Altitude too high");
-      if (strlen(Errors) > 0) XPLMSpeakString(Errors);
+      Speech_Say(CombinationPhrases[FailedConditions], SPEECH_PRIORITY_NORMAL);
     }
   }
   else
   {
-    XPLMSpeakString("Already enabled");
+    Speech_Say("Already enabled", SPEECH_PRIORITY_NORMAL);
+  }
+}
+
+// stops and disables the manager
+static void Disable
+(
+  void
+)
+{
+  if (CurrentState != WAIT_FOR_USER)
+  {
+    DeactivationRequested = TRUE;
+#if DIAGNOSTIC == 1
+    Diagnostic_printf("User requested deactivation\n");
+#endif // DIAGNOSTIC
   }
 }
 
@@ -317,7 +525,7 @@ static int EnableCmdHandler
   {
     if (Ready == FALSE)
     {
-      XPLMSpeakString("Plugin failed to load, check the aircraft is known");
+      Speech_Say("Plugin failed to load, check the aircraft is known", SPEECH_PRIORITY_HIGH);
       return 0;
     }
 
@@ -337,25 +545,27 @@ static void MenuHandlerCallback
 {
   if (Ready == FALSE)
   {
-    XPLMSpeakString("Plugin failed to load, check the aircraft is known");
+    Speech_Say("Plugin failed to load, check the aircraft is known", SPEECH_PRIORITY_HIGH);
     return;
   }
 
   // user chose to arm the manager
-  if ((int)inItemRef == MENU_ITEM_ID_ENABLE)
+  if ((intptr_t)inItemRef == MENU_ITEM_ID_ENABLE)
   {
     Enable();
   }
   // user choose to stop the manager
-  else if ((int)inItemRef == MENU_ITEM_ID_STOP)
+  else if ((intptr_t)inItemRef == MENU_ITEM_ID_STOP)
   {
-    if (CurrentState != WAIT_FOR_USER)
-    {
-      DeactivationRequested = TRUE;
-#if DIAGNOSTIC == 1
-      Diagnostic_printf("User requested deactivation\n");
-#endif // DIAGNOSTIC
-    }
+    Disable();
+  }
+  // user chose to toggle the announcement when the conditions are met
+  else if ((intptr_t)inItemRef == MENU_ITEM_ID_ANNOUNCE)
+  {
+    AnnounceWhenReady = !AnnounceWhenReady;
+    Settings_Get()->AnnounceWhenReady = AnnounceWhenReady;
+    Settings_Changed();
+    XPLMCheckMenuItem(myMenu, MenuItem_Announce, AnnounceWhenReady ? xplm_Menu_Checked : xplm_Menu_Unchecked);
   }
 }
 
@@ -372,7 +582,7 @@ static aircraft_id_t DetectAircraft
     // get aircraft description and convert to lower case
     char Description[256];
     XPLMGetDatab(AircraftDescriptionRef, (void *)Description, 0, 256);
-    for (int c = 0; c < strlen(Description); c++) Description[c] = tolower(Description[c]);
+    for (size_t c = 0; c < strlen(Description); c++) Description[c] = tolower(Description[c]);
 
 #if DIAGNOSTIC == 1
     Diagnostic_printf("Aircraft loaded = '%s'\n", Description);
@@ -408,11 +618,13 @@ int LandingThrottleManager_Init
   XPLMMenuID ParentMenuId
   )
 {
-  XPLMMenuID myMenu;
   int mySubMenuItem;
 
   // not ready until we know what aircraft will be used
   Ready = FALSE;
+  FailedConditionsValid = FALSE;
+  Announced = FALSE;
+  AnnounceWhenReady = Settings_Get()->AnnounceWhenReady;
 
   mySubMenuItem = XPLMAppendMenuItem(
     ParentMenuId,
@@ -439,6 +651,15 @@ int LandingThrottleManager_Init
     "Stop and disable",
     (void *)MENU_ITEM_ID_STOP,
     1);
+  MenuItem_Announce = XPLMAppendMenuItem(
+    myMenu,
+    "Announce when ready",
+    (void *)MENU_ITEM_ID_ANNOUNCE,
+    1);
+  XPLMCheckMenuItem(myMenu, MenuItem_Announce, AnnounceWhenReady ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+
+  // the phrases are only made once so nothing is built when the user presses enable
+  MakeCombinationPhrases();
 
   // create custom command
   char CmdName[100];
@@ -446,7 +667,7 @@ int LandingThrottleManager_Init
   char CmdDesc[100];
   sprintf_s(CmdDesc, 100, "Enable the throttle manager (%s-%s)", PLUGIN_NAME, MODULE_NAME);
   EnableCmd = XPLMCreateCommand(CmdName, CmdDesc);
-  XPLMRegisterCommandHandler(
+  Commands_RegisterHandler(
     EnableCmd,         // in Command name
     EnableCmdHandler,  // in Handler
     1,                 // Receive input before plugin windows.
@@ -455,37 +676,67 @@ int LandingThrottleManager_Init
   // initialize state machine
   CurrentState = WAIT_FOR_USER;
 
-  // register the state machine callback
-  XPLMRegisterFlightLoopCallback(StateMachine, STATE_MACHINE_EXECUTION_INTERVAL, NULL);
+  // run the state machine periodically, it records its own timing
+  Scheduler_AddTask(StateMachine, SCHEDULER_NOT_PROFILED, Config_Get()->ThrottleManagerInterval);
 
   return TRUE;
 }
 
-// called when a message is received from X-plane
-void LandingThrottleManager_ReceiveMessage
+// arms the manager if the landing conditions are met
+void LandingThrottleManager_Arm
   (
-  XPLMPluginID inFromWho,
-  int	inMessage,
-  void *inParam
+  void
   )
 {
+  if (Ready == FALSE)
+  {
+    Speech_Say("Plugin failed to load, check the aircraft is known", SPEECH_PRIORITY_HIGH);
+    return;
+  }
+
+  Enable();
+}
+
+// stops and disables the manager
+void LandingThrottleManager_Disarm
+  (
+  void
+  )
+{
+  Disable();
+}
+
+// called when an event is published, see Events.cpp
+void LandingThrottleManager_HandleEvent
+  (
+  const event_t *Event
+  )
+{
+  // don't leave the throttle command held or the reversers out
+  if ((Event->Type == EVENT_SESSION_RESET) || (Event->Type == EVENT_PLUGIN_DISABLED))
+  {
+    if (Ready) Reset();
+    PublishState();
+  }
   // a new aircraft has been loaded, check if we know it and if so access the data refs and commands we need
-  if (inMessage == XPLM_MSG_PLANE_LOADED)
+  else if (Event->Type == EVENT_PLANE_LOADED)
   {
     Ready = FALSE;
+    CurrentState = WAIT_FOR_USER;
+    FailedConditionsValid = FALSE;
+    Announced = FALSE;
 
+    double StartTime = Timing_GetTime();
     aircraft_id_t AircraftId = DetectAircraft();
+    Profile_Record(PROFILE_DETECT_AIRCRAFT, 0, Timing_GetTime() - StartTime);
 
     switch (AircraftId)
     {
+    // the reversers are handled per engine so all known aircraft use the same commands and datarefs
     case AIRCRAFT_XCRAFTS_ERJ_FAMILY:
+    case AIRCRAFT_LAMINAR_737:
     {
       // get commands
-      ReverseThrustCmd = XPLMFindCommand("sim/engines/thrust_reverse_hold");
-      if (ReverseThrustCmd == NULL)
-      {
-        return;
-      }
       ThrottleDownCmd = XPLMFindCommand("sim/engines/throttle_down");
       if (ThrottleDownCmd == NULL)
       {
@@ -493,11 +744,6 @@ void LandingThrottleManager_ReceiveMessage
       }
 
       // get datarefs
-      ThrottleRatioRef = XPLMFindDataRef("sim/cockpit2/engine/actuators/throttle_ratio_all");
-      if (ThrottleRatioRef == NULL)
-      {
-        return;
-      }
       IndicatedAirSpeedRef = XPLMFindDataRef("sim/flightmodel/position/indicated_airspeed2");
       if (IndicatedAirSpeedRef == NULL)
       {
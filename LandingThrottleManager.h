@@ -2,6 +2,14 @@
 #define _LANDINGTHROTTLEMANAGERH_
 
 #include "Global.h"
+#include "Events.h"
+
+// conditions that stop the manager being enabled, as bits
+#define CONDITION_AIRSPEED 0x01
+#define CONDITION_FLAPS    0x02
+#define CONDITION_GEAR     0x04
+#define CONDITION_ALTITUDE 0x08
+#define NUM_CONDITIONS     4
 
 // initalizes the module
 // returns TRUE for success, FALSE for error
@@ -10,12 +18,22 @@ extern int LandingThrottleManager_Init
   XPLMMenuID ParentMenuId
   );
 
-// called when a message is received from X-plane
-extern void LandingThrottleManager_ReceiveMessage
+// arms the manager if the landing conditions are met
+extern void LandingThrottleManager_Arm
+  (
+  void
+  );
+
+// stops and disables the manager
+extern void LandingThrottleManager_Disarm
+  (
+  void
+  );
+
+// called when an event is published, see Events.cpp
+extern void LandingThrottleManager_HandleEvent
   (
-  XPLMPluginID inFromWho,
-  int	inMessage,
-  void *inParam
+  const event_t *Event
   );
 
 #endif // _LANDINGTHROTTLEMANAGERH_
@@ -18,7 +18,26 @@
 
 #include "LandingThrottleManager.h"
 #include "ParkingBrake.h"
+#include "RolloutController.h"
+#include "ReverseThrust.h"
+#include "SharedData.h"
+#include "Speech.h"
+#include "Config.h"
+#include "Settings.h"
+#include "HeadCompositor.h"
 #include "HeadMotion.h"
+#include "GroundRoll.h"
+#include "GSeat.h"
+#include "EngineVibration.h"
+#include "Profile.h"
+#include "Timing.h"
+#include "Events.h"
+#include "Scheduler.h"
+#include "StatusWindow.h"
+#include "Scorecard.h"
+#include "Commands.h"
+#include "Session.h"
+#include "Clock.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -64,6 +83,65 @@ PLUGIN_API int XPluginStart
 		NULL,	  // The handler
 		0);						          // Handler Ref
 
+  // read by the scheduler every frame
+  if (!Clock_Init())
+  {
+    return FALSE;
+  }
+
+  // before the modules that add tasks
+  if (!Scheduler_Init())
+  {
+    return FALSE;
+  }
+
+  // first of the modules so the others start with the configured values
+  if (!Config_Init())
+  {
+    return FALSE;
+  }
+
+  // before the modules that have menu choices
+  if (!Settings_Init())
+  {
+    return FALSE;
+  }
+
+  if (!Events_Init())
+  {
+    return FALSE;
+  }
+
+  if (!Session_Init())
+  {
+    return FALSE;
+  }
+
+  if (!Commands_Init())
+  {
+    return FALSE;
+  }
+
+  if (!SharedData_Init())
+  {
+    return FALSE;
+  }
+
+  if (!Speech_Init())
+  {
+    return FALSE;
+  }
+
+  if (!HeadCompositor_Init())
+  {
+    return FALSE;
+  }
+
+  if (!ReverseThrust_Init())
+  {
+    return FALSE;
+  }
+
   if (!LandingThrottleManager_Init(myMenu))
   {
     return FALSE;
@@ -74,11 +152,46 @@ PLUGIN_API int XPluginStart
     return FALSE;
   }
 
+  if (!RolloutController_Init(myMenu))
+  {
+    return FALSE;
+  }
+
   if (!HeadMotion_Init(myMenu))
   {
     return FALSE;
   }
 
+  if (!GroundRoll_Init(myMenu))
+  {
+    return FALSE;
+  }
+
+  if (!GSeat_Init(myMenu))
+  {
+    return FALSE;
+  }
+
+  if (!EngineVibration_Init(myMenu))
+  {
+    return FALSE;
+  }
+
+  if (!StatusWindow_Init(myMenu))
+  {
+    return FALSE;
+  }
+
+  if (!Scorecard_Init(myMenu))
+  {
+    return FALSE;
+  }
+
+  if (!Profile_Init(myMenu))
+  {
+    return FALSE;
+  }
+
   return TRUE;
 }
 
@@ -87,6 +200,13 @@ PLUGIN_API void	XPluginStop
   void
   )
 {
+  Profile_WriteReport();
+  Commands_ReleaseAll();
+  Commands_UnregisterHandlers();
+  SharedData_Stop();
+  Settings_Stop();
+  Config_Stop();
+  Scheduler_Stop();
 }
 
 PLUGIN_API void XPluginDisable
@@ -94,6 +214,10 @@ PLUGIN_API void XPluginDisable
   void
   )
 {
+  // the modules stop what they are doing and give back the head and commands,
+  // then nothing runs until we are enabled again
+  Events_PublishType(EVENT_PLUGIN_DISABLED);
+  Scheduler_Suspend();
 }
 
 PLUGIN_API int XPluginEnable
@@ -101,6 +225,9 @@ PLUGIN_API int XPluginEnable
   void
   )
 {
+  // also called after XPluginStart, when nothing is suspended
+  Scheduler_Resume();
+  Events_PublishType(EVENT_PLUGIN_ENABLED);
   return 1;
 }
 
@@ -112,7 +239,10 @@ PLUGIN_API void XPluginReceiveMessage
   void *inParam
   )
 {
-  LandingThrottleManager_ReceiveMessage(inFromWho, inMessage, inParam);
-  ParkingBrake_ReceiveMessage(inFromWho, inMessage, inParam);
-  HeadMotion_ReceiveMessage(inFromWho, inMessage, inParam);
+  double StartTime = Timing_GetTime();
+
+  // the modules are sent the message as an event
+  Events_ReceiveMessage(inFromWho, inMessage, inParam);
+
+  Profile_Record(PROFILE_RECEIVE_MESSAGE, 0, Timing_GetTime() - StartTime);
 }
@@ -1,43 +1,161 @@
 // PARKING BRAKE
 
-// This plugin will release the parking brake
+// This plugin will release, set or pulse the parking brake
 // Needed for gliders that don't have a brake control in the cockpit
+// The brake is moved gradually to the new position over a short time so the
+// aircraft doesn't lurch. The ramp runs in a flight loop that is only
+// scheduled while the brake is moving
 
+#include <stdint.h>
 #include "ParkingBrake.h"
 #include "Diagnostic.h"
+#include "Speech.h"
+#include "Config.h"
+#include "Profile.h"
+#include "Scheduler.h"
+#include "Clock.h"
+#include "Commands.h"
 
 #define MODULE_NAME "Parking Brake"
 
+// the ramp and pulse times are in the configuration file, see Config.cpp
+
+// longest frame time used to move the brake, in seconds
+#define MAX_FRAME_TIME 0.1f
+
+// the ramp runs every frame while the brake is moving
+#define RAMP_EXECUTION_EVERY_FRAME -1.0f
+
 // menu item IDs
 #define MENU_ITEM_ID_RELEASE 1
+#define MENU_ITEM_ID_HOLD    2
+#define MENU_ITEM_ID_PULSE   3
+
+// brake actions, also used as the refcon of the custom commands
+typedef enum _brake_mode_t
+{
+  BRAKE_IDLE,
+  BRAKE_RELEASE,
+  BRAKE_HOLD,
+  BRAKE_PULSE
+} brake_mode_t;
 
 // commands and data references that we need
-static XPLMCommandRef BrakeMaxCmd = NULL;
+static XPLMDataRef ParkingBrakeRatioRef = NULL;
 
 // custom commands
 static XPLMCommandRef ReleaseCmd = NULL;
+static XPLMCommandRef HoldCmd    = NULL;
+static XPLMCommandRef PulseCmd   = NULL;
 
 // prototype for the function that handles menu choices
 static void	MenuHandlerCallback(void *inMenuRef, void *inItemRef);
 
+// current brake action
+static brake_mode_t Mode = BRAKE_IDLE;
+// where the brake is moving to
+static float TargetRatio;
+// time left at full brake during a pulse
+static float PulseHoldTimeLeft;
+static int RampTask = -1;
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // INTERNAL FUNCTIONS
 
+// moves the brake towards the target, called every frame by x-plane while the brake is moving
+// returns the time to the next execution, or 0 when the brake has reached the target
+static float RampBrake
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  if (Mode == BRAKE_IDLE) return 0;
+
+  float Ratio = XPLMGetDataf(ParkingBrakeRatioRef);
+  float FrameTime = Clock_GetFrameTime(CLOCK_SIM);
+  if (FrameTime > MAX_FRAME_TIME) FrameTime = MAX_FRAME_TIME;
+  float RampTime = Config_Get()->BrakeRampTime;
+  float Step = (RampTime > 0) ? FrameTime / RampTime : 1.0f;
+
+  if (Ratio < TargetRatio)
+  {
+    Ratio += Step;
+    if (Ratio > TargetRatio) Ratio = TargetRatio;
+  }
+  else if (Ratio > TargetRatio)
+  {
+    Ratio -= Step;
+    if (Ratio < TargetRatio) Ratio = TargetRatio;
+  }
+  XPLMSetDataf(ParkingBrakeRatioRef, Ratio);
+
+  if (Ratio != TargetRatio) return RAMP_EXECUTION_EVERY_FRAME;
+
+  // reached the target, a pulse holds the brake and then releases it
+  if ((Mode == BRAKE_PULSE) && (TargetRatio == 1.0f))
+  {
+    PulseHoldTimeLeft -= FrameTime;
+    if (PulseHoldTimeLeft > 0) return RAMP_EXECUTION_EVERY_FRAME;
+
+    TargetRatio = 0;
+    return RAMP_EXECUTION_EVERY_FRAME;
+  }
+
+#if DIAGNOSTIC == 1
+  Diagnostic_printf("Parking brake at %f\n", Ratio);
+#endif // DIAGNOSTIC
+  Mode = BRAKE_IDLE;
+  return 0;
+}
+
+// starts moving the brake
+static void StartBrake
+  (
+  brake_mode_t NewMode
+  )
+{
+  Mode = NewMode;
+
+  switch (Mode)
+  {
+    case BRAKE_RELEASE:
+      TargetRatio = 0;
+      Speech_Say("Brake released", SPEECH_PRIORITY_LOW);
+      break;
+
+    case BRAKE_HOLD:
+      TargetRatio = 1.0f;
+      Speech_Say("Brake set", SPEECH_PRIORITY_LOW);
+      break;
+
+    case BRAKE_PULSE:
+      TargetRatio = 1.0f;
+      PulseHoldTimeLeft = Config_Get()->BrakePulseHoldTime;
+      break;
+
+    default:
+      return;
+  }
+
+  // the first step is taken on the next frame
+  Scheduler_Schedule(RampTask, RAMP_EXECUTION_EVERY_FRAME);
+}
+
 // releases the parking brake
 static void ReleaseBrake
   (
   void
   )
 {
-  XPLMCommandBegin(BrakeMaxCmd);
-  XPLMCommandEnd(BrakeMaxCmd);
-
-  XPLMSpeakString("Brake released");
+  StartBrake(BRAKE_RELEASE);
 }
 
-// handles the release command
-static int ReleaseCmdHandler
+// handles the release, hold and pulse commands
+static int BrakeCmdHandler
 (
   XPLMCommandRef inCommand,
   XPLMCommandPhase inPhase,
@@ -47,13 +165,36 @@ static int ReleaseCmdHandler
   // If inPhase == 0 the command is executed once on button down.
   if (inPhase == 0)
   {
-    ReleaseBrake();
+    StartBrake((brake_mode_t)(intptr_t)inRefcon);
   }
 
   // disable further processing of this command
   return 0;
 }
 
+// creates one of our custom commands
+// returns the command
+static XPLMCommandRef CreateBrakeCommand
+  (
+  const char *Name,         // name of the command
+  const char *Description,  // what the command does
+  brake_mode_t CmdMode      // brake action of the command
+  )
+{
+  char CmdName[100];
+  sprintf_s(CmdName, 100, "%s//%s//%s", PLUGIN_NAME, MODULE_NAME, Name);
+  char CmdDesc[100];
+  sprintf_s(CmdDesc, 100, "%s (%s-%s)", Description, PLUGIN_NAME, MODULE_NAME);
+  XPLMCommandRef Cmd = XPLMCreateCommand(CmdName, CmdDesc);
+  Commands_RegisterHandler(
+    Cmd,                     // in Command name
+    BrakeCmdHandler,         // in Handler
+    1,                       // Receive input before plugin windows.
+    (void *)(intptr_t)CmdMode); // inRefcon.
+
+  return Cmd;
+}
+
 // called when the user chooses a menu item
 static void MenuHandlerCallback
 (
@@ -62,10 +203,20 @@ static void MenuHandlerCallback
 )
 {
   // user chose to release the parking brake
-  if ((int)inItemRef == MENU_ITEM_ID_RELEASE)
+  if ((intptr_t)inItemRef == MENU_ITEM_ID_RELEASE)
   {
     ReleaseBrake();
   }
+  // user chose to set the parking brake
+  else if ((intptr_t)inItemRef == MENU_ITEM_ID_HOLD)
+  {
+    StartBrake(BRAKE_HOLD);
+  }
+  // user chose to apply the parking brake briefly
+  else if ((intptr_t)inItemRef == MENU_ITEM_ID_PULSE)
+  {
+    StartBrake(BRAKE_PULSE);
+  }
 }
 
 
@@ -102,35 +253,54 @@ int ParkingBrake_Init
     "Release",
     (void *)MENU_ITEM_ID_RELEASE,
     1);
+  XPLMAppendMenuItem(
+    myMenu,
+    "Hold",
+    (void *)MENU_ITEM_ID_HOLD,
+    1);
+  XPLMAppendMenuItem(
+    myMenu,
+    "Pulse",
+    (void *)MENU_ITEM_ID_PULSE,
+    1);
 
-  // create custom command
-  char CmdName[100];
-  sprintf_s(CmdName, 100, "%s//%s//Release", PLUGIN_NAME, MODULE_NAME);
-  char CmdDesc[100];
-  sprintf_s(CmdDesc, 100, "Release the brake (%s-%s)", PLUGIN_NAME, MODULE_NAME);
-  ReleaseCmd = XPLMCreateCommand(CmdName, CmdDesc);
-  XPLMRegisterCommandHandler(
-    ReleaseCmd,         // in Command name
-    ReleaseCmdHandler,  // in Handler
-    1,                 // Receive input before plugin windows.
-    (void *)0);        // inRefcon.
-
-  // get commands
-  BrakeMaxCmd = XPLMFindCommand("sim/flight_controls/brakes_max");
-  if (BrakeMaxCmd == NULL)
+  // create custom commands
+  ReleaseCmd = CreateBrakeCommand("Release", "Release the brake", BRAKE_RELEASE);
+  HoldCmd = CreateBrakeCommand("Hold", "Set the brake", BRAKE_HOLD);
+  PulseCmd = CreateBrakeCommand("Pulse", "Apply the brake briefly", BRAKE_PULSE);
+
+  // get datarefs
+  ParkingBrakeRatioRef = XPLMFindDataRef("sim/cockpit2/controls/parking_brake_ratio");
+  if (ParkingBrakeRatioRef == NULL)
   {
     return FALSE;
   }
 
+  // the ramp is only scheduled while the brake is moving
+  RampTask = Scheduler_AddTask(RampBrake, PROFILE_PARKING_BRAKE, 0);
+
   return TRUE;
 }
 
-// called when a message is received from X-plane
-void ParkingBrake_ReceiveMessage
+// releases the parking brake
+void ParkingBrake_Release
   (
-  XPLMPluginID inFromWho,
-  int	inMessage,
-  void *inParam
+  void
+  )
+{
+  ReleaseBrake();
+}
+
+// called when an event is published, see Events.cpp
+void ParkingBrake_HandleEvent
+  (
+  const event_t *Event
   )
 {
+  // don't carry on moving the brake into a new flight, or while disabled
+  if ((Event->Type == EVENT_SESSION_RESET) || (Event->Type == EVENT_PLUGIN_DISABLED))
+  {
+    Mode = BRAKE_IDLE;
+    Scheduler_Schedule(RampTask, 0);
+  }
 }
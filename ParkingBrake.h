@@ -2,6 +2,7 @@
 #define _PARKINGBRAKEH_
 
 #include "Global.h"
+#include "Events.h"
 
 // initalizes the module
 // returns TRUE for success, FALSE for error
@@ -10,12 +11,16 @@ extern int ParkingBrake_Init
   XPLMMenuID ParentMenuId
   );
 
-// called when a message is received from X-plane
-extern void ParkingBrake_ReceiveMessage
+// releases the parking brake
+extern void ParkingBrake_Release
   (
-  XPLMPluginID inFromWho,
-  int	inMessage,
-  void *inParam
+  void
+  );
+
+// called when an event is published, see Events.cpp
+extern void ParkingBrake_HandleEvent
+  (
+  const event_t *Event
   );
 
 #endif // _PARKINGBRAKEH_
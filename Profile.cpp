@@ -0,0 +1,370 @@
+// PROFILE
+
+// Collects how long each part of the plugin takes to run, so the cost of a
+// release can be compared with the last one
+// Every timed section, and every state of the state machines, keeps a count,
+// the total, the fastest and slowest times and a histogram with one bucket
+// per power of two nanoseconds. Recording a time is a few additions, nothing
+// is allocated
+// The statistics are written as JSON to a file next to Log.txt when chosen
+// from the menu and when the plugin stops
+// The time of every section is also added up for each frame, so the report
+// shows how much of the frame budget of a 90 Hz headset the plugin uses and
+// which section and state caused the slowest frame
+// Set PROFILE to 0 in Global.h to remove the timing
+
+#include <math.h>
+#include "Profile.h"
+#include "Diagnostic.h"
+#include "SharedData.h"
+#include "Scheduler.h"
+
+#define MODULE_NAME "Profiling"
+
+// number of histogram buckets, the last one holds everything above 2^31 ns
+#define NUM_BUCKETS 32
+// time available to draw one frame on a 90 Hz headset, in ns
+#define FRAME_BUDGET_NS (1000000000.0 / 90.0)
+
+// menu item IDs
+#define MENU_ITEM_ID_WRITE_REPORT 1
+#define MENU_ITEM_ID_RESET        2
+
+// statistics of one section and state
+typedef struct _profile_stats_t
+{
+  unsigned long long Count;
+  double TotalNs;
+  double MinNs;
+  double MaxNs;
+  unsigned int Buckets[NUM_BUCKETS];
+} profile_stats_t;
+
+// describes a timed section
+typedef struct _profile_section_info_t
+{
+  const char *Name;
+  int PublishedTiming;  // the shared data timing it is published as, or -1
+  int InFrame;          // FALSE if it only runs inside another section, so isn't added to the frame twice
+} profile_section_info_t;
+
+// all of the sections, in the same order as profile_section_t
+static const profile_section_info_t Sections[NUM_PROFILE_SECTIONS] =
+{
+  {"landing_throttle_manager", TIMING_LANDING_THROTTLE_MANAGER, TRUE},
+  {"head_motion",              TIMING_HEAD_MOTION,              TRUE},
+  {"head_compositor",          TIMING_HEAD_COMPOSITOR,          TRUE},
+  {"ground_roll",              -1,                              TRUE},
+  {"gseat",                    -1,                              TRUE},
+  {"engine_vibration",         -1,                              TRUE},
+  {"rollout_controller",       -1,                              TRUE},
+  {"parking_brake",            -1,                              TRUE},
+  {"speech",                   -1,                              TRUE},
+  {"scorecard",                -1,                              TRUE},
+  {"commands",                 -1,                              TRUE},
+  {"receive_message",          -1,                              TRUE},
+  {"detect_aircraft",          -1,                              FALSE},
+  {"diagnostic_printf",        -1,                              FALSE},
+};
+
+#if PROFILE == 1
+static profile_stats_t Stats[NUM_PROFILE_SECTIONS][PROFILE_MAX_STATES];
+
+// total plugin time of each frame
+static profile_stats_t FrameStats;
+static unsigned long long FramesOverBudget;
+
+// the frame that is being added up
+static double FrameNs;
+static double FrameLargestNs;
+static profile_section_t FrameLargestSection;
+static int FrameLargestState;
+
+// the slowest frame and the section and state that took the most time in it
+static double WorstFrameLargestNs;
+static profile_section_t WorstFrameSection;
+static int WorstFrameState;
+#endif // PROFILE
+
+// prototype for the function that handles menu choices
+static void	MenuHandlerCallback(void *inMenuRef, void *inItemRef);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+#if PROFILE == 1
+// gets the histogram bucket for a time
+static int GetBucket
+  (
+  double Ns
+  )
+{
+  if (Ns < 1.0) return 0;
+
+  int Exponent;
+  frexp(Ns, &Exponent);
+  if (Exponent > NUM_BUCKETS) return NUM_BUCKETS - 1;
+  return Exponent - 1;
+}
+
+// estimates a percentile from the histogram
+// returns the upper limit of the bucket that holds the percentile, in ns
+static double GetPercentile
+  (
+  const profile_stats_t *Stat,
+  double Percentile  // 0 to 1
+  )
+{
+  unsigned long long Target = (unsigned long long)ceil(Percentile * Stat->Count);
+  unsigned long long Total = 0;
+
+  for (int b = 0; b < NUM_BUCKETS; b++)
+  {
+    Total += Stat->Buckets[b];
+    if (Total >= Target)
+    {
+      double Limit = ldexp(1.0, b + 1);
+      return Limit < Stat->MaxNs ? Limit : Stat->MaxNs;
+    }
+  }
+
+  return Stat->MaxNs;
+}
+
+// adds a time to some statistics
+static void AddTime
+  (
+  profile_stats_t *Stat,
+  double Ns
+  )
+{
+  if ((Stat->Count == 0) || (Ns < Stat->MinNs)) Stat->MinNs = Ns;
+  if (Ns > Stat->MaxNs) Stat->MaxNs = Ns;
+  Stat->Count++;
+  Stat->TotalNs += Ns;
+  Stat->Buckets[GetBucket(Ns)]++;
+}
+
+// writes some statistics as the members of a JSON object
+static void WriteStats
+  (
+  FILE *File,
+  const profile_stats_t *Stat
+  )
+{
+  fprintf(File, "\"count\": %llu, \"mean_ns\": %.0f, \"min_ns\": %.0f, \"p50_ns\": %.0f, \"p99_ns\": %.0f, \"max_ns\": %.0f",
+    Stat->Count, Stat->TotalNs / Stat->Count, Stat->MinNs, GetPercentile(Stat, 0.5), GetPercentile(Stat, 0.99), Stat->MaxNs);
+}
+
+// called once per frame to add up the plugin time of the frame that has finished
+static float EndFrame
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  if ((FrameStats.Count == 0) || (FrameNs > FrameStats.MaxNs))
+  {
+    WorstFrameLargestNs = FrameLargestNs;
+    WorstFrameSection = FrameLargestSection;
+    WorstFrameState = FrameLargestState;
+  }
+  if (FrameNs > FRAME_BUDGET_NS) FramesOverBudget++;
+  AddTime(&FrameStats, FrameNs);
+
+  FrameNs = 0;
+  FrameLargestNs = 0;
+
+  // every frame
+  return -1.0;
+}
+#endif // PROFILE
+
+// clears all of the statistics
+static void Reset
+  (
+  void
+  )
+{
+#if PROFILE == 1
+  memset(Stats, 0, sizeof(Stats));
+  memset(&FrameStats, 0, sizeof(FrameStats));
+  FramesOverBudget = 0;
+  FrameNs = 0;
+  FrameLargestNs = 0;
+  WorstFrameLargestNs = 0;
+#endif // PROFILE
+}
+
+// called when the user chooses a menu item
+static void MenuHandlerCallback
+(
+  void *inMenuRef,
+  void *inItemRef
+)
+{
+  // user chose to write the report
+  if ((intptr_t)inItemRef == MENU_ITEM_ID_WRITE_REPORT)
+  {
+    Profile_WriteReport();
+  }
+  // user chose to start again
+  else if ((intptr_t)inItemRef == MENU_ITEM_ID_RESET)
+  {
+    Reset();
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int Profile_Init
+  (
+  XPLMMenuID ParentMenuId
+  )
+{
+  Reset();
+
+#if PROFILE == 1
+  int mySubMenuItem = XPLMAppendMenuItem(
+    ParentMenuId,
+    MODULE_NAME,
+    0,
+    1);
+
+  XPLMMenuID myMenu = XPLMCreateMenu(
+    MODULE_NAME,
+    ParentMenuId,
+    mySubMenuItem,
+    MenuHandlerCallback,
+    0
+  );
+
+  // Append menu items to our submenu
+  XPLMAppendMenuItem(
+    myMenu,
+    "Write report",
+    (void *)MENU_ITEM_ID_WRITE_REPORT,
+    1);
+  XPLMAppendMenuItem(
+    myMenu,
+    "Reset",
+    (void *)MENU_ITEM_ID_RESET,
+    1);
+
+  // added last so it runs after the other tasks of the frame
+  Scheduler_AddTask(EndFrame, SCHEDULER_NOT_PROFILED, -1.0f);
+#endif // PROFILE
+
+  return TRUE;
+}
+
+// records how long some code took to execute
+void Profile_Record
+  (
+  profile_section_t Section,
+  int State,       // state machine state that was executed, 0 if there isn't one
+  double Seconds
+  )
+{
+  if (Sections[Section].PublishedTiming >= 0)
+  {
+    SharedData_RecordTiming((shared_timing_t)Sections[Section].PublishedTiming, Seconds);
+  }
+
+#if PROFILE == 1
+  if ((State < 0) || (State >= PROFILE_MAX_STATES)) State = PROFILE_MAX_STATES - 1;
+
+  double Ns = Seconds * 1000000000.0;
+  AddTime(&Stats[Section][State], Ns);
+
+  if (Sections[Section].InFrame)
+  {
+    FrameNs += Ns;
+    if (Ns > FrameLargestNs)
+    {
+      FrameLargestNs = Ns;
+      FrameLargestSection = Section;
+      FrameLargestState = State;
+    }
+  }
+#endif // PROFILE
+}
+
+// gets the statistics of a section and state
+// returns the number of times it was recorded
+unsigned long long Profile_GetStats
+  (
+  profile_section_t Section,
+  int State,       // state machine state, 0 if there isn't one
+  double *MeanNs   // filled with the mean time in ns, or 0 if it wasn't recorded
+  )
+{
+  *MeanNs = 0;
+
+#if PROFILE == 1
+  if ((State < 0) || (State >= PROFILE_MAX_STATES)) State = PROFILE_MAX_STATES - 1;
+
+  const profile_stats_t *Stat = &Stats[Section][State];
+  if (Stat->Count > 0) *MeanNs = Stat->TotalNs / Stat->Count;
+  return Stat->Count;
+#else
+  return 0;
+#endif // PROFILE
+}
+
+// writes the statistics to the profile report
+// returns TRUE for success, FALSE for error
+int Profile_WriteReport
+  (
+  void
+  )
+{
+#if PROFILE == 1
+  char Path[512];
+  XPLMGetSystemPath(Path);
+  strcat_s(Path, 512, PROFILE_REPORT_FILE_NAME);
+
+  FILE *File;
+  if (fopen_s(&File, Path, "w") != 0) return FALSE;
+
+  fprintf(File, "{\n  \"plugin\": \"%s\",\n  \"version\": \"%d.%d.%d\",\n  \"sections\": [", PLUGIN_NAME, PLUGIN_VERSION_MAJOR, PLUGIN_VERSION_MINOR, PLUGIN_VERSION_DOT);
+
+  bool First = TRUE;
+  for (int s = 0; s < NUM_PROFILE_SECTIONS; s++)
+  {
+    for (int State = 0; State < PROFILE_MAX_STATES; State++)
+    {
+      const profile_stats_t *Stat = &Stats[s][State];
+      if (Stat->Count == 0) continue;
+
+      fprintf(File, "%s\n    {\"name\": \"%s\", \"state\": %d, ", First ? "" : ",", Sections[s].Name, State);
+      WriteStats(File, Stat);
+      fprintf(File, "}");
+      First = FALSE;
+    }
+  }
+
+  fprintf(File, "\n  ],\n  \"frames\": {\"budget_ns\": %.0f, \"over_budget\": %llu", FRAME_BUDGET_NS, FramesOverBudget);
+  if (FrameStats.Count > 0)
+  {
+    fprintf(File, ", ");
+    WriteStats(File, &FrameStats);
+    fprintf(File, ",\n    \"worst\": {\"ns\": %.0f, \"section\": \"%s\", \"state\": %d, \"section_ns\": %.0f}",
+      FrameStats.MaxNs, WorstFrameLargestNs > 0 ? Sections[WorstFrameSection].Name : "none", WorstFrameState, WorstFrameLargestNs);
+  }
+  fprintf(File, "}\n}\n");
+  fclose(File);
+
+#if DIAGNOSTIC == 1
+  Diagnostic_printf("Profile report written to %s\n", Path);
+#endif // DIAGNOSTIC
+#endif // PROFILE
+
+  return TRUE;
+}
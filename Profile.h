@@ -0,0 +1,62 @@
+#ifndef _PROFILEH_
+#define _PROFILEH_
+
+#include "Global.h"
+
+// name of the profile report, in the x-plane folder next to Log.txt
+#define PROFILE_REPORT_FILE_NAME "XVRTools_profile.json"
+// maximum number of state machine states that are timed separately
+#define PROFILE_MAX_STATES 8
+
+// code that is timed
+typedef enum _profile_section_t
+{
+  PROFILE_LANDING_THROTTLE_MANAGER,
+  PROFILE_HEAD_MOTION,
+  PROFILE_HEAD_COMPOSITOR,
+  PROFILE_GROUND_ROLL,
+  PROFILE_GSEAT,
+  PROFILE_ENGINE_VIBRATION,
+  PROFILE_ROLLOUT_CONTROLLER,
+  PROFILE_PARKING_BRAKE,
+  PROFILE_SPEECH,
+  PROFILE_SCORECARD,
+  PROFILE_COMMANDS,
+  PROFILE_RECEIVE_MESSAGE,
+  PROFILE_DETECT_AIRCRAFT,
+  PROFILE_DIAGNOSTIC,
+  NUM_PROFILE_SECTIONS
+} profile_section_t;
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int Profile_Init
+  (
+  XPLMMenuID ParentMenuId
+  );
+
+// records how long some code took to execute
+extern void Profile_Record
+  (
+  profile_section_t Section,
+  int State,       // state machine state that was executed, 0 if there isn't one
+  double Seconds
+  );
+
+// gets the statistics of a section and state
+// returns the number of times it was recorded
+extern unsigned long long Profile_GetStats
+  (
+  profile_section_t Section,
+  int State,       // state machine state, 0 if there isn't one
+  double *MeanNs   // filled with the mean time in ns, or 0 if it wasn't recorded
+  );
+
+// writes the statistics to the profile report
+// returns TRUE for success, FALSE for error
+extern int Profile_WriteReport
+  (
+  void
+  );
+
+#endif // _PROFILEH_
@@ -0,0 +1,260 @@
+// REVERSE THRUST
+
+// Manages the thrust reversers of each engine separately so aircraft with
+// more than one engine, and aircraft with a failed engine, can be handled
+// The throttle, reverser and N1 arrays are read with one call each and the
+// checks are done for all engines at once, giving a bit mask of the engines
+// that are running, at idle and have their reversers out
+// Reverse thrust is only used on an engine when the engine on the opposite
+// side is also running, so an engine failure never gives asymmetric reverse
+// thrust. If an engine fails while reversing, it and the engine opposite it
+// are stowed
+
+#include "ReverseThrust.h"
+#include "Diagnostic.h"
+
+// configuration section
+// N1 in percent below which an engine is treated as failed
+#define MIN_RUNNING_N1 15.0f
+// throttle ratio at or below which an engine is at idle, hardware throttles
+// and some aircraft never quite reach zero
+#define IDLE_THROTTLE_RATIO 0.01f
+// deploy ratio at which a reverser is out far enough to apply reverse thrust
+#define REVERSER_DEPLOYED_RATIO 0.9f
+
+// values of the prop mode dataref
+#define PROP_MODE_NORMAL  1
+#define PROP_MODE_REVERSE 3
+
+// data references that we need
+static XPLMDataRef NumEnginesRef    = NULL;
+static XPLMDataRef ThrottleRatioRef = NULL;
+static XPLMDataRef PropModeRef      = NULL;
+static XPLMDataRef DeployRatioRef   = NULL;
+static XPLMDataRef N1Ref            = NULL;
+static XPLMDataRef EngineRunningRef = NULL;
+
+// state of all engines, read by ReverseThrust_Update
+static int NumEngines;
+static float Throttle[REVERSE_THRUST_MAX_ENGINES];
+static float DeployRatio[REVERSE_THRUST_MAX_ENGINES];
+static float N1[REVERSE_THRUST_MAX_ENGINES];
+static int EngineRunning[REVERSE_THRUST_MAX_ENGINES];
+static int PropMode[REVERSE_THRUST_MAX_ENGINES];
+
+// engine masks, bit 0 is engine 1
+static int RunningMask;
+static int IdleMask;
+static int ExtendedMask;
+// running engines that have a running engine on the opposite side
+static int UsableMask;
+// engines we have put into reverse
+static int DeployedMask;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// returns the mask of all of the engines on the aircraft
+static int AllEnginesMask
+  (
+  void
+  )
+{
+  return (1 << NumEngines) - 1;
+}
+
+// returns the throttles of some engines to idle and stows their reversers
+static void StowEngines
+  (
+  int Engines  // mask of the engines to stow
+  )
+{
+  if (Engines == 0) return;
+
+  for (int e = 0; e < NumEngines; e++)
+  {
+    if ((Engines >> e) & 1)
+    {
+      Throttle[e] = 0;
+      PropMode[e] = PROP_MODE_NORMAL;
+    }
+  }
+  XPLMSetDatavf(ThrottleRatioRef, Throttle, 0, NumEngines);
+  XPLMSetDatavi(PropModeRef, PropMode, 0, NumEngines);
+
+  DeployedMask &= ~Engines;
+
+#if DIAGNOSTIC == 1
+  Diagnostic_printf("Stowed reversers 0x%02X, still deployed 0x%02X\n", Engines, DeployedMask);
+#endif // DIAGNOSTIC
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int ReverseThrust_Init
+  (
+  void
+  )
+{
+  NumEngines = 0;
+  RunningMask = 0;
+  IdleMask = 0;
+  ExtendedMask = 0;
+  UsableMask = 0;
+  DeployedMask = 0;
+
+  // get datarefs
+  NumEnginesRef = XPLMFindDataRef("sim/aircraft/engine/acf_num_engines");
+  if (NumEnginesRef == NULL)
+  {
+    return FALSE;
+  }
+  ThrottleRatioRef = XPLMFindDataRef("sim/cockpit2/engine/actuators/throttle_ratio");
+  if (ThrottleRatioRef == NULL)
+  {
+    return FALSE;
+  }
+  PropModeRef = XPLMFindDataRef("sim/cockpit2/engine/actuators/prop_mode");
+  if (PropModeRef == NULL)
+  {
+    return FALSE;
+  }
+  DeployRatioRef = XPLMFindDataRef("sim/flightmodel2/engines/thrust_reverser_deploy_ratio");
+  if (DeployRatioRef == NULL)
+  {
+    return FALSE;
+  }
+  N1Ref = XPLMFindDataRef("sim/cockpit2/engine/indicators/N1_percent");
+  if (N1Ref == NULL)
+  {
+    return FALSE;
+  }
+  EngineRunningRef = XPLMFindDataRef("sim/flightmodel/engine/ENGN_running");
+  if (EngineRunningRef == NULL)
+  {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+// reads the state of all engines and stows the reversers of any engine that
+// can no longer be used symmetrically, call before the other functions
+void ReverseThrust_Update
+  (
+  void
+  )
+{
+  NumEngines = XPLMGetDatai(NumEnginesRef);
+  if (NumEngines < 0) NumEngines = 0;
+  if (NumEngines > REVERSE_THRUST_MAX_ENGINES) NumEngines = REVERSE_THRUST_MAX_ENGINES;
+
+  XPLMGetDatavf(ThrottleRatioRef, Throttle, 0, NumEngines);
+  XPLMGetDatavf(DeployRatioRef, DeployRatio, 0, NumEngines);
+  XPLMGetDatavf(N1Ref, N1, 0, NumEngines);
+  XPLMGetDatavi(EngineRunningRef, EngineRunning, 0, NumEngines);
+  XPLMGetDatavi(PropModeRef, PropMode, 0, NumEngines);
+
+  // compare all engines at once, the loop has no branches so it can be vectorized
+  // and the engines that are not fitted are masked off afterwards
+  int Running = 0;
+  int Idle = 0;
+  int Extended = 0;
+  for (int e = 0; e < REVERSE_THRUST_MAX_ENGINES; e++)
+  {
+    Running  |= ((EngineRunning[e] != 0) & (N1[e] >= MIN_RUNNING_N1)) << e;
+    Idle     |= (Throttle[e] <= IDLE_THROTTLE_RATIO) << e;
+    Extended |= (DeployRatio[e] >= REVERSER_DEPLOYED_RATIO) << e;
+  }
+  RunningMask = Running & AllEnginesMask();
+  IdleMask = Idle & AllEnginesMask();
+  ExtendedMask = Extended & AllEnginesMask();
+
+  // engines are numbered from left to right, so the opposite of engine e is
+  // engine NumEngines - 1 - e, a center engine is opposite itself
+  int Mirrored = 0;
+  for (int e = 0; e < NumEngines; e++)
+  {
+    Mirrored |= ((RunningMask >> (NumEngines - 1 - e)) & 1) << e;
+  }
+  UsableMask = RunningMask & Mirrored;
+
+  // an engine has failed while reversing, stow it and the engine opposite it
+  StowEngines(DeployedMask & ~UsableMask);
+}
+
+// returns TRUE if the throttles of all running engines are at idle
+int ReverseThrust_IsIdle
+  (
+  void
+  )
+{
+  return (RunningMask & ~IdleMask) == 0;
+}
+
+// deploys the reversers of every running engine that has a running engine
+// on the opposite side
+// returns TRUE if at least one reverser was deployed
+int ReverseThrust_Deploy
+  (
+  void
+  )
+{
+  int Engines = UsableMask & ~DeployedMask;
+
+  if (Engines != 0)
+  {
+    for (int e = 0; e < NumEngines; e++)
+    {
+      if ((Engines >> e) & 1) PropMode[e] = PROP_MODE_REVERSE;
+    }
+    XPLMSetDatavi(PropModeRef, PropMode, 0, NumEngines);
+
+    DeployedMask |= Engines;
+
+#if DIAGNOSTIC == 1
+    Diagnostic_printf("Deployed reversers 0x%02X of %d engines, running 0x%02X\n", DeployedMask, NumEngines, RunningMask);
+#endif // DIAGNOSTIC
+  }
+
+  return DeployedMask != 0;
+}
+
+// sets the amount of reverse thrust on the engines with deployed reversers
+void ReverseThrust_SetRatio
+  (
+  float Ratio  // 0 = idle reverse to 1 = maximum reverse
+  )
+{
+  if (DeployedMask == 0) return;
+
+  // engines stay at idle until their reversers are out
+  int Engines = DeployedMask & ExtendedMask;
+  for (int e = 0; e < NumEngines; e++)
+  {
+    if ((DeployedMask >> e) & 1) Throttle[e] = ((Engines >> e) & 1) ? Ratio : 0;
+  }
+  XPLMSetDatavf(ThrottleRatioRef, Throttle, 0, NumEngines);
+}
+
+// returns TRUE if any reverser is deployed by us
+int ReverseThrust_IsDeployed
+  (
+  void
+  )
+{
+  return DeployedMask != 0;
+}
+
+// returns the throttles to idle and stows all of the reversers we deployed
+void ReverseThrust_Stow
+  (
+  void
+  )
+{
+  StowEngines(DeployedMask);
+}
@@ -0,0 +1,55 @@
+#ifndef _REVERSETHRUSTH_
+#define _REVERSETHRUSTH_
+
+#include "Global.h"
+
+// maximum number of engines that are managed
+#define REVERSE_THRUST_MAX_ENGINES 8
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int ReverseThrust_Init
+  (
+  void
+  );
+
+// reads the state of all engines and stows the reversers of any engine that
+// can no longer be used symmetrically, call before the other functions
+extern void ReverseThrust_Update
+  (
+  void
+  );
+
+// returns TRUE if the throttles of all running engines are at idle
+extern int ReverseThrust_IsIdle
+  (
+  void
+  );
+
+// deploys the reversers of every running engine that has a running engine
+// on the opposite side
+// returns TRUE if at least one reverser was deployed
+extern int ReverseThrust_Deploy
+  (
+  void
+  );
+
+// sets the amount of reverse thrust on the engines with deployed reversers
+extern void ReverseThrust_SetRatio
+  (
+  float Ratio  // 0 = idle reverse to 1 = maximum reverse
+  );
+
+// returns TRUE if any reverser is deployed by us
+extern int ReverseThrust_IsDeployed
+  (
+  void
+  );
+
+// returns the throttles to idle and stows all of the reversers we deployed
+extern void ReverseThrust_Stow
+  (
+  void
+  );
+
+#endif // _REVERSETHRUSTH_
@@ -0,0 +1,405 @@
+// ROLLOUT CONTROLLER
+
+// Controls the deceleration of the aircraft after touch down, like an autobrake
+// The deceleration is measured every frame from the ground speed and a PI
+// controller works out how much stopping effort is needed to reach the
+// deceleration chosen in the menu. Reverse thrust is used first, to save the
+// brakes, and the wheel brakes are added when reverse thrust is not enough
+// or the aircraft is too slow for reverse thrust
+// Reverse thrust is only used on engines that have a running engine on the
+// opposite side, if there are none the wheel brakes do all of the work
+// The controller is started by the landing throttle manager once all wheels
+// are on the ground and stops when the aircraft has slowed to taxi speed
+
+#include "RolloutController.h"
+#include "Diagnostic.h"
+#include "ReverseThrust.h"
+#include "Config.h"
+#include "Settings.h"
+#include "Profile.h"
+#include "Scheduler.h"
+#include "Clock.h"
+
+#define MODULE_NAME "Autobrake"
+
+// the controller runs every frame while active
+#define CONTROLLER_EXECUTION_EVERY_FRAME -1.0f
+
+// configuration section
+// the target decelerations and the rollout end speed are in the configuration
+// file, see Config.cpp
+// controller gains, effort per m/s^2 of error and effort per m/s^2 per second
+#define PROPORTIONAL_GAIN 0.25f
+#define INTEGRAL_GAIN     0.5f
+// time constant in seconds of the filter on the measured deceleration
+#define DECELERATION_FILTER_TIME 0.2f
+// longest frame time used by the controller, in seconds
+#define MAX_FRAME_TIME 0.1f
+// stopping effort ranges from 0 to 2, the first unit is reverse thrust and
+// the second is the wheel brakes
+#define MAX_EFFORT 2.0f
+
+// menu item IDs
+#define MENU_ITEM_ID_OFF    1
+#define MENU_ITEM_ID_LOW    2
+#define MENU_ITEM_ID_MEDIUM 3
+#define MENU_ITEM_ID_HIGH   4
+
+// autobrake settings
+typedef enum _autobrake_t
+{
+  AUTOBRAKE_OFF,
+  AUTOBRAKE_LOW,
+  AUTOBRAKE_MEDIUM,
+  AUTOBRAKE_HIGH,
+  NUM_AUTOBRAKE_SETTINGS
+} autobrake_t;
+
+// commands and data references that we need
+static XPLMDataRef GroundSpeedRef       = NULL;
+static XPLMDataRef IndicatedAirSpeedRef = NULL;
+static XPLMDataRef LeftBrakeRatioRef    = NULL;
+static XPLMDataRef RightBrakeRatioRef   = NULL;
+
+// prototype for the function that handles menu choices
+static void	MenuHandlerCallback(void *inMenuRef, void *inItemRef);
+
+static autobrake_t Autobrake;
+static XPLMMenuID myMenu;
+static int MenuItems[NUM_AUTOBRAKE_SETTINGS];
+static int ControllerTask = -1;
+
+// controller state
+static bool Active;
+static bool HaveMeasurement;
+static bool ReverseDeployed;
+static float PreviousGroundSpeed;
+static float Deceleration;
+static float Integral;
+static float MinReverseSpeed;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// limits a value to a range
+static float Limit
+  (
+  float Value,
+  float Min,
+  float Max
+  )
+{
+  if (Value < Min) return Min;
+  if (Value > Max) return Max;
+  return Value;
+}
+
+// gets the deceleration in m/s^2 for the autobrake setting
+static float TargetDeceleration
+  (
+  const config_t *Config
+  )
+{
+  switch (Autobrake)
+  {
+    case AUTOBRAKE_LOW:    return Config->AutobrakeLow;
+    case AUTOBRAKE_MEDIUM: return Config->AutobrakeMedium;
+    case AUTOBRAKE_HIGH:   return Config->AutobrakeHigh;
+    default:               return 0;
+  }
+}
+
+// sets both wheel brakes
+static void SetBrakes
+  (
+  float Ratio  // 0 = off to 1 = maximum
+  )
+{
+  XPLMSetDataf(LeftBrakeRatioRef, Ratio);
+  XPLMSetDataf(RightBrakeRatioRef, Ratio);
+}
+
+// stows the reversers if they are deployed
+static void StowReversers
+  (
+  void
+  )
+{
+  if (ReverseDeployed == FALSE) return;
+
+  ReverseThrust_Stow();
+  ReverseDeployed = FALSE;
+}
+
+// updates the menu check marks to show the autobrake setting
+static void UpdateMenu
+  (
+  void
+  )
+{
+  for (int a = 0; a < NUM_AUTOBRAKE_SETTINGS; a++)
+  {
+    XPLMCheckMenuItem(myMenu, MenuItems[a], a == Autobrake ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+  }
+}
+
+// runs the controller, called every frame by x-plane while active
+// returns the time to the next execution, or 0 when the rollout is complete
+static float Controller
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  if (Active == FALSE) return 0;
+
+  const config_t *Config = Config_Get();
+  float GroundSpeed = XPLMGetDataf(GroundSpeedRef);
+
+  // slowed to taxi speed, hand back to the pilot
+  if (GroundSpeed < Config->RolloutEndSpeed)
+  {
+#if DIAGNOSTIC == 1
+    Diagnostic_printf("Rollout complete at %f m/s\n", GroundSpeed);
+#endif // DIAGNOSTIC
+    RolloutController_Stop();
+
+    event_t Rollout;
+    Rollout.Type = EVENT_ROLLOUT_COMPLETE;
+    Rollout.Rollout.GroundSpeedMS = GroundSpeed;
+    Events_Publish(&Rollout);
+    return 0;
+  }
+
+  // need two ground speeds to measure the deceleration
+  if (HaveMeasurement == FALSE)
+  {
+    PreviousGroundSpeed = GroundSpeed;
+    HaveMeasurement = TRUE;
+    return CONTROLLER_EXECUTION_EVERY_FRAME;
+  }
+
+  // nothing changes while the sim is paused
+  float FrameTime = Clock_GetFrameTime(CLOCK_SIM);
+  if (FrameTime <= 0) return CONTROLLER_EXECUTION_EVERY_FRAME;
+  if (FrameTime > MAX_FRAME_TIME) FrameTime = MAX_FRAME_TIME;
+
+  // measure the deceleration, filtered as the ground speed is noisy over one frame
+  float Measured = (PreviousGroundSpeed - GroundSpeed) / FrameTime;
+  PreviousGroundSpeed = GroundSpeed;
+  Deceleration += (FrameTime / (DECELERATION_FILTER_TIME + FrameTime)) * (Measured - Deceleration);
+
+  // an engine failure stows the reversers of that engine and the one opposite it
+  ReverseThrust_Update();
+  if (ReverseDeployed && (ReverseThrust_IsDeployed() == FALSE)) ReverseDeployed = FALSE;
+
+  // PI controller
+  float Error = TargetDeceleration(Config) - Deceleration;
+
+  bool ReverseAllowed = XPLMGetDataf(IndicatedAirSpeedRef) > MinReverseSpeed;
+  if ((ReverseAllowed == FALSE) && ReverseDeployed)
+  {
+    // reverse thrust is going away, move the effort over to the brakes without a jump
+    // the brakes take the reverse share on top of what they already had, as far as
+    // they can, and without reverse thrust the brakes start at an effort of 1
+    StowReversers();
+    float OldEffort = PROPORTIONAL_GAIN * Error + Integral;
+    float Share = Limit(OldEffort, 0, 1.0f) + Limit(OldEffort - 1.0f, 0, 1.0f);
+    Integral += 1.0f + Limit(Share, 0, 1.0f) - OldEffort;
+  }
+
+  float MinEffort = ReverseAllowed ? 0.0f : 1.0f;
+  float Effort = PROPORTIONAL_GAIN * Error + Integral;
+
+  // only integrate when it will not wind up against the limits
+  if (((Effort < MAX_EFFORT) || (Error < 0)) && ((Effort > MinEffort) || (Error > 0)))
+  {
+    Integral += INTEGRAL_GAIN * Error * FrameTime;
+  }
+  Integral = Limit(Integral, -1.0f, MAX_EFFORT);
+  Effort = Limit(PROPORTIONAL_GAIN * Error + Integral, 0, MAX_EFFORT);
+
+  // reverse thrust first, then the wheel brakes
+  float Reverse = 0;
+  float Brakes;
+  if (ReverseAllowed)
+  {
+    Reverse = Limit(Effort, 0, 1.0f);
+    Brakes = Limit(Effort - 1.0f, 0, 1.0f);
+  }
+  else
+  {
+    Brakes = Limit(Effort - 1.0f, 0, 1.0f);
+  }
+
+  if (Reverse > 0)
+  {
+    if (ReverseDeployed == FALSE)
+    {
+      ReverseDeployed = ReverseThrust_Deploy();
+    }
+    ReverseThrust_SetRatio(Reverse);
+  }
+  else if (ReverseDeployed)
+  {
+    ReverseThrust_SetRatio(0);
+  }
+  SetBrakes(Brakes);
+
+  return CONTROLLER_EXECUTION_EVERY_FRAME;
+}
+
+// called when the user chooses a menu item
+static void MenuHandlerCallback
+(
+  void *inMenuRef,
+  void *inItemRef
+)
+{
+  switch ((intptr_t)inItemRef)
+  {
+    case MENU_ITEM_ID_OFF:    Autobrake = AUTOBRAKE_OFF;    break;
+    case MENU_ITEM_ID_LOW:    Autobrake = AUTOBRAKE_LOW;    break;
+    case MENU_ITEM_ID_MEDIUM: Autobrake = AUTOBRAKE_MEDIUM; break;
+    case MENU_ITEM_ID_HIGH:   Autobrake = AUTOBRAKE_HIGH;   break;
+  }
+
+  // turning the autobrake off during the rollout hands back to the pilot
+  if ((Autobrake == AUTOBRAKE_OFF) && Active) RolloutController_Stop();
+
+  Settings_Get()->Autobrake = Autobrake;
+  Settings_Changed();
+  UpdateMenu();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int RolloutController_Init
+  (
+  XPLMMenuID ParentMenuId
+  )
+{
+  Autobrake = (autobrake_t)Settings_Get()->Autobrake;
+  if ((Autobrake < AUTOBRAKE_OFF) || (Autobrake >= NUM_AUTOBRAKE_SETTINGS)) Autobrake = AUTOBRAKE_OFF;
+  Active = FALSE;
+  ReverseDeployed = FALSE;
+
+  int mySubMenuItem = XPLMAppendMenuItem(
+    ParentMenuId,
+    MODULE_NAME,
+    0,
+    1);
+
+  myMenu = XPLMCreateMenu(
+    MODULE_NAME,
+    ParentMenuId,
+    mySubMenuItem,
+    MenuHandlerCallback,
+    0
+  );
+
+  // Append menu items to our submenu
+  MenuItems[AUTOBRAKE_OFF]    = XPLMAppendMenuItem(myMenu, "Off", (void *)MENU_ITEM_ID_OFF, 1);
+  MenuItems[AUTOBRAKE_LOW]    = XPLMAppendMenuItem(myMenu, "Low", (void *)MENU_ITEM_ID_LOW, 1);
+  MenuItems[AUTOBRAKE_MEDIUM] = XPLMAppendMenuItem(myMenu, "Medium", (void *)MENU_ITEM_ID_MEDIUM, 1);
+  MenuItems[AUTOBRAKE_HIGH]   = XPLMAppendMenuItem(myMenu, "High", (void *)MENU_ITEM_ID_HIGH, 1);
+  UpdateMenu();
+
+  // get datarefs
+  GroundSpeedRef = XPLMFindDataRef("sim/flightmodel/position/groundspeed");
+  if (GroundSpeedRef == NULL)
+  {
+    return FALSE;
+  }
+  IndicatedAirSpeedRef = XPLMFindDataRef("sim/flightmodel/position/indicated_airspeed2");
+  if (IndicatedAirSpeedRef == NULL)
+  {
+    return FALSE;
+  }
+  LeftBrakeRatioRef = XPLMFindDataRef("sim/cockpit2/controls/left_brake_ratio");
+  if (LeftBrakeRatioRef == NULL)
+  {
+    return FALSE;
+  }
+  RightBrakeRatioRef = XPLMFindDataRef("sim/cockpit2/controls/right_brake_ratio");
+  if (RightBrakeRatioRef == NULL)
+  {
+    return FALSE;
+  }
+
+  // the controller only runs during the rollout
+  ControllerTask = Scheduler_AddTask(Controller, PROFILE_ROLLOUT_CONTROLLER, 0);
+
+  return TRUE;
+}
+
+// starts controlling the deceleration after touch down
+// returns TRUE if started, FALSE if the autobrake is off
+int RolloutController_Start
+  (
+  float MinimumReverseSpeed  // lowest indicated airspeed in knots for reverse thrust
+  )
+{
+  if (Autobrake == AUTOBRAKE_OFF) return FALSE;
+  if (Active) return TRUE;
+
+  MinReverseSpeed = MinimumReverseSpeed;
+
+  Active = TRUE;
+  HaveMeasurement = FALSE;
+  ReverseDeployed = FALSE;
+  Deceleration = 0;
+  // start with full reverse thrust, the controller backs off if it is too much
+  Integral = 1.0f;
+
+#if DIAGNOSTIC == 1
+  Diagnostic_printf("Rollout controller started, target deceleration %f m/s^2\n", TargetDeceleration(Config_Get()));
+#endif // DIAGNOSTIC
+
+  Scheduler_Schedule(ControllerTask, CONTROLLER_EXECUTION_EVERY_FRAME);
+
+  return TRUE;
+}
+
+// stops controlling the deceleration, releases the brakes and stows the reversers
+void RolloutController_Stop
+  (
+  void
+  )
+{
+  if (Active == FALSE) return;
+
+  StowReversers();
+  SetBrakes(0);
+  Active = FALSE;
+
+  Scheduler_Schedule(ControllerTask, 0);
+}
+
+// returns TRUE while the deceleration is being controlled
+int RolloutController_IsActive
+  (
+  void
+  )
+{
+  return Active;
+}
+
+// called when an event is published, see Events.cpp
+void RolloutController_HandleEvent
+  (
+  const event_t *Event
+  )
+{
+  // don't leave the brakes or reversers on for the next flight, or while disabled
+  if ((Event->Type == EVENT_SESSION_RESET) || (Event->Type == EVENT_PLUGIN_DISABLED))
+  {
+    RolloutController_Stop();
+  }
+}
@@ -0,0 +1,39 @@
+#ifndef _ROLLOUTCONTROLLERH_
+#define _ROLLOUTCONTROLLERH_
+
+#include "Global.h"
+#include "Events.h"
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int RolloutController_Init
+  (
+  XPLMMenuID ParentMenuId
+  );
+
+// starts controlling the deceleration after touch down
+// returns TRUE if started, FALSE if the autobrake is off
+extern int RolloutController_Start
+  (
+  float MinimumReverseSpeed  // lowest indicated airspeed in knots for reverse thrust
+  );
+
+// stops controlling the deceleration, releases the brakes and stows the reversers
+extern void RolloutController_Stop
+  (
+  void
+  );
+
+// returns TRUE while the deceleration is being controlled
+extern int RolloutController_IsActive
+  (
+  void
+  );
+
+// called when an event is published, see Events.cpp
+extern void RolloutController_HandleEvent
+  (
+  const event_t *Event
+  );
+
+#endif // _ROLLOUTCONTROLLERH_
@@ -1,40 +1,41 @@
 #include "XPCProcessing.h"
 #include "XPLMUtilities.h"
+#include "Scheduler.h"
+
+// In XVRTools the process is a task of the plugin's scheduler, see Scheduler.cpp,
+// instead of a flight loop of its own, so it stops while the plugin is disabled
 
 XPCProcess::XPCProcess() :
 	mInCallback(false),
 	mCallbackTime(0)
 {
-	XPLMRegisterFlightLoopCallback(FlightLoopCB, 0, reinterpret_cast<void *>(this));
+	mTaskId = Scheduler_AddTaskWithRefcon(FlightLoopCB, reinterpret_cast<void *>(this), SCHEDULER_NOT_PROFILED, 0);
 }
 
 XPCProcess::~XPCProcess()
 {
-	XPLMUnregisterFlightLoopCallback(FlightLoopCB, reinterpret_cast<void *>(this));
+	Scheduler_DeleteTask(mTaskId);
 }
 	
 void		XPCProcess::StartProcessTime(float	inSeconds)
 {
 	mCallbackTime = inSeconds;
 	if (!mInCallback)
-		XPLMSetFlightLoopCallbackInterval(
-			FlightLoopCB, mCallbackTime, 1/*relative to now*/, reinterpret_cast<void *>(this));
+		Scheduler_Schedule(mTaskId, mCallbackTime);
 }
 
 void		XPCProcess::StartProcessCycles(int	inCycles)
 {
 	mCallbackTime = -inCycles;
 	if (!mInCallback)
-		XPLMSetFlightLoopCallbackInterval(
-			FlightLoopCB, mCallbackTime, 1/*relative to now*/, reinterpret_cast<void *>(this));
+		Scheduler_Schedule(mTaskId, mCallbackTime);
 }
 
 void		XPCProcess::StopProcess(void)
 {
 	mCallbackTime = 0;
 	if (!mInCallback)
-		XPLMSetFlightLoopCallbackInterval(
-			FlightLoopCB, mCallbackTime, 1/*relative to now*/, reinterpret_cast<void *>(this));
+		Scheduler_Schedule(mTaskId, mCallbackTime);
 }
 
 
@@ -28,6 +28,7 @@ private:
 						
 		bool		mInCallback;
 		float		mCallbackTime;
+		int			mTaskId;
 		
 	XPCProcess(const XPCProcess&);
 	XPCProcess& operator=(const XPCProcess&);
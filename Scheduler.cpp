@@ -0,0 +1,388 @@
+// SCHEDULER
+
+// Runs all of the periodic tasks of the plugin from one x-plane flight loop
+// callback, instead of every module registering its own
+// The tasks are kept in a heap ordered by when they are next due, so each
+// frame only looks at the tasks that are due, and the flight loop itself
+// sleeps until the first one is. Tasks that are due at the same time run in
+// the order they were added
+// Tasks use the same callback and return values as x-plane flight loops so a
+// module's state machine doesn't need to know it is being run by us
+
+#include "Scheduler.h"
+#include "Diagnostic.h"
+#include "Profile.h"
+#include "Clock.h"
+#include "Timing.h"
+
+// used for a task that runs again in the next frame, so it isn't run twice in one frame
+#define NEXT_FRAME_OFFSET 0.000001
+
+// a periodic task
+typedef struct _scheduler_task_t
+{
+  XPLMFlightLoop_f Callback;  // NULL if the task has been deleted
+  void *Refcon;
+  int ProfileSection;
+  double NextTime;      // elapsed time when it is next due
+  double LastTime;      // elapsed time it last ran or was scheduled
+  int HeapIndex;        // position in the heap, -1 when not scheduled
+} scheduler_task_t;
+
+static scheduler_task_t Tasks[SCHEDULER_MAX_TASKS];
+static int NumTasks;
+
+// task IDs ordered by when they are due, the first is due soonest
+static int Heap[SCHEDULER_MAX_TASKS];
+static int HeapSize;
+
+static XPLMFlightLoopID SchedulerFlightLoop = NULL;
+// TRUE while the due tasks are being run
+static bool Running;
+// TRUE while the plugin is disabled, and when it was disabled
+static bool Suspended;
+static double SuspendTime;
+// the real time of the last frame, used for tasks that ask for several frames
+// and to wake up a frame early, it doesn't change with time compression or pause
+static double FramePeriod = 1.0 / 60.0;
+// TRUE if the flight loop last asked to run in the next frame, so the time since it
+// last ran is one frame
+static bool WokeForNextFrame;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// returns TRUE if a task is due before another
+static bool IsBefore
+  (
+  int TaskA,
+  int TaskB
+  )
+{
+  if (Tasks[TaskA].NextTime != Tasks[TaskB].NextTime) return Tasks[TaskA].NextTime < Tasks[TaskB].NextTime;
+  return TaskA < TaskB;
+}
+
+// puts a task at a position in the heap
+static void SetHeap
+  (
+  int Index,
+  int TaskId
+  )
+{
+  Heap[Index] = TaskId;
+  Tasks[TaskId].HeapIndex = Index;
+}
+
+// moves a task towards the top of the heap until it is in order
+static void SiftUp
+  (
+  int Index
+  )
+{
+  int TaskId = Heap[Index];
+
+  while (Index > 0)
+  {
+    int Parent = (Index - 1) / 2;
+    if (IsBefore(TaskId, Heap[Parent]) == FALSE) break;
+    SetHeap(Index, Heap[Parent]);
+    Index = Parent;
+  }
+
+  SetHeap(Index, TaskId);
+}
+
+// moves a task towards the bottom of the heap until it is in order
+static void SiftDown
+  (
+  int Index
+  )
+{
+  int TaskId = Heap[Index];
+
+  while (TRUE)
+  {
+    int Child = (Index * 2) + 1;
+    if (Child >= HeapSize) break;
+    if ((Child + 1 < HeapSize) && IsBefore(Heap[Child + 1], Heap[Child])) Child++;
+    if (IsBefore(Heap[Child], TaskId) == FALSE) break;
+    SetHeap(Index, Heap[Child]);
+    Index = Child;
+  }
+
+  SetHeap(Index, TaskId);
+}
+
+// takes a task out of the heap, does nothing if it isn't scheduled
+static void RemoveTask
+  (
+  int TaskId
+  )
+{
+  int Index = Tasks[TaskId].HeapIndex;
+  if (Index < 0) return;
+  Tasks[TaskId].HeapIndex = -1;
+
+  HeapSize--;
+  if (Index == HeapSize) return;
+
+  // fill the gap with the last task and put that in order
+  SetHeap(Index, Heap[HeapSize]);
+  SiftUp(Index);
+  SiftDown(Tasks[Heap[Index]].HeapIndex);
+}
+
+// puts a task in the heap to run after an interval
+static void InsertTask
+  (
+  int TaskId,
+  float Interval,   // seconds, or a negative number of frames
+  double Now
+  )
+{
+  scheduler_task_t *Task = &Tasks[TaskId];
+
+  if (Interval > 0)
+  {
+    Task->NextTime = Now + Interval;
+  }
+  else
+  {
+    Task->NextTime = Now + NEXT_FRAME_OFFSET + ((-Interval - 1.0) * FramePeriod);
+  }
+
+  Task->HeapIndex = HeapSize;
+  Heap[HeapSize++] = TaskId;
+  SiftUp(Task->HeapIndex);
+}
+
+// gets the interval for the scheduler flight loop to wake up for the first task
+// returns 0 if there are no tasks scheduled
+static float GetWakeInterval
+  (
+  double Now
+  )
+{
+  if (HeapSize == 0) return 0;
+
+  double Interval = Tasks[Heap[0]].NextTime - Now;
+  if (Interval < FramePeriod) return -1.0f;
+  return (float)Interval;
+}
+
+// runs the tasks that are due, called by x-plane
+// returns the time until the next task is due
+static float RunTasks
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  double Now = XPLMGetElapsedTime();
+  if (WokeForNextFrame && (elapsedMe > 0) && (elapsedMe <= CLOCK_MAX_FRAME_TIME)) FramePeriod = elapsedMe;
+
+  // the tasks all see the same time for the frame
+  Clock_Update();
+
+  Running = TRUE;
+
+  while ((HeapSize > 0) && (Tasks[Heap[0]].NextTime <= Now))
+  {
+    int TaskId = Heap[0];
+    scheduler_task_t *Task = &Tasks[TaskId];
+    RemoveTask(TaskId);
+
+    float SinceLastRun = (float)(Now - Task->LastTime);
+    Task->LastTime = Now;
+
+    double StartTime = Timing_GetTime();
+    float Interval = Task->Callback(SinceLastRun, elapsedSim, counter, Task->Refcon);
+    if (Task->ProfileSection != SCHEDULER_NOT_PROFILED)
+    {
+      Profile_Record((profile_section_t)Task->ProfileSection, 0, Timing_GetTime() - StartTime);
+    }
+
+    // the return value decides, as it does for x-plane, even if the task scheduled itself
+    // unless it was deleted
+    RemoveTask(TaskId);
+    if ((Interval != 0) && (Task->Callback != NULL)) InsertTask(TaskId, Interval, Now);
+  }
+
+  Running = FALSE;
+
+  float WakeInterval = GetWakeInterval(Now);
+  WokeForNextFrame = (WakeInterval < 0);
+  return WakeInterval;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int Scheduler_Init
+  (
+  void
+  )
+{
+  NumTasks = 0;
+  HeapSize = 0;
+  Running = FALSE;
+  Suspended = FALSE;
+  WokeForNextFrame = FALSE;
+
+  XPLMCreateFlightLoop_t FlightLoop;
+  FlightLoop.structSize = sizeof(FlightLoop);
+  FlightLoop.phase = xplm_FlightLoop_Phase_AfterFlightModel;
+  FlightLoop.callbackFunc = RunTasks;
+  FlightLoop.refcon = NULL;
+  SchedulerFlightLoop = XPLMCreateFlightLoop(&FlightLoop);
+
+  return SchedulerFlightLoop != NULL;
+}
+
+// stops running the tasks, called when the plugin is stopped
+void Scheduler_Stop
+  (
+  void
+  )
+{
+  if (SchedulerFlightLoop != NULL)
+  {
+    XPLMDestroyFlightLoop(SchedulerFlightLoop);
+    SchedulerFlightLoop = NULL;
+  }
+
+  NumTasks = 0;
+  HeapSize = 0;
+}
+
+// stops running the tasks until resumed, used when the plugin is disabled
+// tasks can still be scheduled, they run once the scheduler is resumed
+void Scheduler_Suspend
+  (
+  void
+  )
+{
+  if (Suspended) return;
+
+  Suspended = TRUE;
+  SuspendTime = XPLMGetElapsedTime();
+  XPLMScheduleFlightLoop(SchedulerFlightLoop, 0, 0);
+}
+
+// carries on running the tasks, each is due the same time after resuming as it was before suspending
+// does nothing if the scheduler isn't suspended
+void Scheduler_Resume
+  (
+  void
+  )
+{
+  if (Suspended == FALSE) return;
+
+  // moving every task by the same time keeps the heap in order
+  double Now = XPLMGetElapsedTime();
+  double SuspendedFor = Now - SuspendTime;
+  for (int t = 0; t < NumTasks; t++)
+  {
+    Tasks[t].NextTime += SuspendedFor;
+    Tasks[t].LastTime += SuspendedFor;
+  }
+
+  Suspended = FALSE;
+  WokeForNextFrame = FALSE;
+  XPLMScheduleFlightLoop(SchedulerFlightLoop, GetWakeInterval(Now), 1);
+}
+
+// adds a periodic task
+// the callback works in the same way as an x-plane flight loop callback,
+// it returns the seconds to its next execution, a negative number of frames,
+// or 0 to stop until it is scheduled again
+// returns the task ID, or -1 if there is no more space
+int Scheduler_AddTask
+  (
+  XPLMFlightLoop_f Callback,   // called with a NULL refcon
+  int ProfileSection,          // profile_section_t to time it as, or SCHEDULER_NOT_PROFILED
+  float Interval               // time to the first execution, in the same way as the callback return value
+  )
+{
+  return Scheduler_AddTaskWithRefcon(Callback, NULL, ProfileSection, Interval);
+}
+
+// adds a periodic task that is given a refcon, as an x-plane flight loop is
+// returns the task ID, or -1 if there is no more space
+int Scheduler_AddTaskWithRefcon
+  (
+  XPLMFlightLoop_f Callback,
+  void *Refcon,                // passed to the callback
+  int ProfileSection,          // profile_section_t to time it as, or SCHEDULER_NOT_PROFILED
+  float Interval               // time to the first execution, in the same way as the callback return value
+  )
+{
+  // use the ID of a deleted task if there is one
+  int TaskId = 0;
+  while ((TaskId < NumTasks) && (Tasks[TaskId].Callback != NULL)) TaskId++;
+
+  if (TaskId >= SCHEDULER_MAX_TASKS)
+  {
+#if DIAGNOSTIC == 1
+    Diagnostic_printf("No room for another scheduled task\n");
+#endif // DIAGNOSTIC
+    return -1;
+  }
+
+  if (TaskId == NumTasks) NumTasks++;
+  Tasks[TaskId].Callback = Callback;
+  Tasks[TaskId].Refcon = Refcon;
+  Tasks[TaskId].ProfileSection = ProfileSection;
+  Tasks[TaskId].HeapIndex = -1;
+  Tasks[TaskId].LastTime = XPLMGetElapsedTime();
+
+  Scheduler_Schedule(TaskId, Interval);
+
+  return TaskId;
+}
+
+// removes a task, its ID can then be used for another task
+void Scheduler_DeleteTask
+  (
+  int TaskId
+  )
+{
+  if ((TaskId < 0) || (TaskId >= NumTasks)) return;
+
+  RemoveTask(TaskId);
+  Tasks[TaskId].Callback = NULL;
+}
+
+// changes when a task next runs, in the same way as XPLMScheduleFlightLoop
+// an interval of 0 stops the task
+void Scheduler_Schedule
+  (
+  int TaskId,
+  float Interval
+  )
+{
+  if ((TaskId < 0) || (TaskId >= NumTasks) || (Tasks[TaskId].Callback == NULL)) return;
+
+  double Now = XPLMGetElapsedTime();
+
+  RemoveTask(TaskId);
+  if (Interval != 0)
+  {
+    // the time since it last ran is counted from now, as x-plane does
+    if (Running == FALSE) Tasks[TaskId].LastTime = Now;
+    InsertTask(TaskId, Interval, Now);
+  }
+
+  // wake up in time for the first task, unless the tasks are being run when it is worked out at the end
+  if ((Running == FALSE) && (Suspended == FALSE) && (SchedulerFlightLoop != NULL))
+  {
+    WokeForNextFrame = FALSE;
+    XPLMScheduleFlightLoop(SchedulerFlightLoop, GetWakeInterval(Now), 1);
+  }
+}
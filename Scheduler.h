@@ -0,0 +1,75 @@
+#ifndef _SCHEDULERH_
+#define _SCHEDULERH_
+
+#include "Global.h"
+
+// maximum number of periodic tasks
+#define SCHEDULER_MAX_TASKS 16
+
+// the task isn't timed by the scheduler because it records its own timing
+#define SCHEDULER_NOT_PROFILED -1
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int Scheduler_Init
+  (
+  void
+  );
+
+// stops running the tasks, called when the plugin is stopped
+extern void Scheduler_Stop
+  (
+  void
+  );
+
+// stops running the tasks until resumed, used when the plugin is disabled
+// tasks can still be scheduled, they run once the scheduler is resumed
+extern void Scheduler_Suspend
+  (
+  void
+  );
+
+// carries on running the tasks, each is due the same time after resuming as it was before suspending
+// does nothing if the scheduler isn't suspended
+extern void Scheduler_Resume
+  (
+  void
+  );
+
+// adds a periodic task
+// the callback works in the same way as an x-plane flight loop callback,
+// it returns the seconds to its next execution, a negative number of frames,
+// or 0 to stop until it is scheduled again
+// returns the task ID, or -1 if there is no more space
+extern int Scheduler_AddTask
+  (
+  XPLMFlightLoop_f Callback,   // called with a NULL refcon
+  int ProfileSection,          // profile_section_t to time it as, or SCHEDULER_NOT_PROFILED
+  float Interval               // time to the first execution, in the same way as the callback return value
+  );
+
+// adds a periodic task that is given a refcon, as an x-plane flight loop is
+// returns the task ID, or -1 if there is no more space
+extern int Scheduler_AddTaskWithRefcon
+  (
+  XPLMFlightLoop_f Callback,
+  void *Refcon,                // passed to the callback
+  int ProfileSection,          // profile_section_t to time it as, or SCHEDULER_NOT_PROFILED
+  float Interval               // time to the first execution, in the same way as the callback return value
+  );
+
+// removes a task, its ID can then be used for another task
+extern void Scheduler_DeleteTask
+  (
+  int TaskId
+  );
+
+// changes when a task next runs, in the same way as XPLMScheduleFlightLoop
+// an interval of 0 stops the task
+extern void Scheduler_Schedule
+  (
+  int TaskId,
+  float Interval
+  );
+
+#endif // _SCHEDULERH_
@@ -0,0 +1,401 @@
+// SCORECARD
+
+// Measures each landing and shows a card with the results at the end of the
+// rollout, along with how the last few landings in the same aircraft went
+// The float is measured from the flare height to the first wheel touching
+// the ground, then the peak G and any bounces until the aircraft has slowed
+// to taxi speed. The card is laid out once when the landing is complete, so
+// showing it costs nothing extra each frame
+
+#include "Scorecard.h"
+#include "TextWindow.h"
+#include "Diagnostic.h"
+#include "Config.h"
+#include "Settings.h"
+#include "Profile.h"
+#include "Scheduler.h"
+#include "Clock.h"
+
+#define MODULE_NAME "Landing Scorecard"
+
+// menu item IDs
+#define MENU_ITEM_ID_ENABLE 1
+#define MENU_ITEM_ID_SHOW   2
+
+// size of the card in boxels and its position on the monitor
+#define WINDOW_WIDTH  320
+#define WINDOW_HEIGHT 150
+#define WINDOW_X      50
+#define WINDOW_Y      350
+
+// height in meters above the ground at which the float starts
+#define FLARE_HEIGHT 15.0f
+// height above which the landing has been abandoned
+#define GO_AROUND_HEIGHT 30.0f
+// seconds all wheels must be off the ground to count as a bounce
+#define BOUNCE_TIME 0.1f
+// number of landings kept for the rolling statistics
+#define MAX_HISTORY 10
+// sink rate in m/s above which a landing is shown as hard
+#define HARD_LANDING_SINK_RATE 2.0f
+#define MS_TO_FPM 196.85f
+
+// seconds between executions while waiting for an approach
+#define WAIT_EXECUTION_INTERVAL 0.5f
+// execution every frame while landing
+#define LANDING_EXECUTION_EVERY_FRAME -1.0f
+
+// tracker states
+typedef enum _states_t
+{
+  WAIT_FOR_FLYING,
+  WAIT_FOR_APPROACH,
+  FLOATING,
+  ROLLOUT
+} states_t;
+
+// the results of a landing
+typedef struct _landing_t
+{
+  float SinkRate;        // m/s at touch down
+  float PeakG;
+  float FloatDistance;   // meters from the flare height to touch down
+  int Bounces;
+} landing_t;
+
+// commands and data references that we need
+static XPLMDataRef AltitudeAboveGroundRef = NULL;
+static XPLMDataRef AnyWheelOnGroundRef    = NULL;
+static XPLMDataRef GroundSpeedRef         = NULL;
+static XPLMDataRef VerticalSpeedRef       = NULL;
+static XPLMDataRef GForceRef              = NULL;
+
+static states_t CurrentState;
+static int TrackerTask = -1;
+static bool Enabled;
+static XPLMMenuID myMenu;
+static int MenuItem_Enable;
+static text_window_t Window;
+
+// the landing being measured
+static landing_t Current;
+static float LastVerticalSpeed;
+static float AirborneTime;
+static bool BounceCounted;
+static bool HaveTouchdownEvent;
+
+// recent landings in the current aircraft, oldest first once full
+static landing_t History[MAX_HISTORY];
+static int HistoryCount;
+static int HistoryNext;
+
+// prototype for the function that handles menu choices
+static void	MenuHandlerCallback(void *inMenuRef, void *inItemRef);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// forgets the landings in the last aircraft
+static void ClearHistory
+  (
+  void
+  )
+{
+  HistoryCount = 0;
+  HistoryNext = 0;
+}
+
+// lays out the card for the last landing
+static void BuildCard
+  (
+  const landing_t *Landing
+  )
+{
+  TextWindow_Clear(&Window);
+
+  TextWindow_AddLine(&Window, 0, Landing->SinkRate > HARD_LANDING_SINK_RATE, "Sink rate: %.1f m/s (%.0f fpm)",
+    Landing->SinkRate, Landing->SinkRate * MS_TO_FPM);
+  TextWindow_AddLine(&Window, 0, FALSE, "Peak load: %.2f G", Landing->PeakG);
+  TextWindow_AddLine(&Window, 0, FALSE, "Float: %.0f m", Landing->FloatDistance);
+  TextWindow_AddLine(&Window, 0, Landing->Bounces > 0, "Bounces: %d", Landing->Bounces);
+
+  // rolling statistics for this aircraft
+  float TotalSinkRate = 0;
+  float TotalPeakG = 0;
+  float BestSinkRate = History[0].SinkRate;
+  for (int h = 0; h < HistoryCount; h++)
+  {
+    TotalSinkRate += History[h].SinkRate;
+    TotalPeakG += History[h].PeakG;
+    if (History[h].SinkRate < BestSinkRate) BestSinkRate = History[h].SinkRate;
+  }
+
+  TextWindow_AddLine(&Window, 0, FALSE, "Last %d landings in this aircraft:", HistoryCount);
+  TextWindow_AddLine(&Window, TEXT_WINDOW_INDENT, FALSE, "Average %.1f m/s, %.2f G", TotalSinkRate / HistoryCount, TotalPeakG / HistoryCount);
+  TextWindow_AddLine(&Window, TEXT_WINDOW_INDENT, FALSE, "Best %.1f m/s", BestSinkRate);
+}
+
+// records the landing and shows the card
+static void CompleteLanding
+  (
+  void
+  )
+{
+  History[HistoryNext] = Current;
+  HistoryNext = (HistoryNext + 1) % MAX_HISTORY;
+  if (HistoryCount < MAX_HISTORY) HistoryCount++;
+
+#if DIAGNOSTIC == 1
+  Diagnostic_printf("Landing complete, %f m/s %f G %f m float %d bounces\n", Current.SinkRate, Current.PeakG, Current.FloatDistance, Current.Bounces);
+#endif // DIAGNOSTIC
+
+  BuildCard(&Current);
+  if (Enabled) TextWindow_SetVisible(&Window, TRUE);
+
+  CurrentState = WAIT_FOR_FLYING;
+}
+
+// measures the landing, called periodically by x-plane
+// returns the number of seconds to the next execution
+static float TrackLanding
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  bool OnGround = XPLMGetDatai(AnyWheelOnGroundRef) != FALSE;
+  float AltitudeAboveGround = XPLMGetDataf(AltitudeAboveGroundRef);
+
+  switch (CurrentState)
+  {
+    case WAIT_FOR_FLYING:
+      if (OnGround == FALSE) CurrentState = WAIT_FOR_APPROACH;
+      break;
+
+    case WAIT_FOR_APPROACH:
+      if (OnGround)
+      {
+        CurrentState = WAIT_FOR_FLYING;
+      }
+      else if (AltitudeAboveGround < FLARE_HEIGHT)
+      {
+        memset(&Current, 0, sizeof(Current));
+        LastVerticalSpeed = 0;
+        HaveTouchdownEvent = FALSE;
+        CurrentState = FLOATING;
+      }
+      break;
+
+    case FLOATING:
+      if (OnGround)
+      {
+        // the speed on the frame before touching is the one that counts, the gear has already slowed it
+        if (HaveTouchdownEvent == FALSE) Current.SinkRate = -LastVerticalSpeed;
+        Current.PeakG = XPLMGetDataf(GForceRef);
+        AirborneTime = 0;
+        BounceCounted = FALSE;
+        CurrentState = ROLLOUT;
+      }
+      else if (AltitudeAboveGround > GO_AROUND_HEIGHT)
+      {
+        CurrentState = WAIT_FOR_APPROACH;
+      }
+      else
+      {
+        Current.FloatDistance += XPLMGetDataf(GroundSpeedRef) * Clock_GetFrameTime(CLOCK_SIM);
+        LastVerticalSpeed = XPLMGetDataf(VerticalSpeedRef);
+      }
+      break;
+
+    case ROLLOUT:
+    {
+      float G = XPLMGetDataf(GForceRef);
+      if (G > Current.PeakG) Current.PeakG = G;
+
+      if (OnGround)
+      {
+        AirborneTime = 0;
+        BounceCounted = FALSE;
+
+        if (XPLMGetDataf(GroundSpeedRef) < Config_Get()->RolloutEndSpeed) CompleteLanding();
+      }
+      else if (AltitudeAboveGround > GO_AROUND_HEIGHT)
+      {
+        // touch and go
+        CurrentState = WAIT_FOR_APPROACH;
+      }
+      else
+      {
+        AirborneTime += Clock_GetFrameTime(CLOCK_SIM);
+        if ((AirborneTime >= BOUNCE_TIME) && (BounceCounted == FALSE))
+        {
+          Current.Bounces++;
+          BounceCounted = TRUE;
+        }
+      }
+    }
+    break;
+  }
+
+  if ((CurrentState == FLOATING) || (CurrentState == ROLLOUT)) return LANDING_EXECUTION_EVERY_FRAME;
+  return WAIT_EXECUTION_INTERVAL;
+}
+
+// updates the menu check mark
+static void UpdateMenu
+  (
+  void
+  )
+{
+  XPLMCheckMenuItem(myMenu, MenuItem_Enable, Enabled ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+}
+
+// called when the user chooses a menu item
+static void MenuHandlerCallback
+(
+  void *inMenuRef,
+  void *inItemRef
+)
+{
+  // user chose to show the card after each landing or not
+  if ((intptr_t)inItemRef == MENU_ITEM_ID_ENABLE)
+  {
+    Enabled = !Enabled;
+    UpdateMenu();
+
+    Settings_Get()->ScorecardEnabled = Enabled;
+    Settings_Changed();
+  }
+  // user chose to see the last card again
+  else if ((intptr_t)inItemRef == MENU_ITEM_ID_SHOW)
+  {
+    if (HistoryCount > 0) TextWindow_SetVisible(&Window, TRUE);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int Scorecard_Init
+  (
+  XPLMMenuID ParentMenuId
+  )
+{
+  int mySubMenuItem = XPLMAppendMenuItem(
+    ParentMenuId,
+    MODULE_NAME,
+    0,
+    1);
+
+  myMenu = XPLMCreateMenu(
+    MODULE_NAME,
+    ParentMenuId,
+    mySubMenuItem,
+    MenuHandlerCallback,
+    0
+  );
+
+  // Append menu items to our submenu
+  MenuItem_Enable = XPLMAppendMenuItem(
+    myMenu,
+    "Show after landing",
+    (void *)MENU_ITEM_ID_ENABLE,
+    1);
+  XPLMAppendMenuItem(
+    myMenu,
+    "Show last landing",
+    (void *)MENU_ITEM_ID_SHOW,
+    1);
+
+  Enabled = Settings_Get()->ScorecardEnabled;
+  UpdateMenu();
+
+  // get datarefs
+  AltitudeAboveGroundRef = XPLMFindDataRef("sim/flightmodel2/position/y_agl");
+  if (AltitudeAboveGroundRef == NULL)
+  {
+    return FALSE;
+  }
+  AnyWheelOnGroundRef = XPLMFindDataRef("sim/flightmodel/failures/onground_any");
+  if (AnyWheelOnGroundRef == NULL)
+  {
+    return FALSE;
+  }
+  GroundSpeedRef = XPLMFindDataRef("sim/flightmodel/position/groundspeed");
+  if (GroundSpeedRef == NULL)
+  {
+    return FALSE;
+  }
+  VerticalSpeedRef = XPLMFindDataRef("sim/flightmodel/position/local_vy");
+  if (VerticalSpeedRef == NULL)
+  {
+    return FALSE;
+  }
+  GForceRef = XPLMFindDataRef("sim/flightmodel/forces/g_nrml");
+  if (GForceRef == NULL)
+  {
+    return FALSE;
+  }
+
+  // clicking the card closes it
+  if (!TextWindow_Create(&Window, WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_X, WINDOW_Y, TRUE, NULL))
+  {
+    return FALSE;
+  }
+
+  CurrentState = WAIT_FOR_FLYING;
+  ClearHistory();
+
+  TrackerTask = Scheduler_AddTask(TrackLanding, PROFILE_SCORECARD, WAIT_EXECUTION_INTERVAL);
+
+  return TRUE;
+}
+
+// called when an event is published, see Events.cpp
+void Scorecard_HandleEvent
+  (
+  const event_t *Event
+  )
+{
+  switch (Event->Type)
+  {
+    // the statistics are for one aircraft
+    case EVENT_PLANE_LOADED:
+      ClearHistory();
+      TextWindow_SetVisible(&Window, FALSE);
+      break;
+
+    // a crash or a new flight isn't a landing, and a landing can't be measured while disabled
+    case EVENT_SESSION_RESET:
+    case EVENT_PLUGIN_DISABLED:
+      CurrentState = WAIT_FOR_FLYING;
+      Scheduler_Schedule(TrackerTask, WAIT_EXECUTION_INTERVAL);
+      break;
+
+    // use the sink rate that head motion measured so the card agrees with it
+    case EVENT_TOUCHDOWN:
+      if ((CurrentState == FLOATING) || (CurrentState == ROLLOUT))
+      {
+        Current.SinkRate = Event->Touchdown.SinkRateMS;
+        HaveTouchdownEvent = TRUE;
+      }
+      break;
+
+    // the rollout controller has already decided the rollout is over
+    case EVENT_ROLLOUT_COMPLETE:
+      if (CurrentState == ROLLOUT)
+      {
+        CompleteLanding();
+        Scheduler_Schedule(TrackerTask, WAIT_EXECUTION_INTERVAL);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
@@ -0,0 +1,20 @@
+#ifndef _SCORECARDH_
+#define _SCORECARDH_
+
+#include "Global.h"
+#include "Events.h"
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int Scorecard_Init
+  (
+  XPLMMenuID ParentMenuId
+  );
+
+// called when an event is published, see Events.cpp
+extern void Scorecard_HandleEvent
+  (
+  const event_t *Event
+  );
+
+#endif // _SCORECARDH_
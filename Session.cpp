@@ -0,0 +1,80 @@
+// SESSION
+
+// Decides when the flight has started again, so the modules can forget
+// everything about the last one
+// X-plane says when the user's aircraft is loaded, unloaded or crashes and
+// when it has been placed at an airport. Each of these is turned into one
+// session reset event, with the message that caused it, so the modules don't
+// need to watch the flight time every tick to spot a new flight
+// Scenery is also loaded while flying into new areas, so that only counts as
+// a reset at the very start of a flight, when the aircraft has just been placed
+
+#include "Session.h"
+#include "Diagnostic.h"
+
+// data references that we need
+static XPLMDataRef FlightTimeRef = NULL;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// tells the modules the flight has started again
+static void PublishReset
+  (
+  event_type_t Cause  // the event that caused the reset
+  )
+{
+#if DIAGNOSTIC == 1
+  Diagnostic_printf("Session reset, cause %d\n", Cause);
+#endif // DIAGNOSTIC
+
+  event_t Reset;
+  Reset.Type = EVENT_SESSION_RESET;
+  Reset.Reset.Cause = Cause;
+  Events_Publish(&Reset);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int Session_Init
+  (
+  void
+  )
+{
+  FlightTimeRef = XPLMFindDataRef("sim/time/total_flight_time_sec");
+  if (FlightTimeRef == NULL)
+  {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+// called when an event is published, see Events.cpp
+void Session_HandleEvent
+  (
+  const event_t *Event
+  )
+{
+  switch (Event->Type)
+  {
+    case EVENT_PLANE_LOADED:
+    case EVENT_PLANE_UNLOADED:
+    case EVENT_PLANE_CRASHED:
+    case EVENT_AIRPORT_LOADED:
+      PublishReset(Event->Type);
+      break;
+
+    // otherwise the aircraft has just flown into new scenery
+    case EVENT_SCENERY_LOADED:
+      if (XPLMGetDataf(FlightTimeRef) < SESSION_START_FLIGHT_TIME) PublishReset(Event->Type);
+      break;
+
+    default:
+      break;
+  }
+}
@@ -0,0 +1,23 @@
+#ifndef _SESSIONH_
+#define _SESSIONH_
+
+#include "Global.h"
+#include "Events.h"
+
+// scenery loaded within this many seconds of the start of a flight is part of starting it
+#define SESSION_START_FLIGHT_TIME 5.0f
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int Session_Init
+  (
+  void
+  );
+
+// called when an event is published, see Events.cpp
+extern void Session_HandleEvent
+  (
+  const event_t *Event
+  );
+
+#endif // _SESSIONH_
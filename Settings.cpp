@@ -0,0 +1,280 @@
+// SETTINGS
+
+// Keeps the choices the user makes in the menus between sessions
+// The settings are a plain structure that the modules read directly. When
+// one changes, a copy is handed to a writer thread which waits until there
+// have been no more changes for a short time and then saves it, so clicking
+// through the menus doesn't write the file over and over and the sim thread
+// never waits for the disk
+// The file is written to a temporary file first and then renamed over the
+// old one, so a crash while saving leaves either the old or the new settings
+
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <stddef.h>
+#include <stdlib.h>
+#if IBM
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "Settings.h"
+#include "Diagnostic.h"
+
+// time in milliseconds after the last change before the settings are saved
+#define SAVE_DELAY_MS 2000
+// longest line in the file
+#define MAX_LINE_LENGTH 256
+
+// describes a value in the file
+typedef struct _settings_item_t
+{
+  const char *Name;
+  size_t Offset;
+} settings_item_t;
+
+// values used when there is no file or the file doesn't set them
+static const settings_t Defaults =
+{
+  FALSE,  // TouchdownMotionEnabled
+  FALSE,  // GroundRollEnabled
+  FALSE,  // GSeatEnabled
+  FALSE,  // EngineVibrationEnabled
+  FALSE,  // AnnounceWhenReady
+  0,      // Autobrake, off
+  FALSE,  // StatusWindowVisible
+  FALSE   // ScorecardEnabled
+};
+
+// all of the values in the file
+static const settings_item_t Items[] =
+{
+  {"touchdown_motion_enabled", offsetof(settings_t, TouchdownMotionEnabled)},
+  {"ground_roll_enabled",      offsetof(settings_t, GroundRollEnabled)},
+  {"gseat_enabled",            offsetof(settings_t, GSeatEnabled)},
+  {"engine_vibration_enabled", offsetof(settings_t, EngineVibrationEnabled)},
+  {"announce_when_ready",      offsetof(settings_t, AnnounceWhenReady)},
+  {"autobrake",                offsetof(settings_t, Autobrake)},
+  {"status_window_visible",    offsetof(settings_t, StatusWindowVisible)},
+  {"scorecard_enabled",        offsetof(settings_t, ScorecardEnabled)},
+};
+
+#define NUM_ITEMS (int)(sizeof(Items) / sizeof(settings_item_t))
+
+// x-plane's paths are up to 512 characters, the file path also has a separator and the file name
+#define MAX_FOLDER_LENGTH 512
+#define MAX_FILE_PATH_LENGTH (MAX_FOLDER_LENGTH + 8 + sizeof(SETTINGS_FILE_NAME))
+#define MAX_TEMP_FILE_PATH_LENGTH (MAX_FILE_PATH_LENGTH + sizeof(".tmp"))
+
+static char FilePath[MAX_FILE_PATH_LENGTH];
+static char TempFilePath[MAX_TEMP_FILE_PATH_LENGTH];
+
+// the settings used by the modules, only touched on the sim thread
+static settings_t Settings;
+static unsigned int Version;
+
+// copy waiting to be saved, shared with the writer
+static std::mutex PendingLock;
+static std::condition_variable PendingSignal;
+static settings_t Pending;
+static bool HavePending;
+static bool StopWriter;
+static std::chrono::steady_clock::time_point LastChange;
+
+static std::thread Writer;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// reads the settings file
+// returns TRUE if the file was read
+static bool LoadFile
+  (
+  settings_t *Values  // filled with the settings
+  )
+{
+  FILE *File;
+  if (fopen_s(&File, FilePath, "r") != 0) return FALSE;
+
+  char Line[MAX_LINE_LENGTH];
+  while (fgets(Line, MAX_LINE_LENGTH, File) != NULL)
+  {
+    char *Equals = strchr(Line, '=');
+    if ((Line[0] == '#') || (Equals == NULL)) continue;
+    *Equals = '\0';
+
+    // names are written without spaces
+    char *Name = Line;
+    while (*Name == ' ') Name++;
+    char *End = Name;
+    while ((*End != '\0') && (*End != ' ')) End++;
+    *End = '\0';
+
+    for (int i = 0; i < NUM_ITEMS; i++)
+    {
+      if (strcmp(Name, Items[i].Name) == 0)
+      {
+        *(int *)((char *)Values + Items[i].Offset) = atoi(Equals + 1);
+        break;
+      }
+    }
+  }
+
+  fclose(File);
+  return TRUE;
+}
+
+// writes the settings to a temporary file and then replaces the settings file with it
+// returns TRUE on success
+static bool SaveFile
+  (
+  const settings_t *Values
+  )
+{
+  FILE *File;
+  if (fopen_s(&File, TempFilePath, "w") != 0) return FALSE;
+
+  fprintf(File, "# %s settings, written by the plugin\n", PLUGIN_NAME);
+  for (int i = 0; i < NUM_ITEMS; i++)
+  {
+    fprintf(File, "%s = %d\n", Items[i].Name, *(const int *)((const char *)Values + Items[i].Offset));
+  }
+
+  // make sure the new file is on the disk before it replaces the old one
+  bool Written = (fflush(File) == 0);
+#if IBM
+  Written = Written && (_commit(_fileno(File)) == 0);
+#else
+  Written = Written && (fsync(fileno(File)) == 0);
+#endif
+  fclose(File);
+  if (Written == FALSE) return FALSE;
+
+#if IBM
+  return MoveFileExA(TempFilePath, FilePath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  return rename(TempFilePath, FilePath) == 0;
+#endif
+}
+
+// saves the settings after they have stopped changing, runs on its own thread
+// the x-plane SDK must not be used here
+static void WriteSettings
+  (
+  void
+  )
+{
+  std::unique_lock<std::mutex> Lock(PendingLock);
+
+  while (TRUE)
+  {
+    PendingSignal.wait(Lock, [] { return HavePending || StopWriter; });
+
+    // wait for the changes to settle, unless the plugin is stopping
+    while (HavePending && (StopWriter == FALSE))
+    {
+      std::chrono::steady_clock::time_point SaveTime = LastChange + std::chrono::milliseconds(SAVE_DELAY_MS);
+      if (PendingSignal.wait_until(Lock, SaveTime) == std::cv_status::timeout) break;
+    }
+
+    if (HavePending)
+    {
+      settings_t Values = Pending;
+      HavePending = FALSE;
+
+      // the disk is only used without holding the lock
+      Lock.unlock();
+      SaveFile(&Values);
+      Lock.lock();
+    }
+
+    if (StopWriter && (HavePending == FALSE)) return;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module and loads the settings
+// returns TRUE for success, FALSE for error
+int Settings_Init
+  (
+  void
+  )
+{
+  // the preferences path is the path of a file in the preferences folder
+  char PrefsPath[MAX_FOLDER_LENGTH];
+  XPLMGetPrefsPath(PrefsPath);
+  XPLMExtractFileAndPath(PrefsPath);
+  sprintf_s(FilePath, MAX_FILE_PATH_LENGTH, "%s%s%s", PrefsPath, XPLMGetDirectorySeparator(), SETTINGS_FILE_NAME);
+  sprintf_s(TempFilePath, MAX_TEMP_FILE_PATH_LENGTH, "%s.tmp", FilePath);
+
+  // read once at the start, this is before any flying so the disk can be used here
+  Settings = Defaults;
+  bool Loaded = LoadFile(&Settings);
+
+#if DIAGNOSTIC == 1
+  Diagnostic_printf("Settings %s %s\n", Loaded ? "loaded from" : "not found, using defaults for", FilePath);
+#endif // DIAGNOSTIC
+
+  HavePending = FALSE;
+  StopWriter = FALSE;
+  Writer = std::thread(WriteSettings);
+
+  return TRUE;
+}
+
+// saves any changes and stops the writer, called when the plugin is stopped
+void Settings_Stop
+  (
+  void
+  )
+{
+  {
+    std::lock_guard<std::mutex> Lock(PendingLock);
+    StopWriter = TRUE;
+  }
+  PendingSignal.notify_one();
+
+  if (Writer.joinable()) Writer.join();
+}
+
+// gets the settings, only to be used on the sim thread
+// call Settings_Changed after changing them
+settings_t *Settings_Get
+  (
+  void
+  )
+{
+  return &Settings;
+}
+
+// saves the settings a short time after the last change, without waiting for the disk
+void Settings_Changed
+  (
+  void
+  )
+{
+  Version++;
+
+  {
+    std::lock_guard<std::mutex> Lock(PendingLock);
+    Pending = Settings;
+    HavePending = TRUE;
+    LastChange = std::chrono::steady_clock::now();
+  }
+  PendingSignal.notify_one();
+}
+
+// gets a number that changes whenever the settings are changed
+unsigned int Settings_GetVersion
+  (
+  void
+  )
+{
+  return Version;
+}
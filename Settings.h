@@ -0,0 +1,54 @@
+#ifndef _SETTINGSH_
+#define _SETTINGSH_
+
+#include "Global.h"
+
+// name of the settings file, in the x-plane preferences folder
+#define SETTINGS_FILE_NAME "XVRTools.settings"
+
+// choices the user makes in the menus, kept between sessions
+typedef struct _settings_t
+{
+  int TouchdownMotionEnabled;
+  int GroundRollEnabled;
+  int GSeatEnabled;
+  int EngineVibrationEnabled;
+  int AnnounceWhenReady;
+  int Autobrake;
+  int StatusWindowVisible;
+  int ScorecardEnabled;
+} settings_t;
+
+// initalizes the module and loads the settings
+// returns TRUE for success, FALSE for error
+extern int Settings_Init
+  (
+  void
+  );
+
+// saves any changes and stops the writer, called when the plugin is stopped
+extern void Settings_Stop
+  (
+  void
+  );
+
+// gets the settings, only to be used on the sim thread
+// call Settings_Changed after changing them
+extern settings_t *Settings_Get
+  (
+  void
+  );
+
+// saves the settings a short time after the last change, without waiting for the disk
+extern void Settings_Changed
+  (
+  void
+  );
+
+// gets a number that changes whenever the settings are changed
+extern unsigned int Settings_GetVersion
+  (
+  void
+  );
+
+#endif // _SETTINGSH_
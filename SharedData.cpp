@@ -0,0 +1,326 @@
+// SHARED DATA
+
+// Publishes the state of XVRTools as datarefs so other plugins, cockpit
+// scripts and VR overlays can show or use it
+// The modules push their state into a cached structure when it changes and
+// the dataref accessors just return the cached values, so reading our
+// datarefs costs nothing
+// Some datarefs can also be written to control the modules. Writes are
+// queued and carried out on the next flight loop so no work is done
+// inside the accessors
+
+#include "SharedData.h"
+#include "Diagnostic.h"
+#include "LandingThrottleManager.h"
+#include "ParkingBrake.h"
+#include "HeadMotion.h"
+#include "Scheduler.h"
+
+// prefix of all of our datarefs
+#define DATAREF_PREFIX "xvrtools/"
+
+// control actions that can be queued, as bits
+#define ACTION_ARM_THROTTLE_MANAGER    0x01
+#define ACTION_DISARM_THROTTLE_MANAGER 0x02
+#define ACTION_ENABLE_TOUCHDOWN        0x04
+#define ACTION_DISABLE_TOUCHDOWN       0x08
+#define ACTION_RELEASE_BRAKE           0x10
+
+// describes a published dataref
+typedef struct _published_dataref_t
+{
+  const char *Name;
+  XPLMDataTypeID Type;
+  void *Value;
+  XPLMSetDatai_f SetInt;  // NULL for read only datarefs
+} published_dataref_t;
+
+static shared_data_t Data;
+// changed whenever the state or the last landing changes, but not the timings
+static unsigned int Version;
+// actions waiting for the next flight loop
+static int PendingActions;
+static int ControlTask = -1;
+
+// prototypes for the control accessors
+static void SetThrottleManagerArm(void *inRefcon, int inValue);
+static void SetTouchdownMotion(void *inRefcon, int inValue);
+static void SetBrakeRelease(void *inRefcon, int inValue);
+
+// all of the published datarefs
+static published_dataref_t Published[] =
+{
+  {DATAREF_PREFIX "landing_throttle_manager/state",     xplmType_Int,   &Data.ThrottleManagerState, NULL},
+  {DATAREF_PREFIX "landing_throttle_manager/armed",     xplmType_Int,   &Data.ThrottleManagerArmed, NULL},
+  {DATAREF_PREFIX "landing_throttle_manager/ready",     xplmType_Int,   &Data.ThrottleManagerReady, NULL},
+  {DATAREF_PREFIX "landing_throttle_manager/failed_conditions", xplmType_Int, &Data.ThrottleManagerFailedConditions, NULL},
+  {DATAREF_PREFIX "head_motion/state",                  xplmType_Int,   &Data.HeadMotionState, NULL},
+  {DATAREF_PREFIX "head_motion/enabled",                xplmType_Int,   &Data.HeadMotionEnabled, NULL},
+  {DATAREF_PREFIX "landing/sink_rate_ms",               xplmType_Float, &Data.LastSinkRate, NULL},
+  {DATAREF_PREFIX "landing/touchdown_g",                xplmType_Float, &Data.LastTouchdownG, NULL},
+  {DATAREF_PREFIX "timing/landing_throttle_manager_us", xplmType_Float, &Data.LastTimeUs[TIMING_LANDING_THROTTLE_MANAGER], NULL},
+  {DATAREF_PREFIX "timing/landing_throttle_manager_max_us", xplmType_Float, &Data.MaxTimeUs[TIMING_LANDING_THROTTLE_MANAGER], NULL},
+  {DATAREF_PREFIX "timing/head_motion_us",              xplmType_Float, &Data.LastTimeUs[TIMING_HEAD_MOTION], NULL},
+  {DATAREF_PREFIX "timing/head_motion_max_us",          xplmType_Float, &Data.MaxTimeUs[TIMING_HEAD_MOTION], NULL},
+  {DATAREF_PREFIX "timing/head_compositor_us",          xplmType_Float, &Data.LastTimeUs[TIMING_HEAD_COMPOSITOR], NULL},
+  {DATAREF_PREFIX "timing/head_compositor_max_us",      xplmType_Float, &Data.MaxTimeUs[TIMING_HEAD_COMPOSITOR], NULL},
+  {DATAREF_PREFIX "control/landing_throttle_manager_arm", xplmType_Int, &Data.ThrottleManagerArmed, SetThrottleManagerArm},
+  {DATAREF_PREFIX "control/touchdown_motion_enable",    xplmType_Int,   &Data.HeadMotionEnabled, SetTouchdownMotion},
+  {DATAREF_PREFIX "control/parking_brake_release",      xplmType_Int,   &Data.BrakeReleasePending, SetBrakeRelease},
+};
+
+#define NUM_PUBLISHED (int)(sizeof(Published) / sizeof(published_dataref_t))
+
+// handles of the registered datarefs
+static XPLMDataRef PublishedRefs[NUM_PUBLISHED];
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// reads an integer dataref
+static int GetInt
+  (
+  void *inRefcon  // pointer to the cached value
+  )
+{
+  return *(int *)inRefcon;
+}
+
+// reads a float dataref
+static float GetFloat
+  (
+  void *inRefcon  // pointer to the cached value
+  )
+{
+  return *(float *)inRefcon;
+}
+
+// queues an action for the next flight loop
+static void QueueAction
+  (
+  int Action,    // action to add
+  int Cancelled  // opposite action that is no longer wanted
+  )
+{
+  PendingActions = (PendingActions & ~Cancelled) | Action;
+  Scheduler_Schedule(ControlTask, -1.0f);
+}
+
+// writes to the throttle manager arm dataref, 1 to arm, 0 to disarm
+static void SetThrottleManagerArm
+  (
+  void *inRefcon,
+  int inValue
+  )
+{
+  if (inValue)
+  {
+    QueueAction(ACTION_ARM_THROTTLE_MANAGER, ACTION_DISARM_THROTTLE_MANAGER);
+  }
+  else
+  {
+    QueueAction(ACTION_DISARM_THROTTLE_MANAGER, ACTION_ARM_THROTTLE_MANAGER);
+  }
+}
+
+// writes to the touch down motion dataref, 1 to enable, 0 to disable
+static void SetTouchdownMotion
+  (
+  void *inRefcon,
+  int inValue
+  )
+{
+  if (inValue)
+  {
+    QueueAction(ACTION_ENABLE_TOUCHDOWN, ACTION_DISABLE_TOUCHDOWN);
+  }
+  else
+  {
+    QueueAction(ACTION_DISABLE_TOUCHDOWN, ACTION_ENABLE_TOUCHDOWN);
+  }
+}
+
+// writes to the brake release dataref, non-zero to release the brake
+static void SetBrakeRelease
+  (
+  void *inRefcon,
+  int inValue
+  )
+{
+  if (inValue)
+  {
+    Data.BrakeReleasePending = 1;
+    QueueAction(ACTION_RELEASE_BRAKE, 0);
+  }
+}
+
+// carries out the queued actions, called by x-plane on the frame after a write
+// returns 0 so it is only run again when there is another write
+static float RunActions
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  int Actions = PendingActions;
+  PendingActions = 0;
+
+  if (Actions & ACTION_ARM_THROTTLE_MANAGER)    LandingThrottleManager_Arm();
+  if (Actions & ACTION_DISARM_THROTTLE_MANAGER) LandingThrottleManager_Disarm();
+  if (Actions & ACTION_ENABLE_TOUCHDOWN)        HeadMotion_SetEnabled(TRUE);
+  if (Actions & ACTION_DISABLE_TOUCHDOWN)       HeadMotion_SetEnabled(FALSE);
+  if (Actions & ACTION_RELEASE_BRAKE)
+  {
+    ParkingBrake_Release();
+    Data.BrakeReleasePending = 0;
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int SharedData_Init
+  (
+  void
+  )
+{
+  memset(&Data, 0, sizeof(Data));
+  Version = 0;
+  PendingActions = 0;
+
+  // task for the control actions, only scheduled when there is a write
+  ControlTask = Scheduler_AddTask(RunActions, SCHEDULER_NOT_PROFILED, 0);
+
+  for (int d = 0; d < NUM_PUBLISHED; d++)
+  {
+    PublishedRefs[d] = XPLMRegisterDataAccessor(
+      Published[d].Name,
+      Published[d].Type,
+      Published[d].SetInt != NULL,                         // writable
+      Published[d].Type == xplmType_Int ? GetInt : NULL,   // int
+      Published[d].SetInt,
+      Published[d].Type == xplmType_Float ? GetFloat : NULL, // float
+      NULL,
+      NULL, NULL,                                          // double
+      NULL, NULL,                                          // int array
+      NULL, NULL,                                          // float array
+      NULL, NULL,                                          // data
+      Published[d].Value,
+      NULL);
+
+    if (PublishedRefs[d] == NULL)
+    {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+// removes the published data, called when the plugin is stopped
+void SharedData_Stop
+  (
+  void
+  )
+{
+  for (int d = 0; d < NUM_PUBLISHED; d++)
+  {
+    if (PublishedRefs[d] != NULL)
+    {
+      XPLMUnregisterDataAccessor(PublishedRefs[d]);
+      PublishedRefs[d] = NULL;
+    }
+  }
+}
+
+// publishes the state of the landing throttle manager
+void SharedData_SetThrottleManagerState
+  (
+  int State,  // state machine state
+  int Armed,  // TRUE if the manager is armed
+  int Ready   // TRUE if the aircraft is supported
+  )
+{
+  if ((State == Data.ThrottleManagerState) && (Armed == Data.ThrottleManagerArmed) && (Ready == Data.ThrottleManagerReady)) return;
+
+  Data.ThrottleManagerState = State;
+  Data.ThrottleManagerArmed = Armed;
+  Data.ThrottleManagerReady = Ready;
+  Version++;
+}
+
+// publishes the conditions that stop the landing throttle manager being armed
+void SharedData_SetThrottleManagerConditions
+  (
+  int FailedConditions  // CONDITION_ bits of the conditions that are not met
+  )
+{
+  if (FailedConditions == Data.ThrottleManagerFailedConditions) return;
+
+  Data.ThrottleManagerFailedConditions = FailedConditions;
+  Version++;
+}
+
+// publishes the state of the touch down head motion
+void SharedData_SetHeadMotionState
+  (
+  int State,   // state machine state
+  int Enabled  // TRUE if touch down motion is enabled
+  )
+{
+  if ((State == Data.HeadMotionState) && (Enabled == Data.HeadMotionEnabled)) return;
+
+  Data.HeadMotionState = State;
+  Data.HeadMotionEnabled = Enabled;
+  Version++;
+}
+
+// publishes the details of the last landing
+void SharedData_SetLanding
+  (
+  float SinkRate,  // vertical speed at touch down in m/s
+  float G          // normal load at touch down in g
+  )
+{
+  Data.LastSinkRate = SinkRate;
+  Data.LastTouchdownG = G;
+  Data.HaveLanded = TRUE;
+  Version++;
+}
+
+// records how long some code took to execute
+void SharedData_RecordTiming
+  (
+  shared_timing_t Timing,
+  double Seconds
+  )
+{
+  float Us = (float)(Seconds * 1000000.0);
+
+  Data.LastTimeUs[Timing] = Us;
+  if (Us > Data.MaxTimeUs[Timing]) Data.MaxTimeUs[Timing] = Us;
+}
+
+// gets everything that is published
+const shared_data_t *SharedData_Get
+  (
+  void
+  )
+{
+  return &Data;
+}
+
+// gets a number that changes whenever the state or the last landing changes
+unsigned int SharedData_GetVersion
+  (
+  void
+  )
+{
+  return Version;
+}
@@ -0,0 +1,93 @@
+#ifndef _SHAREDDATAH_
+#define _SHAREDDATAH_
+
+#include "Global.h"
+
+// code that has its execution time published
+typedef enum _shared_timing_t
+{
+  TIMING_LANDING_THROTTLE_MANAGER,
+  TIMING_HEAD_MOTION,
+  TIMING_HEAD_COMPOSITOR,
+  NUM_TIMINGS
+} shared_timing_t;
+
+// everything that is published
+typedef struct _shared_data_t
+{
+  int   ThrottleManagerState;
+  int   ThrottleManagerArmed;
+  int   ThrottleManagerReady;
+  int   ThrottleManagerFailedConditions;
+  int   HeadMotionState;
+  int   HeadMotionEnabled;
+  int   HaveLanded;
+  float LastSinkRate;
+  float LastTouchdownG;
+  float LastTimeUs[NUM_TIMINGS];
+  float MaxTimeUs[NUM_TIMINGS];
+  int   BrakeReleasePending;
+} shared_data_t;
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int SharedData_Init
+  (
+  void
+  );
+
+// removes the published data, called when the plugin is stopped
+extern void SharedData_Stop
+  (
+  void
+  );
+
+// publishes the state of the landing throttle manager
+extern void SharedData_SetThrottleManagerState
+  (
+  int State,  // state machine state
+  int Armed,  // TRUE if the manager is armed
+  int Ready   // TRUE if the aircraft is supported
+  );
+
+// publishes the conditions that stop the landing throttle manager being armed
+extern void SharedData_SetThrottleManagerConditions
+  (
+  int FailedConditions  // CONDITION_ bits of the conditions that are not met
+  );
+
+// publishes the state of the touch down head motion
+extern void SharedData_SetHeadMotionState
+  (
+  int State,   // state machine state
+  int Enabled  // TRUE if touch down motion is enabled
+  );
+
+// publishes the details of the last landing
+extern void SharedData_SetLanding
+  (
+  float SinkRate,  // vertical speed at touch down in m/s
+  float G          // normal load at touch down in g
+  );
+
+// records how long some code took to execute
+extern void SharedData_RecordTiming
+  (
+  shared_timing_t Timing,
+  double Seconds
+  );
+
+// gets everything that is published
+extern const shared_data_t *SharedData_Get
+  (
+  void
+  );
+
+// gets a number that changes whenever the state or the last landing changes
+// so anything showing the state only needs updating when it is different
+extern unsigned int SharedData_GetVersion
+  (
+  void
+  );
+
+#endif // _SHAREDDATAH_
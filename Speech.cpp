@@ -0,0 +1,251 @@
+// SPEECH
+
+// Speaks phrases for all of the modules so they don't talk over each other
+// Phrases are put in a small fixed size queue and the most important one is
+// spoken first. A phrase that is already waiting, or was spoken in the last
+// few seconds, is dropped so pressing a button repeatedly doesn't repeat the
+// same phrase, and phrases are spaced out so there is never a stream of them
+// during a busy landing
+// Each different phrase is copied once into a pool, after that the pool copy
+// is used so phrases can be compared by pointer and nothing is allocated
+
+#include "Speech.h"
+#include "Diagnostic.h"
+#include "Profile.h"
+#include "Scheduler.h"
+#include "Clock.h"
+
+// configuration section
+// time in seconds in which the same phrase is not spoken again
+#define DEDUPLICATION_WINDOW 3.0f
+// shortest time in seconds between the start of two phrases
+#define MIN_SPEECH_INTERVAL 1.5f
+
+// maximum number of phrases waiting to be spoken
+#define QUEUE_SIZE 8
+// maximum number of different phrases and the space for all of their text
+#define MAX_PHRASES 32
+#define PHRASE_POOL_SIZE 1024
+
+// a phrase that has been used
+typedef struct _phrase_t
+{
+  unsigned int Hash;
+  const char *Text;     // copy in the pool
+  double LastSpoken;    // time it was last spoken, or queued to be spoken
+} phrase_t;
+
+// a phrase waiting to be spoken
+typedef struct _queued_phrase_t
+{
+  phrase_t *Phrase;
+  speech_priority_t Priority;
+  unsigned int Sequence;  // order in which phrases were queued
+} queued_phrase_t;
+
+static char PhrasePool[PHRASE_POOL_SIZE];
+static int PhrasePoolUsed;
+static phrase_t Phrases[MAX_PHRASES];
+static int NumPhrases;
+
+static queued_phrase_t Queue[QUEUE_SIZE];
+static int QueueLength;
+static unsigned int NextSequence;
+// time the last phrase was spoken
+static double LastSpeechTime;
+
+static int SpeechTask = -1;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// calculates a hash of a phrase (FNV-1a)
+static unsigned int HashPhrase
+  (
+  const char *Text
+  )
+{
+  unsigned int Hash = 2166136261u;
+  while (*Text)
+  {
+    Hash = (Hash ^ (unsigned char)*Text++) * 16777619u;
+  }
+  return Hash;
+}
+
+// finds a phrase, adding it to the pool the first time it is used
+// returns the phrase or NULL if the pool is full
+static phrase_t *InternPhrase
+  (
+  const char *Text
+  )
+{
+  unsigned int Hash = HashPhrase(Text);
+
+  for (int p = 0; p < NumPhrases; p++)
+  {
+    if ((Phrases[p].Hash == Hash) && (strcmp(Phrases[p].Text, Text) == 0)) return &Phrases[p];
+  }
+
+  int Length = (int)strlen(Text) + 1;
+  if ((NumPhrases >= MAX_PHRASES) || (PhrasePoolUsed + Length > PHRASE_POOL_SIZE))
+  {
+#if DIAGNOSTIC == 1
+    Diagnostic_printf("No space for phrase '%s'\n", Text);
+#endif // DIAGNOSTIC
+    return NULL;
+  }
+
+  char *Copy = &PhrasePool[PhrasePoolUsed];
+  memcpy(Copy, Text, Length);
+  PhrasePoolUsed += Length;
+
+  phrase_t *Phrase = &Phrases[NumPhrases++];
+  Phrase->Hash = Hash;
+  Phrase->Text = Copy;
+  Phrase->LastSpoken = -DEDUPLICATION_WINDOW;
+  return Phrase;
+}
+
+// finds the phrase that should be spoken next, the most important and then the oldest
+// returns the index in the queue
+static int NextInQueue
+  (
+  void
+  )
+{
+  int Best = 0;
+  for (int q = 1; q < QueueLength; q++)
+  {
+    if ((Queue[q].Priority > Queue[Best].Priority) ||
+      ((Queue[q].Priority == Queue[Best].Priority) && ((int)(Queue[q].Sequence - Queue[Best].Sequence) < 0)))
+    {
+      Best = q;
+    }
+  }
+  return Best;
+}
+
+// removes a phrase from the queue
+static void RemoveFromQueue
+  (
+  int Index
+  )
+{
+  Queue[Index] = Queue[--QueueLength];
+}
+
+// speaks the next phrase, called by x-plane when there is something to say
+// returns the time to the next execution, or 0 when the queue is empty
+static float SpeakNext
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  if (QueueLength == 0) return 0;
+
+  double Now = Clock_Get(CLOCK_WALL);
+  float Wait = (float)(LastSpeechTime + MIN_SPEECH_INTERVAL - Now);
+  if (Wait > 0) return Wait;
+
+  int Next = NextInQueue();
+  XPLMSpeakString(Queue[Next].Phrase->Text);
+  Queue[Next].Phrase->LastSpoken = Now;
+  LastSpeechTime = Now;
+  RemoveFromQueue(Next);
+
+  if (QueueLength == 0) return 0;
+  return MIN_SPEECH_INTERVAL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int Speech_Init
+  (
+  void
+  )
+{
+  PhrasePoolUsed = 0;
+  NumPhrases = 0;
+  QueueLength = 0;
+  NextSequence = 0;
+  LastSpeechTime = -MIN_SPEECH_INTERVAL;
+
+  // only scheduled while there is something to say
+  SpeechTask = Scheduler_AddTask(SpeakNext, PROFILE_SPEECH, 0);
+
+  return TRUE;
+}
+
+// queues a phrase to be spoken
+// the phrase is dropped if it is already waiting or was spoken very recently
+void Speech_Say
+  (
+  const char *Phrase,          // text to speak, copied the first time it is used
+  speech_priority_t Priority
+  )
+{
+  if ((Phrase == NULL) || (Phrase[0] == '\0')) return;
+
+  phrase_t *Interned = InternPhrase(Phrase);
+  if (Interned == NULL) return;
+
+  // already waiting, just make sure it is spoken as soon as it needs to be
+  for (int q = 0; q < QueueLength; q++)
+  {
+    if (Queue[q].Phrase == Interned)
+    {
+      if (Priority > Queue[q].Priority) Queue[q].Priority = Priority;
+      return;
+    }
+  }
+
+  double Now = Clock_Get(CLOCK_WALL);
+  if (Now - Interned->LastSpoken < DEDUPLICATION_WINDOW) return;
+
+  // queue is full, make space by dropping the least important phrase if this one matters more
+  if (QueueLength == QUEUE_SIZE)
+  {
+    int Lowest = 0;
+    for (int q = 1; q < QueueLength; q++)
+    {
+      if (Queue[q].Priority < Queue[Lowest].Priority) Lowest = q;
+    }
+    if (Queue[Lowest].Priority >= Priority)
+    {
+#if DIAGNOSTIC == 1
+      Diagnostic_printf("Speech queue full, dropped '%s'\n", Interned->Text);
+#endif // DIAGNOSTIC
+      return;
+    }
+    RemoveFromQueue(Lowest);
+  }
+
+  Queue[QueueLength].Phrase = Interned;
+  Queue[QueueLength].Priority = Priority;
+  Queue[QueueLength].Sequence = NextSequence++;
+  QueueLength++;
+
+  Scheduler_Schedule(SpeechTask, -1.0f);
+}
+
+// called when an event is published, see Events.cpp
+void Speech_HandleEvent
+  (
+  const event_t *Event
+  )
+{
+  // nothing waiting is relevant to a new flight, or after being disabled
+  if ((Event->Type == EVENT_SESSION_RESET) || (Event->Type == EVENT_PLUGIN_DISABLED))
+  {
+    QueueLength = 0;
+    Scheduler_Schedule(SpeechTask, 0);
+  }
+}
@@ -0,0 +1,36 @@
+#ifndef _SPEECHH_
+#define _SPEECHH_
+
+#include "Global.h"
+#include "Events.h"
+
+// importance of a phrase, more important phrases are spoken first
+typedef enum _speech_priority_t
+{
+  SPEECH_PRIORITY_LOW,     // confirmations, e.g. brake released
+  SPEECH_PRIORITY_NORMAL,  // replies to the user, e.g. already enabled
+  SPEECH_PRIORITY_HIGH     // problems the user needs to know about
+} speech_priority_t;
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int Speech_Init
+  (
+  void
+  );
+
+// queues a phrase to be spoken
+// the phrase is dropped if it is already waiting or was spoken very recently
+extern void Speech_Say
+  (
+  const char *Phrase,          // text to speak, copied the first time it is used
+  speech_priority_t Priority
+  );
+
+// called when an event is published, see Events.cpp
+extern void Speech_HandleEvent
+  (
+  const event_t *Event
+  );
+
+#endif // _SPEECHH_
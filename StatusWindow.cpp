@@ -0,0 +1,253 @@
+// STATUS WINDOW
+
+// Shows what each module is doing and the last landing in a small window,
+// so it can be seen in VR where there is no Log.txt and the menus only show
+// check marks
+// X-plane doesn't say when the window is closed with its close button, so
+// while it is shown it is checked now and then to keep the menu and the
+// settings in step
+// The text is laid out into a list of lines only when the published state
+// or the settings change. Drawing the window, which x-plane does every
+// frame, just draws the lines that were laid out. Laying out doesn't use the
+// x-plane SDK so it can be checked without the sim
+
+#include "StatusWindow.h"
+#include "TextWindow.h"
+#include "Diagnostic.h"
+#include "SharedData.h"
+#include "Settings.h"
+#include "Scheduler.h"
+#include "LandingThrottleManager.h"
+
+#define MODULE_NAME "Status Window"
+
+// menu item IDs
+#define MENU_ITEM_ID_SHOW 1
+
+// size of the window in boxels and its position on the monitor
+#define WINDOW_WIDTH  320
+#define WINDOW_HEIGHT 180
+#define WINDOW_X      50
+#define WINDOW_Y      150
+
+// seconds between checks that the window hasn't been closed with its close button
+#define CLOSE_CHECK_INTERVAL 0.5f
+
+// sink rate in m/s above which a landing is shown as hard
+#define HARD_LANDING_SINK_RATE 2.0f
+#define MS_TO_FPM 196.85f
+
+// what is shown for each condition that is not met, in bit order
+static const char *ConditionNames[NUM_CONDITIONS] =
+{
+  "airspeed",
+  "flaps",
+  "gear",
+  "altitude"
+};
+
+// what is shown for each autobrake setting
+static const char *AutobrakeNames[] =
+{
+  "off",
+  "low",
+  "medium",
+  "high"
+};
+
+static text_window_t Window;
+static XPLMMenuID myMenu;
+static int MenuItem_Show;
+static int CloseCheckTask;
+
+// versions of the state and settings the text was laid out for
+static bool LayoutValid = FALSE;
+static unsigned int LayoutDataVersion;
+static unsigned int LayoutSettingsVersion;
+
+// prototype for the function that handles menu choices
+static void	MenuHandlerCallback(void *inMenuRef, void *inItemRef);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// lays out the text for the state and settings
+static void BuildLayout
+  (
+  const shared_data_t *Data,
+  const settings_t *Settings
+  )
+{
+  TextWindow_Clear(&Window);
+
+  // landing throttle manager
+  if (Data->ThrottleManagerReady == FALSE)
+  {
+    TextWindow_AddLine(&Window, 0, TRUE, "Throttle manager: aircraft not supported");
+  }
+  else if (Data->ThrottleManagerArmed)
+  {
+    TextWindow_AddLine(&Window, 0, FALSE, "Throttle manager: armed");
+  }
+  else
+  {
+    TextWindow_AddLine(&Window, 0, FALSE, "Throttle manager: off");
+
+    if (Data->ThrottleManagerFailedConditions != 0)
+    {
+      char Conditions[TEXT_WINDOW_MAX_LINE_LENGTH] = "";
+      for (int c = 0; c < NUM_CONDITIONS; c++)
+      {
+        if ((Data->ThrottleManagerFailedConditions & (1 << c)) == 0) continue;
+        if (Conditions[0] != '\0') strcat_s(Conditions, TEXT_WINDOW_MAX_LINE_LENGTH, ", ");
+        strcat_s(Conditions, TEXT_WINDOW_MAX_LINE_LENGTH, ConditionNames[c]);
+      }
+      TextWindow_AddLine(&Window, TEXT_WINDOW_INDENT, TRUE, "Not ready: %s", Conditions);
+    }
+    else
+    {
+      TextWindow_AddLine(&Window, TEXT_WINDOW_INDENT, FALSE, "Ready to arm");
+    }
+  }
+
+  // motion and rollout
+  int Autobrake = Settings->Autobrake;
+  if ((Autobrake < 0) || (Autobrake >= (int)(sizeof(AutobrakeNames) / sizeof(AutobrakeNames[0])))) Autobrake = 0;
+
+  TextWindow_AddLine(&Window, 0, FALSE, "Autobrake: %s", AutobrakeNames[Autobrake]);
+  TextWindow_AddLine(&Window, 0, FALSE, "Touch down motion: %s", Data->HeadMotionEnabled ? "on" : "off");
+  TextWindow_AddLine(&Window, 0, FALSE, "Ground roll: %s", Settings->GroundRollEnabled ? "on" : "off");
+  TextWindow_AddLine(&Window, 0, FALSE, "G-seat: %s", Settings->GSeatEnabled ? "on" : "off");
+  TextWindow_AddLine(&Window, 0, FALSE, "Engine vibration: %s", Settings->EngineVibrationEnabled ? "on" : "off");
+
+  // last landing
+  if (Data->HaveLanded)
+  {
+    TextWindow_AddLine(&Window, 0, Data->LastSinkRate > HARD_LANDING_SINK_RATE, "Last landing: %.1f m/s (%.0f fpm), %.2f G",
+      Data->LastSinkRate, Data->LastSinkRate * MS_TO_FPM, Data->LastTouchdownG);
+  }
+  else
+  {
+    TextWindow_AddLine(&Window, 0, FALSE, "Last landing: none yet");
+  }
+}
+
+// lays out the text again if the state or the settings have changed
+static void UpdateLayout
+  (
+  void
+  )
+{
+  unsigned int DataVersion = SharedData_GetVersion();
+  unsigned int SettingsVersion = Settings_GetVersion();
+
+  if (LayoutValid && (DataVersion == LayoutDataVersion) && (SettingsVersion == LayoutSettingsVersion)) return;
+
+  BuildLayout(SharedData_Get(), Settings_Get());
+  LayoutDataVersion = DataVersion;
+  LayoutSettingsVersion = SettingsVersion;
+  LayoutValid = TRUE;
+}
+
+// updates the menu check mark
+static void UpdateMenu
+  (
+  bool Visible
+  )
+{
+  XPLMCheckMenuItem(myMenu, MenuItem_Show, Visible ? xplm_Menu_Checked : xplm_Menu_Unchecked);
+}
+
+// notices the window being closed with its close button, called periodically while it is shown
+// returns the number of seconds to the next execution
+static float CheckClosed
+  (
+  float elapsedMe,
+  float elapsedSim,
+  int counter,
+  void *refcon
+  )
+{
+  if (TextWindow_IsVisible(&Window)) return CLOSE_CHECK_INTERVAL;
+
+  StatusWindow_SetVisible(FALSE);
+  return 0;
+}
+
+// called when the user chooses a menu item
+static void MenuHandlerCallback
+(
+  void *inMenuRef,
+  void *inItemRef
+)
+{
+  // user chose to show or hide the window, it may have been closed with its close button
+  if ((intptr_t)inItemRef == MENU_ITEM_ID_SHOW)
+  {
+    StatusWindow_SetVisible(TextWindow_IsVisible(&Window) == FALSE);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+int StatusWindow_Init
+  (
+  XPLMMenuID ParentMenuId
+  )
+{
+  int mySubMenuItem = XPLMAppendMenuItem(
+    ParentMenuId,
+    MODULE_NAME,
+    0,
+    1);
+
+  myMenu = XPLMCreateMenu(
+    MODULE_NAME,
+    ParentMenuId,
+    mySubMenuItem,
+    MenuHandlerCallback,
+    0
+  );
+
+  // Append menu items to our submenu
+  MenuItem_Show = XPLMAppendMenuItem(
+    myMenu,
+    "Show",
+    (void *)MENU_ITEM_ID_SHOW,
+    1);
+
+  // the text is laid out again before drawing when the state has changed
+  if (!TextWindow_Create(&Window, WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_X, WINDOW_Y, FALSE, UpdateLayout))
+  {
+    return FALSE;
+  }
+
+  CloseCheckTask = Scheduler_AddTask(CheckClosed, SCHEDULER_NOT_PROFILED, 0);
+
+  LayoutValid = FALSE;
+  StatusWindow_SetVisible(Settings_Get()->StatusWindowVisible);
+
+  return TRUE;
+}
+
+// shows or hides the status window
+void StatusWindow_SetVisible
+  (
+  bool Visible  // TRUE to show
+  )
+{
+  TextWindow_SetVisible(&Window, Visible);
+  UpdateMenu(Visible);
+  Scheduler_Schedule(CloseCheckTask, Visible ? CLOSE_CHECK_INTERVAL : 0);
+
+  if (Settings_Get()->StatusWindowVisible != (int)Visible)
+  {
+    Settings_Get()->StatusWindowVisible = Visible;
+    Settings_Changed();
+  }
+}
+
@@ -0,0 +1,19 @@
+#ifndef _STATUSWINDOWH_
+#define _STATUSWINDOWH_
+
+#include "Global.h"
+
+// initalizes the module
+// returns TRUE for success, FALSE for error
+extern int StatusWindow_Init
+  (
+  XPLMMenuID ParentMenuId
+  );
+
+// shows or hides the status window
+extern void StatusWindow_SetVisible
+  (
+  bool Visible  // TRUE to show
+  );
+
+#endif // _STATUSWINDOWH_
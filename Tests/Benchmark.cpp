@@ -0,0 +1,933 @@
+// BENCHMARK
+
+// Measures the plugin against the stub and writes the results as JSON to
+// stdout:
+//   - the time, memory allocations and cache misses of one call of the
+//     plugin's hot paths: diagnostic output, head position reads, message
+//     fan-out, aircraft detection and the g-seat washout filter step
+//   - one step of every state of the landing throttle manager and head
+//     motion state machines, over a number of landings
+//   - a frame of the engine vibration with eight engines running, the
+//     benchmark fails if it takes longer than its budget
+//   - a scripted flight at 90 Hz from take off to the end of the rollout
+//     with every module turned on: the plugin's CPU time per frame, how it
+//     is spread for the whole flight and each phase, and the slowest frame
+//     with the phase and states it ran in
+//   - the cost of a frame with the plugin enabled and disabled, the benchmark
+//     fails if the disabled plugin makes any SDK call, has a flight loop
+//     called, or leaves a command handler or window behind
+// Times of code that can't be called on its own (aircraft detection, the
+// state machine steps and the engine vibration) come from the plugin's
+// profiling. Their allocations
+// and cache misses are for the message or frame that ran them, so include
+// everything else the plugin did then
+// Allocations are counted by replacing malloc. Cache misses are counted with
+// the Linux performance counters and are null where they can't be used
+// Usage: Benchmark
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "XPLMStub.h"
+#include "FlightModel.h"
+#include "Diagnostic.h"
+#include "HeadBaseline.h"
+#include "GSeat.h"
+#include "Profile.h"
+#include "Timing.h"
+
+// configuration section
+// length of a frame, in seconds
+#define FRAME_TIME (1.0f / 90.0f)
+// number of calls of each operation that are measured
+#define NUM_OPERATIONS 100000
+// number of aircraft loads that are measured, they are slower
+#define NUM_AIRCRAFT_LOADS 10000
+// number of landings flown to measure the state machines
+#define NUM_LANDINGS 5
+// longest time to wait for a landing to finish, in seconds
+#define MAX_LANDING_TIME 180.0
+// height the scripted flight cruises at, in m
+#define CRUISE_ALTITUDE 1500.0f
+// time the scripted flight cruises for, in seconds
+#define CRUISE_TIME 120.0
+// height the scripted flight flares at, in m
+#define FLARE_ALTITUDE 15.0f
+// time from touch down to the start of the rollout, in seconds
+#define TOUCHDOWN_TIME 3.0
+// most frames the scripted flight can take
+#define MAX_FLIGHT_FRAMES (90 * 60 * 30)
+// number of frames run with the plugin enabled and then disabled
+#define NUM_IDLE_FRAMES (90 * 60)
+// time available to draw one frame on a 90 Hz headset, in ns
+#define FRAME_BUDGET_NS (1000000000.0 / 90.0)
+// number of engines and frames the engine vibration is measured with
+#define NUM_VIBRATION_ENGINES 8
+#define NUM_VIBRATION_FRAMES (90 * 60)
+// time the engine vibration may take in a frame with every engine running, in ns
+#define ENGINE_VIBRATION_BUDGET_NS 1000.0
+
+// states of the landing throttle manager, see LandingThrottleManager.cpp
+#define LTM_WAIT_FOR_USER           0
+#define LTM_WAIT_FOR_END_OF_ROLLOUT 7
+#define NUM_LTM_STATES              8
+// states of the head motion, see HeadMotion.cpp
+#define HEAD_WAIT_FOR_FLYING 1
+#define NUM_HEAD_STATES      7
+
+// counters read before and after the code that is measured
+typedef struct _counters_t
+{
+  double Ns;
+  unsigned long long Allocations;
+  long long CacheMisses;
+} counters_t;
+
+// totals of the frames that ran in one state
+typedef struct _state_totals_t
+{
+  unsigned long long Frames;
+  unsigned long long Allocations;
+  long long CacheMisses;
+} state_totals_t;
+
+// phases of the scripted flight
+typedef enum _phase_t
+{
+  PHASE_TAKEOFF,
+  PHASE_CLIMB,
+  PHASE_CRUISE,
+  PHASE_APPROACH,
+  PHASE_FLARE,
+  PHASE_TOUCHDOWN,
+  PHASE_ROLLOUT,
+  NUM_PHASES
+} phase_t;
+
+// one frame of the scripted flight
+typedef struct _frame_t
+{
+  double Ns;      // CPU time of the plugin
+  phase_t Phase;
+  int LtmState;   // states the frame started in
+  int HeadState;
+} frame_t;
+
+// the scripted flight
+typedef struct _flight_t
+{
+  frame_t Frames[MAX_FLIGHT_FRAMES];
+  int NumFrames;
+  phase_t Phase;
+  bool ReachedRollout;  // TRUE once the throttle manager has waited for the end of the rollout
+} flight_t;
+
+// aircraft descriptions that are detected, from the first known aircraft to none
+static const char *AircraftDescriptions[][2] =
+{
+  {"detect_aircraft_first",        "X-Crafts ERJ 175"},
+  {"detect_aircraft_last",         "Boeing 737-800"},
+  {"detect_aircraft_unknown",      "Cessna 172 SP"},
+  {"detect_aircraft_long_unknown", "Experimental homebuilt aircraft with a very long description that "
+                                   "has to be searched all the way to the end for every known aircraft "
+                                   "before it can be found not to be one of them, as some third party "
+                                   "aircraft have descriptions nearly this long"},
+};
+
+// names of the states, in the same order as the state machines
+static const char *LtmStateNames[NUM_LTM_STATES] =
+{
+  "wait_for_user", "start", "throttle_down", "wait_for_idle_throttle",
+  "wait_for_touchdown", "apply_reverse", "wait_for_end_of_reverse", "wait_for_end_of_rollout"
+};
+static const char *HeadStateNames[NUM_HEAD_STATES] =
+{
+  "start", "wait_for_flying", "wait_for_landing", "touchdown",
+  "move_up", "restoring_position", "wait_for_nose"
+};
+static const char *PhaseNames[NUM_PHASES] =
+{
+  "takeoff", "climb", "cruise", "approach", "flare", "touchdown", "rollout"
+};
+
+// only allocations made by the benchmark's thread are counted, not the plugin's file watchers
+static pthread_t MainThread;
+static bool CountAllocations = FALSE;
+static unsigned long long NumAllocations;
+
+// performance counter for cache misses, -1 if there isn't one
+static int CacheMissCounter = -1;
+
+// FALSE once a result has been written, for the commas between them
+static bool FirstResult = TRUE;
+
+// used by the head position benchmark so the reads aren't optimized away
+static volatile float HeadPositionSum;
+
+// frames stepped by the g-seat filter benchmark, so each step is given a different load
+static int GSeatStep;
+
+static flight_t Flight;
+
+// the allocator that malloc is replaced with, from glibc
+extern "C" void *__libc_malloc(size_t Size);
+extern "C" void *__libc_calloc(size_t Count, size_t Size);
+extern "C" void *__libc_realloc(void *Pointer, size_t Size);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// counts an allocation made by the benchmark's thread
+static inline void CountAllocation
+  (
+  void
+  )
+{
+  if (CountAllocations && pthread_equal(pthread_self(), MainThread)) NumAllocations++;
+}
+
+// opens the performance counter for cache misses of this thread
+// returns the counter, or -1 if the computer or its settings don't allow it
+static int OpenCacheMissCounter
+  (
+  void
+  )
+{
+  struct perf_event_attr Attributes;
+  memset(&Attributes, 0, sizeof(Attributes));
+  Attributes.type = PERF_TYPE_HARDWARE;
+  Attributes.size = sizeof(Attributes);
+  Attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+  Attributes.exclude_kernel = 1;
+  Attributes.exclude_hv = 1;
+
+  return (int)syscall(SYS_perf_event_open, &Attributes, 0, -1, -1, 0);
+}
+
+// reads all of the counters
+static void ReadCounters
+  (
+  counters_t *Counters
+  )
+{
+  Counters->Allocations = NumAllocations;
+  Counters->CacheMisses = 0;
+  if (CacheMissCounter >= 0)
+  {
+    if (read(CacheMissCounter, &Counters->CacheMisses, sizeof(Counters->CacheMisses)) != sizeof(Counters->CacheMisses))
+    {
+      Counters->CacheMisses = 0;
+    }
+  }
+  Counters->Ns = Timing_GetTime() * 1000000000.0;
+}
+
+// writes a value per operation, or null if it wasn't counted
+static void WritePerOperation
+  (
+  const char *Name,
+  double Total,
+  unsigned long long Count,
+  bool Counted
+  )
+{
+  if (Counted && (Count > 0)) printf(", \"%s\": %.3f", Name, Total / Count);
+  else printf(", \"%s\": null", Name);
+}
+
+// starts a result, the caller finishes it with its own members and a }
+static void StartResult
+  (
+  const char *Name,
+  unsigned long long Count,
+  double MeanNs
+  )
+{
+  printf("%s\n    {\"name\": \"%s\", \"count\": %llu, \"ns_per_op\": %.1f", FirstResult ? "" : ",", Name, Count, MeanNs);
+  FirstResult = FALSE;
+}
+
+// writes the result of an operation
+static void WriteResult
+  (
+  const char *Name,
+  unsigned long long Count,
+  double MeanNs,            // time of one operation
+  const counters_t *Start,  // counters before the operations
+  const counters_t *End     // counters after the operations
+  )
+{
+  StartResult(Name, Count, MeanNs);
+  WritePerOperation("allocations_per_op", (double)(End->Allocations - Start->Allocations), Count, TRUE);
+  WritePerOperation("cache_misses_per_op", (double)(End->CacheMisses - Start->CacheMisses), Count, CacheMissCounter >= 0);
+  printf("}");
+}
+
+// measures an operation by calling it many times
+static void MeasureOperation
+  (
+  const char *Name,
+  void (*Operation)(void),
+  int Count
+  )
+{
+  counters_t Start, End;
+
+  // the first call can find datarefs and fill caches
+  Operation();
+
+  ReadCounters(&Start);
+  for (int i = 0; i < Count; i++) Operation();
+  ReadCounters(&End);
+
+  WriteResult(Name, Count, (End.Ns - Start.Ns) / Count, &Start, &End);
+}
+
+// writes a line to Log.txt, as the modules do
+static void PrintDiagnostic
+  (
+  void
+  )
+{
+  static char Format[] = "Benchmark value = %d\n";
+  Diagnostic_printf(Format, 42);
+}
+
+// reads the neutral head position, as the head motion does
+static void ReadHeadPosition
+  (
+  void
+  )
+{
+  float Sum = 0;
+  for (int Axis = HEAD_X; Axis < NUM_HEAD_AXES; Axis++) Sum += HeadBaseline_GetAxis((head_axis_t)Axis);
+  HeadPositionSum = Sum;
+}
+
+// steps the g-seat washout filters with a load that changes every frame, as in a turn
+// the g-seat is still off, so this doesn't move the head
+static void StepGSeatFilters
+  (
+  void
+  )
+{
+  float Load[NUM_LOAD_AXES];
+  float Phase = (float)(GSeatStep++ % 90) / 90.0f;
+  Load[LOAD_NORMAL] = 0.5f * Phase;
+  Load[LOAD_AXIAL] = 0.1f * Phase;
+  Load[LOAD_SIDE] = -0.05f * Phase;
+  GSeat_StepFilters(Load, FRAME_TIME);
+}
+
+// sends a message that every module is given but none acts on
+static void SendSceneryLoaded
+  (
+  void
+  )
+{
+  XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_SCENERY_LOADED, NULL);
+}
+
+// sends the message that the user's aircraft has loaded
+static void SendPlaneLoaded
+  (
+  void
+  )
+{
+  XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_PLANE_LOADED, (void *)0);
+}
+
+// measures the detection of an aircraft
+static void MeasureDetectAircraft
+  (
+  const char *Name,
+  const char *Description  // description of the aircraft that is loaded
+  )
+{
+  counters_t Start, End;
+  double MeanNs;
+
+  Stub_SetDatab("sim/aircraft/view/acf_descrip", Description);
+  SendPlaneLoaded();
+  Stub_ChooseMenuItem("Profiling", "Reset");
+
+  ReadCounters(&Start);
+  for (int i = 0; i < NUM_AIRCRAFT_LOADS; i++) SendPlaneLoaded();
+  ReadCounters(&End);
+
+  unsigned long long Count = Profile_GetStats(PROFILE_DETECT_AIRCRAFT, 0, &MeanNs);
+  WriteResult(Name, Count, MeanNs, &Start, &End);
+}
+
+// gets the state of the landing throttle manager
+static int GetManagerState
+  (
+  void
+  )
+{
+  return Stub_GetDatai("xvrtools/landing_throttle_manager/state");
+}
+
+// gets the state of the head motion
+static int GetHeadState
+  (
+  void
+  )
+{
+  return Stub_GetDatai("xvrtools/head_motion/state");
+}
+
+// runs one frame of the aircraft and the plugin and adds its counts to the states
+// the plugin was in at the start of the frame
+static void RunFrame
+  (
+  state_totals_t *LtmTotals,  // NUM_LTM_STATES totals, or NULL
+  state_totals_t *HeadTotals  // NUM_HEAD_STATES totals, or NULL
+  )
+{
+  counters_t Start, End;
+  int LtmState = GetManagerState();
+  int HeadState = GetHeadState();
+
+  FlightModel_Step(FRAME_TIME);
+  ReadCounters(&Start);
+  Stub_RunFrame(FRAME_TIME);
+  ReadCounters(&End);
+  if ((LtmTotals == NULL) || (HeadTotals == NULL)) return;
+
+  state_totals_t *Totals[2] = {&LtmTotals[LtmState], &HeadTotals[HeadState]};
+  for (int t = 0; t < 2; t++)
+  {
+    Totals[t]->Frames++;
+    Totals[t]->Allocations += End.Allocations - Start.Allocations;
+    Totals[t]->CacheMisses += End.CacheMisses - Start.CacheMisses;
+  }
+}
+
+// runs frames for a time
+static void RunFor
+  (
+  double Seconds,
+  state_totals_t *LtmTotals,
+  state_totals_t *HeadTotals
+  )
+{
+  double EndTime = Stub_GetTime() + Seconds - (FRAME_TIME / 2);
+  while (Stub_GetTime() < EndTime) RunFrame(LtmTotals, HeadTotals);
+}
+
+// flies a landing with the throttle manager and touch down motion enabled
+// returns TRUE if the landing finished
+static bool FlyLanding
+  (
+  const char *Autobrake,  // autobrake menu item, the reversers are only used on their own when it's off
+  state_totals_t *LtmTotals,
+  state_totals_t *HeadTotals
+  )
+{
+  Stub_ChooseMenuItem("Autobrake", Autobrake);
+  FlightModel_Init();
+  SendPlaneLoaded();
+  XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_AIRPORT_LOADED, NULL);
+  RunFor(4.0, LtmTotals, HeadTotals);
+
+  FlightModel_StartApproach(40.0f, 140.0f, 1.2f, 30.0f, 1.0f, 0.4f);
+  RunFor(1.0, LtmTotals, HeadTotals);
+  Stub_TriggerCommand("XVRTools//Landing Throttle Manager//Enable");
+
+  double EndTime = Stub_GetTime() + MAX_LANDING_TIME;
+  RunFor(1.0, LtmTotals, HeadTotals);
+  while (!FlightModel_IsStopped() || (GetManagerState() != LTM_WAIT_FOR_USER) || (GetHeadState() != HEAD_WAIT_FOR_FLYING))
+  {
+    if (Stub_GetTime() > EndTime) return FALSE;
+    RunFrame(LtmTotals, HeadTotals);
+  }
+
+  return TRUE;
+}
+
+// writes the results of the states of a state machine
+static void WriteStates
+  (
+  const char *Name,
+  profile_section_t Section,
+  const char **StateNames,
+  const state_totals_t *Totals,
+  int NumStates
+  )
+{
+  char ResultName[128];
+
+  for (int State = 0; State < NumStates; State++)
+  {
+    double MeanNs;
+    unsigned long long Count = Profile_GetStats(Section, State, &MeanNs);
+    sprintf_s(ResultName, 128, "%s_step_%s", Name, StateNames[State]);
+
+    StartResult(ResultName, Count, MeanNs);
+    WritePerOperation("allocations_per_frame", (double)Totals[State].Allocations, Totals[State].Frames, TRUE);
+    WritePerOperation("cache_misses_per_frame", (double)Totals[State].CacheMisses, Totals[State].Frames, CacheMissCounter >= 0);
+    printf("}");
+  }
+}
+
+// measures a step of every state of both state machines
+// returns TRUE for success, FALSE for error
+static bool MeasureStateMachines
+  (
+  void
+  )
+{
+  state_totals_t LtmTotals[NUM_LTM_STATES];
+  state_totals_t HeadTotals[NUM_HEAD_STATES];
+  memset(LtmTotals, 0, sizeof(LtmTotals));
+  memset(HeadTotals, 0, sizeof(HeadTotals));
+
+  if (Stub_IsMenuItemChecked("Head Motion", "Enable touch-down motion") == FALSE)
+  {
+    Stub_ChooseMenuItem("Head Motion", "Enable touch-down motion");
+  }
+  Stub_ChooseMenuItem("Profiling", "Reset");
+
+  for (int l = 0; l < NUM_LANDINGS; l++)
+  {
+    if (!FlyLanding((l % 2) ? "Off" : "Medium", LtmTotals, HeadTotals))
+    {
+      fprintf(stderr, "landing %d didn't finish\n", l + 1);
+      return FALSE;
+    }
+  }
+
+  WriteStates("landing_throttle_manager", PROFILE_LANDING_THROTTLE_MANAGER, LtmStateNames, LtmTotals, NUM_LTM_STATES);
+  WriteStates("head_motion", PROFILE_HEAD_MOTION, HeadStateNames, HeadTotals, NUM_HEAD_STATES);
+  return TRUE;
+}
+
+// turns on a menu item that is checked when it's on
+static void TurnOn
+  (
+  const char *Menu,
+  const char *Item
+  )
+{
+  if (Stub_IsMenuItemChecked(Menu, Item) == FALSE) Stub_ChooseMenuItem(Menu, Item);
+}
+
+// measures a frame of the engine vibration with propeller engines running at different speeds
+// returns TRUE if it is within its budget
+static bool MeasureEngineVibration
+  (
+  void
+  )
+{
+  float Blades[NUM_VIBRATION_ENGINES];
+  float Rpm[NUM_VIBRATION_ENGINES];
+  float Power[NUM_VIBRATION_ENGINES];
+  for (int e = 0; e < NUM_VIBRATION_ENGINES; e++)
+  {
+    Blades[e] = 4;
+    Rpm[e] = 1200.0f + 7.0f * e;
+    Power[e] = 1000000.0f;
+  }
+
+  Stub_SetDatai("sim/aircraft/engine/acf_num_engines", NUM_VIBRATION_ENGINES);
+  Stub_SetDatavf("sim/aircraft/prop/acf_num_blades", Blades, NUM_VIBRATION_ENGINES);
+  SendPlaneLoaded();
+  Stub_SetDatavf("sim/cockpit2/engine/indicators/engine_speed_rpm", Rpm, NUM_VIBRATION_ENGINES);
+  Stub_SetDatavf("sim/cockpit2/engine/indicators/prop_speed_rpm", Rpm, NUM_VIBRATION_ENGINES);
+  Stub_SetDatavf("sim/cockpit2/engine/indicators/power_watts", Power, NUM_VIBRATION_ENGINES);
+  TurnOn("Engine Vibration", "Enable engine vibration");
+
+  // the flight model isn't stepped, it only has two engines
+  for (int f = 0; f < 90; f++) Stub_RunFrame(FRAME_TIME);
+  Stub_ChooseMenuItem("Profiling", "Reset");
+
+  counters_t Start, End;
+  double MeanNs;
+  ReadCounters(&Start);
+  for (int f = 0; f < NUM_VIBRATION_FRAMES; f++) Stub_RunFrame(FRAME_TIME);
+  ReadCounters(&End);
+
+  unsigned long long Count = Profile_GetStats(PROFILE_ENGINE_VIBRATION, 0, &MeanNs);
+  WriteResult("engine_vibration_8_engines", Count, MeanNs, &Start, &End);
+
+  if (Count < NUM_VIBRATION_FRAMES)
+  {
+    fprintf(stderr, "engine vibration ran in %llu of %d frames with %d engines running\n", Count, NUM_VIBRATION_FRAMES, NUM_VIBRATION_ENGINES);
+    return FALSE;
+  }
+  if (MeanNs > ENGINE_VIBRATION_BUDGET_NS)
+  {
+    fprintf(stderr, "engine vibration took %.0f ns a frame with %d engines, more than %.0f ns\n", MeanNs, NUM_VIBRATION_ENGINES, ENGINE_VIBRATION_BUDGET_NS);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+// gets the CPU time used by the benchmark's thread
+// returns the time in ns
+static double GetCpuTime
+  (
+  void
+  )
+{
+  struct timespec Time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Time);
+  return Time.tv_sec * 1000000000.0 + Time.tv_nsec;
+}
+
+// gets the height of the aircraft above the ground
+// returns the height in m
+static float GetAltitude
+  (
+  void
+  )
+{
+  return Stub_GetDataf("sim/flightmodel2/position/y_agl");
+}
+
+// runs one frame of the scripted flight and records the plugin's CPU time
+// returns FALSE if the flight has run for too long
+static bool FlyFrame
+  (
+  void
+  )
+{
+  if (Flight.NumFrames >= MAX_FLIGHT_FRAMES) return FALSE;
+
+  frame_t *Frame = &Flight.Frames[Flight.NumFrames++];
+  Frame->Phase = Flight.Phase;
+  Frame->LtmState = GetManagerState();
+  Frame->HeadState = GetHeadState();
+  if (Frame->LtmState == LTM_WAIT_FOR_END_OF_ROLLOUT) Flight.ReachedRollout = TRUE;
+
+  FlightModel_Step(FRAME_TIME);
+  double Start = GetCpuTime();
+  Stub_RunFrame(FRAME_TIME);
+  Stub_DrawWindows();
+  Frame->Ns = GetCpuTime() - Start;
+
+  return TRUE;
+}
+
+// flies the scripted flight for a time
+// returns FALSE if the flight has run for too long
+static bool FlyFor
+  (
+  double Seconds
+  )
+{
+  double EndTime = Stub_GetTime() + Seconds - (FRAME_TIME / 2);
+  while (Stub_GetTime() < EndTime)
+  {
+    if (!FlyFrame()) return FALSE;
+  }
+  return TRUE;
+}
+
+// flies the scripted flight until the aircraft climbs or descends to a height
+// returns FALSE if it doesn't get there in time
+static bool FlyToAltitude
+  (
+  float Altitude,  // height above the ground in m, 0 to fly until touch down
+  double MaxSeconds
+  )
+{
+  bool Climbing = GetAltitude() < Altitude;
+  double EndTime = Stub_GetTime() + MaxSeconds;
+  while (Climbing ? (GetAltitude() < Altitude) :
+         (Altitude > 0) ? (GetAltitude() > Altitude) : (Stub_GetDatai("sim/flightmodel/failures/onground_any") == 0))
+  {
+    if ((Stub_GetTime() > EndTime) || !FlyFrame()) return FALSE;
+  }
+  return TRUE;
+}
+
+// flies the whole scripted flight
+// returns the phase that didn't finish, or NUM_PHASES if they all did
+static phase_t FlyScript
+  (
+  void
+  )
+{
+  FlightModel_Init();
+  SendPlaneLoaded();
+  XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_AIRPORT_LOADED, NULL);
+
+  // line up and take off with flaps 5, retracting the gear once climbing
+  Flight.Phase = PHASE_TAKEOFF;
+  FlightModel_Configure(5.0f, 1.0f, 0);
+  if (!FlyFor(4.0)) return Flight.Phase;
+  FlightModel_Takeoff(150.0f, 10.0f);
+  if (!FlyToAltitude(100.0f, 120.0)) return Flight.Phase;
+  FlightModel_Configure(5.0f, 0, 1.0f);
+
+  Flight.Phase = PHASE_CLIMB;
+  FlightModel_Configure(0, 0, 0.9f);
+  FlightModel_Fly(10.0f, 250.0f);
+  if (!FlyToAltitude(CRUISE_ALTITUDE, 600.0)) return Flight.Phase;
+
+  Flight.Phase = PHASE_CRUISE;
+  FlightModel_Configure(0, 0, 0.7f);
+  FlightModel_Fly(0, 280.0f);
+  if (!FlyFor(CRUISE_TIME)) return Flight.Phase;
+
+  // descend and configure for landing, the throttle manager is armed once it can be
+  Flight.Phase = PHASE_APPROACH;
+  FlightModel_Configure(30.0f, 1.0f, 0.4f);
+  FlightModel_Fly(-5.0f, 140.0f);
+  if (!FlyToAltitude(140.0f, 600.0)) return Flight.Phase;
+  Stub_TriggerCommand("XVRTools//Landing Throttle Manager//Enable");
+  if (!FlyToAltitude(FLARE_ALTITUDE, 60.0)) return Flight.Phase;
+
+  Flight.Phase = PHASE_FLARE;
+  FlightModel_Fly(-1.0f, 135.0f);
+  if (!FlyToAltitude(0, 60.0)) return Flight.Phase;
+
+  Flight.Phase = PHASE_TOUCHDOWN;
+  if (!FlyFor(TOUCHDOWN_TIME)) return Flight.Phase;
+
+  // until the aircraft has stopped and the state machines are waiting for the next landing
+  Flight.Phase = PHASE_ROLLOUT;
+  double EndTime = Stub_GetTime() + MAX_LANDING_TIME;
+  while (!FlightModel_IsStopped() || (GetManagerState() != LTM_WAIT_FOR_USER) || (GetHeadState() != HEAD_WAIT_FOR_FLYING))
+  {
+    if ((Stub_GetTime() > EndTime) || !FlyFrame()) return Flight.Phase;
+  }
+
+  if (!Flight.ReachedRollout) return PHASE_ROLLOUT;
+  return NUM_PHASES;
+}
+
+// compares two frame times for sorting
+static int CompareTimes
+  (
+  const void *a,
+  const void *b
+  )
+{
+  double TimeA = *(const double *)a;
+  double TimeB = *(const double *)b;
+  return (TimeA > TimeB) - (TimeA < TimeB);
+}
+
+// writes statistics of frame times as the members of a JSON object
+static void WriteFrameStats
+  (
+  phase_t Phase  // phase to write, or NUM_PHASES for the whole flight
+  )
+{
+  static double Times[MAX_FLIGHT_FRAMES];
+  int Count = 0;
+  double Total = 0;
+
+  for (int f = 0; f < Flight.NumFrames; f++)
+  {
+    if ((Phase != NUM_PHASES) && (Flight.Frames[f].Phase != Phase)) continue;
+    Times[Count++] = Flight.Frames[f].Ns;
+    Total += Flight.Frames[f].Ns;
+  }
+  if (Count == 0)
+  {
+    printf("\"frames\": 0");
+    return;
+  }
+  qsort(Times, Count, sizeof(double), CompareTimes);
+
+  int OverBudget = 0;
+  while ((OverBudget < Count) && (Times[Count - 1 - OverBudget] > FRAME_BUDGET_NS)) OverBudget++;
+
+  printf("\"frames\": %d, \"over_budget\": %d, \"mean_ns\": %.0f, \"min_ns\": %.0f, \"p50_ns\": %.0f, \"p90_ns\": %.0f, \"p99_ns\": %.0f, \"p999_ns\": %.0f, \"max_ns\": %.0f",
+    Count, OverBudget, Total / Count, Times[0], Times[(int)(Count * 0.5)], Times[(int)(Count * 0.9)], Times[(int)(Count * 0.99)], Times[(int)(Count * 0.999)], Times[Count - 1]);
+}
+
+// flies a scripted flight from take off to the end of the rollout with every module
+// turned on and writes the plugin's CPU time of each frame
+// returns TRUE for success, FALSE for error
+static bool MeasureFlight
+  (
+  void
+  )
+{
+  memset(&Flight, 0, sizeof(Flight));
+
+  TurnOn("Landing Throttle Manager", "Announce when ready");
+  TurnOn("Head Motion", "Enable touch-down motion");
+  TurnOn("Ground Roll", "Enable runway rumble");
+  TurnOn("G-Seat", "Enable g-seat motion");
+  TurnOn("Engine Vibration", "Enable engine vibration");
+  TurnOn("Landing Scorecard", "Show after landing");
+  TurnOn("Status Window", "Show");
+  Stub_ChooseMenuItem("Autobrake", "Medium");
+
+  phase_t Unfinished = FlyScript();
+
+  printf(",\n  \"flight\": {\"frame_rate\": %.0f, \"budget_ns\": %.0f, ", 1.0 / FRAME_TIME, FRAME_BUDGET_NS);
+  WriteFrameStats(NUM_PHASES);
+  printf(",\n    \"phases\": [");
+  for (int p = 0; p < NUM_PHASES; p++)
+  {
+    printf("%s\n      {\"name\": \"%s\", ", p == 0 ? "" : ",", PhaseNames[p]);
+    WriteFrameStats((phase_t)p);
+    printf("}");
+  }
+  printf("\n    ]");
+
+  if (Flight.NumFrames > 0)
+  {
+    int Worst = 0;
+    for (int f = 1; f < Flight.NumFrames; f++)
+    {
+      if (Flight.Frames[f].Ns > Flight.Frames[Worst].Ns) Worst = f;
+    }
+    const frame_t *Frame = &Flight.Frames[Worst];
+    printf(",\n    \"worst\": {\"ns\": %.0f, \"frame\": %d, \"time\": %.3f, \"phase\": \"%s\", \"landing_throttle_manager_state\": \"%s\", \"head_motion_state\": \"%s\"}",
+      Frame->Ns, Worst, Worst * FRAME_TIME, PhaseNames[Frame->Phase], LtmStateNames[Frame->LtmState], HeadStateNames[Frame->HeadState]);
+  }
+  printf("}");
+
+  if (Unfinished != NUM_PHASES)
+  {
+    fprintf(stderr, "the %s of the scripted flight didn't finish\n", PhaseNames[Unfinished]);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+// runs frames with the aircraft where it is and adds up what they cost
+static void RunIdleFrames
+  (
+  double *Ns,                     // filled with the CPU time of each frame
+  unsigned long long *Calls,      // filled with the SDK calls of each frame
+  unsigned long long *LoopCalls   // filled with the flight loop calls of each frame
+  )
+{
+  double TotalNs = 0;
+  unsigned long long StartCalls = Stub_GetNumCalls();
+  unsigned long long StartLoopCalls = Stub_GetNumLoopCalls();
+
+  for (int f = 0; f < NUM_IDLE_FRAMES; f++)
+  {
+    FlightModel_Step(FRAME_TIME);
+    double Start = GetCpuTime();
+    Stub_RunFrame(FRAME_TIME);
+    Stub_DrawWindows();
+    TotalNs += GetCpuTime() - Start;
+  }
+
+  *Ns = TotalNs / NUM_IDLE_FRAMES;
+  *Calls = Stub_GetNumCalls() - StartCalls;
+  *LoopCalls = Stub_GetNumLoopCalls() - StartLoopCalls;
+}
+
+// compares the cost of a frame with the plugin enabled and disabled, with every module turned on
+// the frames of the disabled plugin only cost the stub's own work
+// returns TRUE if the disabled plugin cost nothing, FALSE if it did any work
+static bool MeasureDisabled
+  (
+  void
+  )
+{
+  double EnabledNs, DisabledNs;
+  unsigned long long EnabledCalls, DisabledCalls, EnabledLoopCalls, DisabledLoopCalls;
+
+  RunIdleFrames(&EnabledNs, &EnabledCalls, &EnabledLoopCalls);
+
+  XPluginDisable();
+  int ScheduledLoops = Stub_GetNumScheduledLoops();
+  int Handlers = Stub_GetNumHandlers();
+  int VisibleWindows = Stub_GetNumVisibleWindows();
+  RunIdleFrames(&DisabledNs, &DisabledCalls, &DisabledLoopCalls);
+  XPluginEnable();
+
+  bool ZeroCost = (DisabledCalls == 0) && (DisabledLoopCalls == 0) && (ScheduledLoops == 0) && (Handlers == 0) && (VisibleWindows == 0);
+
+  printf(",\n  \"disabled\": {\"frames\": %d, \"zero_cost\": %s,\n", NUM_IDLE_FRAMES, ZeroCost ? "true" : "false");
+  printf("    \"enabled\": {\"ns_per_frame\": %.0f, \"sdk_calls_per_frame\": %.1f, \"flight_loop_calls_per_frame\": %.1f},\n",
+    EnabledNs, (double)EnabledCalls / NUM_IDLE_FRAMES, (double)EnabledLoopCalls / NUM_IDLE_FRAMES);
+  printf("    \"disabled\": {\"ns_per_frame\": %.0f, \"sdk_calls\": %llu, \"flight_loop_calls\": %llu, \"scheduled_loops\": %d, \"command_handlers\": %d, \"visible_windows\": %d}}",
+    DisabledNs, DisabledCalls, DisabledLoopCalls, ScheduledLoops, Handlers, VisibleWindows);
+
+  if (!ZeroCost) fprintf(stderr, "the disabled plugin did some work\n");
+  return ZeroCost;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ALLOCATOR
+
+extern "C" void *malloc
+  (
+  size_t Size
+  ) noexcept
+{
+  CountAllocation();
+  return __libc_malloc(Size);
+}
+
+extern "C" void *calloc
+  (
+  size_t Count,
+  size_t Size
+  ) noexcept
+{
+  CountAllocation();
+  return __libc_calloc(Count, Size);
+}
+
+extern "C" void *realloc
+  (
+  void *Pointer,
+  size_t Size
+  ) noexcept
+{
+  CountAllocation();
+  return __libc_realloc(Pointer, Size);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PROGRAM
+
+int main
+  (
+  int argc,
+  char **argv
+  )
+{
+  MainThread = pthread_self();
+  CacheMissCounter = OpenCacheMissCounter();
+
+  if (!Stub_StartPlugin()) return 1;
+  FlightModel_Init();
+  SendPlaneLoaded();
+  RunFor(4.0, NULL, NULL);
+
+  CountAllocations = TRUE;
+
+  printf("{\n  \"plugin\": \"%s\",\n  \"version\": \"%d.%d.%d\",\n  \"cache_misses_counted\": %s,\n  \"micro\": [",
+    PLUGIN_NAME, PLUGIN_VERSION_MAJOR, PLUGIN_VERSION_MINOR, PLUGIN_VERSION_DOT, CacheMissCounter >= 0 ? "true" : "false");
+
+  MeasureOperation("diagnostic_printf", PrintDiagnostic, NUM_OPERATIONS);
+  MeasureOperation("get_head_position", ReadHeadPosition, NUM_OPERATIONS);
+  MeasureOperation("gseat_step_filters", StepGSeatFilters, NUM_OPERATIONS);
+  MeasureOperation("receive_message_fan_out", SendSceneryLoaded, NUM_OPERATIONS);
+  for (size_t a = 0; a < sizeof(AircraftDescriptions) / sizeof(AircraftDescriptions[0]); a++)
+  {
+    MeasureDetectAircraft(AircraftDescriptions[a][0], AircraftDescriptions[a][1]);
+  }
+
+  bool Success = MeasureStateMachines();
+  Success &= MeasureEngineVibration();
+  printf("\n  ]");
+
+  Success &= MeasureFlight();
+  Success &= MeasureDisabled();
+  printf("\n}\n");
+
+  CountAllocations = FALSE;
+  Stub_StopPlugin();
+  return Success ? 0 : 1;
+}
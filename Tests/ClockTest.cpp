@@ -0,0 +1,454 @@
+// CLOCK TEST
+
+// Checks that the plugin follows the time it is given, using the stub's
+// clock through Clock_SetSource:
+//   - the same landing flown twice gives exactly the same result every
+//     frame, even when the computer is slowed down for one of them
+//   - nothing moves while the sim is paused, except the wall clock
+//   - with time compression the sim clock and everything that uses it run
+//     faster, but the wall and unpaused clocks don't
+//   - a long gap between frames only moves the wall clock on
+// Each test runs in its own process so the plugin starts from nothing
+// Usage: ClockTest
+
+#include <stdlib.h>
+#include <math.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "XPLMStub.h"
+#include "FlightModel.h"
+#include "Config.h"
+#include "Clock.h"
+
+// configuration section
+// length of a frame, in seconds
+#define FRAME_TIME (1.0f / 90.0f)
+// frames recorded for the replay test
+#define REPLAY_FRAMES (90 * 60)
+// time compression used for the compression test
+#define TIME_COMPRESSION 4
+// allowed difference between clock readings, in seconds
+#define CLOCK_TOLERANCE 0.001
+// longest time to wait for the aircraft to get somewhere, in seconds
+#define MAX_WAIT 120.0
+
+// states of the landing throttle manager, see LandingThrottleManager.cpp
+#define LTM_WAIT_FOR_USER           0
+#define LTM_WAIT_FOR_IDLE_THROTTLE  3
+#define LTM_WAIT_FOR_END_OF_ROLLOUT 7
+
+// states of the head motion, see HeadMotion.cpp
+#define HEAD_WAIT_FOR_FLYING 1
+#define HEAD_TOUCHDOWN       3
+
+// what the plugin has done after one frame
+typedef struct _trace_t
+{
+  float Brakes[2];
+  float ParkingBrake;
+  float Throttle[FLIGHT_MODEL_NUM_ENGINES];
+  int PropMode[FLIGHT_MODEL_NUM_ENGINES];
+  float HeadY;
+  int HeldCommands;
+  int ManagerState;
+  int HeadState;
+} trace_t;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// reports a failed check and stops
+static void Fail
+  (
+  const char *Format,
+  ...
+  )
+{
+  va_list Args;
+  va_start(Args, Format);
+  fprintf(stderr, "FAIL at %.3fs: ", Stub_GetTime());
+  vfprintf(stderr, Format, Args);
+  fprintf(stderr, "\n");
+  va_end(Args);
+  // the plugin's file watchers are still running so don't clean up
+  fflush(NULL);
+  _exit(1);
+}
+
+// runs one frame of the aircraft and the plugin
+static void RunFrame
+  (
+  void
+  )
+{
+  FlightModel_Step(FRAME_TIME);
+  Stub_RunFrame(FRAME_TIME);
+  Stub_DrawWindows();
+}
+
+// runs frames for a time
+static void RunFor
+  (
+  double Seconds
+  )
+{
+  double EndTime = Stub_GetTime() + Seconds - (FRAME_TIME / 2);
+  while (Stub_GetTime() < EndTime) RunFrame();
+}
+
+// gets the state of the landing throttle manager
+static int GetManagerState
+  (
+  void
+  )
+{
+  return Stub_GetDatai("xvrtools/landing_throttle_manager/state");
+}
+
+// gets the state of the head motion
+static int GetHeadState
+  (
+  void
+  )
+{
+  return Stub_GetDatai("xvrtools/head_motion/state");
+}
+
+// places the aircraft for a new flight and waits for x-plane to finish dropping it
+static void StartFlight
+  (
+  void
+  )
+{
+  FlightModel_Init();
+  XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_PLANE_LOADED, (void *)0);
+  XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_AIRPORT_LOADED, NULL);
+  if (Stub_IsMenuItemChecked("Head Motion", "Enable touch-down motion") == FALSE)
+  {
+    Stub_ChooseMenuItem("Head Motion", "Enable touch-down motion");
+  }
+  RunFor(4.0);
+}
+
+// starts an approach with the autobrake set and the throttle manager enabled
+static void StartLanding
+  (
+  float Throttle  // 0 = idle to 1 = full
+  )
+{
+  StartFlight();
+  Stub_ChooseMenuItem("Autobrake", "Medium");
+  FlightModel_StartApproach(40.0f, 140.0f, 1.2f, 30.0f, 1.0f, Throttle);
+  RunFor(1.0);
+  Stub_TriggerCommand("XVRTools//Landing Throttle Manager//Enable");
+}
+
+// records what the plugin has done
+static void Record
+  (
+  trace_t *Trace
+  )
+{
+  memset(Trace, 0, sizeof(trace_t));
+  Trace->Brakes[0] = Stub_GetDataf("sim/cockpit2/controls/left_brake_ratio");
+  Trace->Brakes[1] = Stub_GetDataf("sim/cockpit2/controls/right_brake_ratio");
+  Trace->ParkingBrake = Stub_GetDataf("sim/cockpit2/controls/parking_brake_ratio");
+  for (int e = 0; e < FLIGHT_MODEL_NUM_ENGINES; e++)
+  {
+    Trace->Throttle[e] = Stub_GetDatavf("sim/cockpit2/engine/actuators/throttle_ratio", e);
+    Trace->PropMode[e] = Stub_GetDatavi("sim/cockpit2/engine/actuators/prop_mode", e);
+  }
+  Trace->HeadY = Stub_GetDataf("sim/graphics/view/pilots_head_y");
+  Trace->HeldCommands = Stub_GetNumHeldCommands();
+  Trace->ManagerState = GetManagerState();
+  Trace->HeadState = GetHeadState();
+}
+
+// flies a landing and writes what the plugin did after every frame
+static void FlyReplay
+  (
+  int Output,  // file to write REPLAY_FRAMES trace_t to
+  bool Slow    // TRUE to slow the computer down
+  )
+{
+  if (!Stub_StartPlugin()) Fail("plugin didn't start");
+  StartLanding(0.4f);
+
+  for (int f = 0; f < REPLAY_FRAMES; f++)
+  {
+    // the real time between frames varies and has nothing to do with the stub's time
+    if (Slow) usleep(100 * (f % 3));
+    RunFrame();
+
+    trace_t Trace;
+    Record(&Trace);
+    if (write(Output, &Trace, sizeof(trace_t)) != sizeof(trace_t)) Fail("unable to write the trace");
+  }
+
+  Stub_StopPlugin();
+}
+
+// flies a replay in a new process
+// returns the process ID, or -1 for error
+static pid_t StartReplay
+  (
+  int *Input,  // on return the file to read the trace from
+  bool Slow    // TRUE to slow the computer down
+  )
+{
+  int Pipe[2];
+  if (pipe(Pipe) != 0) return -1;
+
+  pid_t Child = fork();
+  if (Child == 0)
+  {
+    close(Pipe[0]);
+    FlyReplay(Pipe[1], Slow);
+    close(Pipe[1]);
+    _exit(0);
+  }
+
+  close(Pipe[1]);
+  *Input = Pipe[0];
+  return Child;
+}
+
+// reads all of a trace
+// returns TRUE for success
+static bool ReadTrace
+  (
+  int Input,
+  trace_t *Trace  // filled with REPLAY_FRAMES frames
+  )
+{
+  size_t Size = REPLAY_FRAMES * sizeof(trace_t);
+  size_t Done = 0;
+  while (Done < Size)
+  {
+    ssize_t Count = read(Input, (char *)Trace + Done, Size - Done);
+    if (Count <= 0) break;
+    Done += Count;
+  }
+  close(Input);
+  return Done == Size;
+}
+
+// waits for a process to finish
+// returns TRUE if it passed
+static bool WaitFor
+  (
+  pid_t Child
+  )
+{
+  int Status;
+  if (waitpid(Child, &Status, 0) != Child) return FALSE;
+  return WIFEXITED(Status) && (WEXITSTATUS(Status) == 0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TESTS
+
+// the same landing flown twice does exactly the same thing every frame
+static void TestReplay
+  (
+  void
+  )
+{
+  static trace_t First[REPLAY_FRAMES];
+  static trace_t Second[REPLAY_FRAMES];
+
+  int Input;
+  pid_t Child = StartReplay(&Input, FALSE);
+  if ((Child < 0) || !ReadTrace(Input, First) || !WaitFor(Child)) Fail("first replay didn't finish");
+  Child = StartReplay(&Input, TRUE);
+  if ((Child < 0) || !ReadTrace(Input, Second) || !WaitFor(Child)) Fail("second replay didn't finish");
+
+  bool RolledOut = FALSE;
+  bool Touchdown = FALSE;
+  for (int f = 0; f < REPLAY_FRAMES; f++)
+  {
+    if (memcmp(&First[f], &Second[f], sizeof(trace_t)) != 0)
+    {
+      Fail("replays differ at frame %d: manager %d/%d, head motion %d/%d, head %f/%f, brakes %f/%f", f,
+        First[f].ManagerState, Second[f].ManagerState, First[f].HeadState, Second[f].HeadState,
+        First[f].HeadY, Second[f].HeadY, First[f].Brakes[0], Second[f].Brakes[0]);
+    }
+    if (First[f].ManagerState == LTM_WAIT_FOR_END_OF_ROLLOUT) RolledOut = TRUE;
+    if (First[f].HeadState == HEAD_TOUCHDOWN) Touchdown = TRUE;
+  }
+
+  // make sure there was something to compare
+  if ((RolledOut == FALSE) || (Touchdown == FALSE)) Fail("the replay didn't land and roll out");
+}
+
+// nothing moves while the sim is paused
+static void TestPause
+  (
+  void
+  )
+{
+  StartLanding(0.4f);
+
+  // wait for the rollout, after the touch down motion
+  double EndTime = Stub_GetTime() + MAX_WAIT;
+  while ((GetManagerState() != LTM_WAIT_FOR_END_OF_ROLLOUT) || (GetHeadState() != HEAD_WAIT_FOR_FLYING))
+  {
+    if (Stub_GetTime() > EndTime) Fail("no rollout");
+    RunFrame();
+  }
+  RunFor(1.0);
+
+  // start the parking brake moving and pause straight away
+  Stub_TriggerCommand("XVRTools//Parking Brake//Hold");
+  Stub_SetDatai("sim/time/paused", 1);
+  RunFrame();
+
+  trace_t Before;
+  Record(&Before);
+  float GroundSpeed = Stub_GetDataf("sim/flightmodel/position/groundspeed");
+  double Clocks[NUM_CLOCK_BASES];
+  for (int b = 0; b < NUM_CLOCK_BASES; b++) Clocks[b] = Clock_Get((clock_base_t)b);
+
+  const double PauseTime = 2.0;
+  for (int f = 0; f < PauseTime * 90; f++)
+  {
+    RunFrame();
+    trace_t Now;
+    Record(&Now);
+    if (memcmp(&Before, &Now, sizeof(trace_t)) != 0) Fail("the plugin moved something while paused");
+  }
+  if (Stub_GetDataf("sim/flightmodel/position/groundspeed") != GroundSpeed) Fail("the aircraft moved while paused");
+  if (Clock_Get(CLOCK_SIM) != Clocks[CLOCK_SIM]) Fail("sim clock ran while paused");
+  if (Clock_Get(CLOCK_UNPAUSED) != Clocks[CLOCK_UNPAUSED]) Fail("unpaused clock ran while paused");
+  if (fabs(Clock_Get(CLOCK_WALL) - Clocks[CLOCK_WALL] - PauseTime) > CLOCK_TOLERANCE) Fail("wall clock stopped while paused");
+
+  // carries on where it stopped
+  Stub_SetDatai("sim/time/paused", 0);
+  RunFor(0.5);
+  if (Stub_GetDataf("sim/cockpit2/controls/parking_brake_ratio") <= Before.ParkingBrake) Fail("the parking brake didn't move after the pause");
+  if (Stub_GetDataf("sim/flightmodel/position/groundspeed") >= GroundSpeed) Fail("the aircraft didn't slow down after the pause");
+}
+
+// with time compression the sim clock runs faster and so does everything that uses it
+static void TestCompression
+  (
+  void
+  )
+{
+  const config_t *Config = Config_Get();
+
+  StartFlight();
+  Stub_SetDatai("sim/time/ground_speed", TIME_COMPRESSION);
+  RunFrame();
+
+  double Clocks[NUM_CLOCK_BASES];
+  for (int b = 0; b < NUM_CLOCK_BASES; b++) Clocks[b] = Clock_Get((clock_base_t)b);
+  RunFor(1.0);
+  double Wall = Clock_Get(CLOCK_WALL) - Clocks[CLOCK_WALL];
+  if (fabs(Wall - 1.0) > CLOCK_TOLERANCE) Fail("wall clock ran for %fs", Wall);
+  if (fabs(Clock_Get(CLOCK_UNPAUSED) - Clocks[CLOCK_UNPAUSED] - Wall) > CLOCK_TOLERANCE) Fail("unpaused clock didn't follow the wall clock");
+  if (fabs(Clock_Get(CLOCK_SIM) - Clocks[CLOCK_SIM] - Wall * TIME_COMPRESSION) > CLOCK_TOLERANCE) Fail("sim clock didn't follow the compression");
+
+  // the parking brake moves in sim time
+  Stub_TriggerCommand("XVRTools//Parking Brake//Hold");
+  double StartTime = Stub_GetTime();
+  while (Stub_GetDataf("sim/cockpit2/controls/parking_brake_ratio") < 1.0f)
+  {
+    if (Stub_GetTime() - StartTime > Config->BrakeRampTime) Fail("the parking brake didn't speed up");
+    RunFrame();
+  }
+  double RampTime = Stub_GetTime() - StartTime;
+  double Expected = Config->BrakeRampTime / TIME_COMPRESSION;
+  if (fabs(RampTime - Expected) > 2 * FRAME_TIME) Fail("the parking brake took %fs, expected %fs", RampTime, Expected);
+  Stub_TriggerCommand("XVRTools//Parking Brake//Release");
+
+  // so does the throttle manager's wait for idle throttle
+  FlightModel_StartApproach(150.0f, 140.0f, 1.0f, 30.0f, 1.0f, 0.6f);
+  FlightModel_SetStuckThrottle(TRUE);
+  RunFor(1.0);
+  Stub_TriggerCommand("XVRTools//Landing Throttle Manager//Enable");
+  double EndTime = Stub_GetTime() + MAX_WAIT;
+  while (GetManagerState() != LTM_WAIT_FOR_IDLE_THROTTLE)
+  {
+    if (Stub_GetTime() > EndTime) Fail("the throttle manager didn't start");
+    RunFrame();
+  }
+  StartTime = Stub_GetTime();
+  while (GetManagerState() == LTM_WAIT_FOR_IDLE_THROTTLE)
+  {
+    if (Stub_GetTime() > EndTime) Fail("the throttle manager didn't give up");
+    RunFrame();
+  }
+  double WaitTime = Stub_GetTime() - StartTime;
+  Expected = Config->IdleThrottleTimeout / TIME_COMPRESSION;
+  if (fabs(WaitTime - Expected) > Config->ThrottleManagerInterval + FRAME_TIME) Fail("the throttle manager waited %fs, expected %fs", WaitTime, Expected);
+  if (GetManagerState() != LTM_WAIT_FOR_USER) Fail("the throttle manager didn't give up");
+}
+
+// a long gap between frames only moves the wall clock on
+static void TestLongFrame
+  (
+  void
+  )
+{
+  StartFlight();
+
+  double Clocks[NUM_CLOCK_BASES];
+  for (int b = 0; b < NUM_CLOCK_BASES; b++) Clocks[b] = Clock_Get((clock_base_t)b);
+  const float Gap = 5.0f;
+  Stub_RunFrame(Gap);
+  if (fabs(Clock_Get(CLOCK_WALL) - Clocks[CLOCK_WALL] - Gap) > CLOCK_TOLERANCE) Fail("wall clock didn't include the gap");
+  if (Clock_Get(CLOCK_SIM) != Clocks[CLOCK_SIM]) Fail("sim clock included the gap");
+  if (Clock_Get(CLOCK_UNPAUSED) != Clocks[CLOCK_UNPAUSED]) Fail("unpaused clock included the gap");
+
+  // the next frame is normal
+  for (int b = 0; b < NUM_CLOCK_BASES; b++) Clocks[b] = Clock_Get((clock_base_t)b);
+  RunFrame();
+  for (int b = 0; b < NUM_CLOCK_BASES; b++)
+  {
+    if (fabs(Clock_Get((clock_base_t)b) - Clocks[b] - FRAME_TIME) > CLOCK_TOLERANCE) Fail("clock %d didn't carry on after the gap", b);
+  }
+}
+
+// runs a test in a new process
+// returns TRUE if it passed
+static bool RunTest
+  (
+  const char *Name,
+  void (*Test)(void),
+  bool StartPlugin  // TRUE to start the plugin for the test
+  )
+{
+  pid_t Child = fork();
+  if (Child == 0)
+  {
+    if (StartPlugin && !Stub_StartPlugin()) _exit(1);
+    Test();
+    if (StartPlugin) Stub_StopPlugin();
+    _exit(0);
+  }
+
+  bool Passed = (Child > 0) && WaitFor(Child);
+  printf("%s %s\n", Passed ? "PASS" : "FAIL", Name);
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PROGRAM
+
+int main
+  (
+  int argc,
+  char **argv
+  )
+{
+  bool Passed = TRUE;
+  Passed &= RunTest("replay", TestReplay, FALSE);
+  Passed &= RunTest("pause", TestPause, TRUE);
+  Passed &= RunTest("time compression", TestCompression, TRUE);
+  Passed &= RunTest("long frame", TestLongFrame, TRUE);
+  return Passed ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+// COMPATIBILITY
+
+// Stand ins for the parts of the Microsoft C library and windows.h that the
+// plugin uses, so it can be built with GCC for the tests
+// The Makefile includes this before every source file
+
+#ifndef _COMPATH_
+#define _COMPATH_
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+
+#define TRUE  1
+#define FALSE 0
+
+#define sprintf_s  snprintf
+#define vsprintf_s vsnprintf
+
+// copies a string, truncating it to fit
+static inline int strcpy_s
+  (
+  char *Dest,
+  size_t Size,
+  const char *Source
+  )
+{
+  snprintf(Dest, Size, "%s", Source);
+  return 0;
+}
+
+// adds a string to the end of another, truncating it to fit
+static inline int strcat_s
+  (
+  char *Dest,
+  size_t Size,
+  const char *Source
+  )
+{
+  size_t Length = strlen(Dest);
+  if (Length < Size) snprintf(Dest + Length, Size - Length, "%s", Source);
+  return 0;
+}
+
+// opens a file
+// returns 0 for success
+static inline int fopen_s
+  (
+  FILE **File,
+  const char *Name,
+  const char *Mode
+  )
+{
+  *File = fopen(Name, Mode);
+  return *File == NULL;
+}
+
+#endif // _COMPATH_
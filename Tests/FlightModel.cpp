@@ -0,0 +1,412 @@
+// FLIGHT MODEL
+
+// A very simple flight model of a two engined 737, just enough to take the
+// plugin through an approach, touch down and rollout without x-plane
+// The aircraft can take off and climb, cruise and descend at a set climb
+// rate and airspeed. It lands at the sink rate it descends at, the nose
+// wheel comes down a little later and it then slows down with the
+// wheel brakes, parking brake and reverse thrust set by the plugin. The
+// throttles follow the throttle down command, the reversers follow the
+// propeller mode and the pilots head follows the view commands, so the
+// state machines see the results of what they do
+
+#include "FlightModel.h"
+#include "XPLMStub.h"
+
+// configuration section
+// conversion from m/s to knots
+#define KNOTS_PER_MS 1.944f
+// rate at which the throttle down command moves the throttles, per second
+#define THROTTLE_SPEED 1.0f
+// rate at which the reversers move, per second
+#define REVERSER_SPEED 2.0f
+// reversers deployed further than this give reverse thrust
+#define REVERSER_DEPLOYED 0.9f
+// rate at which the view commands move the head, in m/s
+#define HEAD_SPEED 0.3f
+// time between the main wheels and the nose wheel touching down, in seconds
+#define NOSE_DELAY 1.5f
+// time the sink rate is still seen after touch down while the gear compresses, in seconds
+#define COMPRESSION_TIME 0.5f
+// time the extra g of the touch down lasts, in seconds
+#define IMPACT_TIME 0.2f
+// decelerations in m/s^2 from rolling, full braking and full reverse thrust on one engine
+#define ROLLING_DECELERATION 0.4f
+#define BRAKE_DECELERATION   3.0f
+#define REVERSE_DECELERATION 1.0f
+// climb rate of a go around in m/s
+#define GO_AROUND_CLIMB_RATE 8.0f
+// acceleration of the take off roll at full throttle and of airspeed changes while flying, in m/s^2
+#define TAKEOFF_ACCELERATION 2.0f
+#define AIR_ACCELERATION     1.0f
+// N1 of a running engine at idle and the extra at full throttle
+#define IDLE_N1  20.0f
+#define RANGE_N1 80.0f
+// ground forces on each wheel, in Nm
+#define MAIN_WHEEL_FORCE 100000.0f
+#define NOSE_WHEEL_FORCE 50000.0f
+
+// propeller modes
+#define PROP_MODE_NORMAL  1
+#define PROP_MODE_REVERSE 3
+
+static bool Airborne;
+static float Altitude;
+static float VerticalSpeed;
+static float GroundSpeed;
+static float TargetSpeed;
+static bool TakingOff;
+static float RotationSpeed;
+static float TakeoffClimbRate;
+static float TouchdownSinkRate;
+static float TimeOnGround;
+static float Flaps;
+static float GearRatio;
+static float Throttle[FLIGHT_MODEL_NUM_ENGINES];
+static float Reverser[FLIGHT_MODEL_NUM_ENGINES];
+static bool Failed[FLIGHT_MODEL_NUM_ENGINES];
+static bool StuckThrottle;
+static float StuckThrottlePosition[FLIGHT_MODEL_NUM_ENGINES];
+static bool StuckHead;
+static double FlightTime;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// moves a value towards a target at a limited rate
+static float MoveTowards
+  (
+  float Value,
+  float Target,
+  float MaxChange
+  )
+{
+  if (Value < Target) return Value + MaxChange < Target ? Value + MaxChange : Target;
+  if (Value > Target) return Value - MaxChange > Target ? Value - MaxChange : Target;
+  return Value;
+}
+
+// writes the state of the aircraft to the datarefs read by the plugin
+static void WriteDatarefs
+  (
+  void
+  )
+{
+  bool NoseDown = (Airborne == FALSE) && (TimeOnGround >= NOSE_DELAY);
+
+  Stub_SetDatai("sim/flightmodel/failures/onground_any", !Airborne);
+  Stub_SetDatai("sim/flightmodel/failures/onground_all", NoseDown);
+  float WheelForces[3] = { NoseDown ? NOSE_WHEEL_FORCE : 0, Airborne ? 0 : MAIN_WHEEL_FORCE, Airborne ? 0 : MAIN_WHEEL_FORCE };
+  Stub_SetDatavf("sim/flightmodel2/gear/tire_vertical_force_n_mtr", WheelForces, 3);
+  Stub_SetDataf("sim/flightmodel/forces/fnrml_gear", WheelForces[0] + WheelForces[1] + WheelForces[2]);
+
+  bool Compressing = (Airborne == FALSE) && (TimeOnGround < COMPRESSION_TIME);
+  bool Impact = (Airborne == FALSE) && (TimeOnGround < IMPACT_TIME);
+  Stub_SetDataf("sim/flightmodel/forces/g_nrml", Impact ? 1.0f + TouchdownSinkRate * 0.3f : 1.0f);
+  Stub_SetDataf("sim/flightmodel/position/local_vy", Airborne ? VerticalSpeed : (Compressing ? -TouchdownSinkRate : 0));
+
+  Stub_SetDataf("sim/flightmodel/position/groundspeed", GroundSpeed);
+  Stub_SetDataf("sim/flightmodel/position/indicated_airspeed2", GroundSpeed * KNOTS_PER_MS);
+  Stub_SetDataf("sim/flightmodel2/position/y_agl", Altitude);
+  Stub_SetDatavf("sim/flightmodel2/wing/flap1_deg", &Flaps, 1);
+  float Gear[3] = { GearRatio, GearRatio, GearRatio };
+  Stub_SetDatavf("sim/flightmodel2/gear/deploy_ratio", Gear, 3);
+  Stub_SetDataf("sim/time/total_flight_time_sec", (float)FlightTime);
+
+  float N1[FLIGHT_MODEL_NUM_ENGINES];
+  float Rpm[FLIGHT_MODEL_NUM_ENGINES];
+  float Power[FLIGHT_MODEL_NUM_ENGINES];
+  int Running[FLIGHT_MODEL_NUM_ENGINES];
+  for (int e = 0; e < FLIGHT_MODEL_NUM_ENGINES; e++)
+  {
+    Running[e] = !Failed[e];
+    N1[e] = Running[e] ? IDLE_N1 + RANGE_N1 * Throttle[e] : 0;
+    Rpm[e] = N1[e] * 50.0f;
+    Power[e] = N1[e] * 100000.0f;
+  }
+  Stub_SetDatavf("sim/cockpit2/engine/actuators/throttle_ratio", Throttle, FLIGHT_MODEL_NUM_ENGINES);
+  Stub_SetDatavf("sim/flightmodel2/engines/thrust_reverser_deploy_ratio", Reverser, FLIGHT_MODEL_NUM_ENGINES);
+  Stub_SetDatavf("sim/cockpit2/engine/indicators/N1_percent", N1, FLIGHT_MODEL_NUM_ENGINES);
+  Stub_SetDatavf("sim/cockpit2/engine/indicators/engine_speed_rpm", Rpm, FLIGHT_MODEL_NUM_ENGINES);
+  Stub_SetDatavf("sim/cockpit2/engine/indicators/prop_speed_rpm", Rpm, FLIGHT_MODEL_NUM_ENGINES);
+  Stub_SetDatavf("sim/cockpit2/engine/indicators/power_watts", Power, FLIGHT_MODEL_NUM_ENGINES);
+  Stub_SetDatavi("sim/flightmodel/engine/ENGN_running", Running, FLIGHT_MODEL_NUM_ENGINES);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// places the aircraft on the runway, stopped with the engines at idle
+// the aircraft is a two engined 737 that the landing throttle manager knows
+void FlightModel_Init
+  (
+  void
+  )
+{
+  Stub_SetDatab("sim/aircraft/view/acf_descrip", "Boeing 737-800");
+  Stub_SetDatai("sim/aircraft/engine/acf_num_engines", FLIGHT_MODEL_NUM_ENGINES);
+  int Blades[FLIGHT_MODEL_NUM_ENGINES] = { 0, 0 };
+  Stub_SetDatavi("sim/aircraft/prop/acf_num_blades", Blades, FLIGHT_MODEL_NUM_ENGINES);
+  Stub_SetDatai("sim/graphics/VR/enabled", 1);
+
+  // x-plane puts the head back where it belongs when the aircraft is placed
+  Stub_SetDataf("sim/graphics/view/pilots_head_x", 0);
+  Stub_SetDataf("sim/graphics/view/pilots_head_y", FLIGHT_MODEL_HEAD_Y);
+  Stub_SetDataf("sim/graphics/view/pilots_head_z", 0);
+  Stub_SetDataf("sim/graphics/view/pilots_head_psi", 0);
+  Stub_SetDataf("sim/graphics/view/pilots_head_the", 0);
+  Stub_SetDataf("sim/graphics/view/pilots_head_phi", 0);
+
+  int PropMode[FLIGHT_MODEL_NUM_ENGINES] = { PROP_MODE_NORMAL, PROP_MODE_NORMAL };
+  Stub_SetDatavi("sim/cockpit2/engine/actuators/prop_mode", PropMode, FLIGHT_MODEL_NUM_ENGINES);
+
+  Airborne = FALSE;
+  Altitude = 0;
+  VerticalSpeed = 0;
+  GroundSpeed = 0;
+  TargetSpeed = 0;
+  TakingOff = FALSE;
+  TouchdownSinkRate = 0;
+  TimeOnGround = NOSE_DELAY;
+  Flaps = 0;
+  GearRatio = 1.0f;
+  for (int e = 0; e < FLIGHT_MODEL_NUM_ENGINES; e++)
+  {
+    Throttle[e] = 0;
+    Reverser[e] = 0;
+    Failed[e] = FALSE;
+  }
+  StuckThrottle = FALSE;
+  StuckHead = FALSE;
+  FlightTime = 0;
+
+  WriteDatarefs();
+}
+
+// puts the aircraft on an approach to the runway
+void FlightModel_StartApproach
+  (
+  float NewAltitude,   // height above the ground in m
+  float Airspeed,      // indicated airspeed in knots
+  float SinkRate,      // m/s, also the sink rate at touch down
+  float NewFlaps,      // flap angle in degrees
+  float NewGearRatio,  // 0 = up to 1 = down
+  float NewThrottle    // 0 = idle to 1 = full
+  )
+{
+  Airborne = TRUE;
+  Altitude = NewAltitude;
+  VerticalSpeed = -SinkRate;
+  GroundSpeed = Airspeed / KNOTS_PER_MS;
+  TargetSpeed = GroundSpeed;
+  TakingOff = FALSE;
+  Flaps = NewFlaps;
+  GearRatio = NewGearRatio;
+  for (int e = 0; e < FLIGHT_MODEL_NUM_ENGINES; e++) Throttle[e] = NewThrottle;
+
+  WriteDatarefs();
+}
+
+// starts a take off roll at full throttle, the aircraft lifts off and climbs when it
+// reaches the rotation speed
+void FlightModel_Takeoff
+  (
+  float NewRotationSpeed,  // indicated airspeed in knots
+  float ClimbRate          // m/s after lifting off
+  )
+{
+  if (Airborne) return;
+
+  TakingOff = TRUE;
+  RotationSpeed = NewRotationSpeed / KNOTS_PER_MS;
+  TakeoffClimbRate = ClimbRate;
+  FlightModel_Configure(Flaps, GearRatio, 1.0f);
+}
+
+// changes the climb rate and the airspeed while flying
+// the climb rate changes at once and the airspeed changes gradually
+void FlightModel_Fly
+  (
+  float ClimbRate,  // m/s, negative to descend
+  float Airspeed    // indicated airspeed in knots
+  )
+{
+  if (Airborne == FALSE) return;
+
+  VerticalSpeed = ClimbRate;
+  TargetSpeed = Airspeed / KNOTS_PER_MS;
+}
+
+// sets the flaps, gear and throttles, as the pilot would
+void FlightModel_Configure
+  (
+  float NewFlaps,      // flap angle in degrees
+  float NewGearRatio,  // 0 = up to 1 = down
+  float NewThrottle    // 0 = idle to 1 = full
+  )
+{
+  Flaps = NewFlaps;
+  GearRatio = NewGearRatio;
+  if (StuckThrottle == FALSE)
+  {
+    for (int e = 0; e < FLIGHT_MODEL_NUM_ENGINES; e++) Throttle[e] = NewThrottle;
+  }
+
+  WriteDatarefs();
+}
+
+// sets the throttles to full and climbs away
+void FlightModel_GoAround
+  (
+  void
+  )
+{
+  if (StuckThrottle == FALSE)
+  {
+    for (int e = 0; e < FLIGHT_MODEL_NUM_ENGINES; e++) Throttle[e] = 1.0f;
+  }
+  if (Airborne == FALSE)
+  {
+    Airborne = TRUE;
+    Altitude = 1.0f;
+  }
+  VerticalSpeed = GO_AROUND_CLIMB_RATE;
+  if (GroundSpeed < 70.0f) GroundSpeed = 70.0f;
+  TargetSpeed = GroundSpeed;
+  TakingOff = FALSE;
+}
+
+// stops an engine
+void FlightModel_FailEngine
+  (
+  int Engine
+  )
+{
+  if ((Engine >= 0) && (Engine < FLIGHT_MODEL_NUM_ENGINES)) Failed[Engine] = TRUE;
+}
+
+// stops the throttles from moving, as a hardware throttle would
+void FlightModel_SetStuckThrottle
+  (
+  bool Stuck
+  )
+{
+  StuckThrottle = Stuck;
+  for (int e = 0; e < FLIGHT_MODEL_NUM_ENGINES; e++) StuckThrottlePosition[e] = Throttle[e];
+}
+
+// stops the head from moving, as the user or another plugin would
+void FlightModel_SetStuckHead
+  (
+  bool Stuck
+  )
+{
+  StuckHead = Stuck;
+}
+
+// moves the aircraft on by one frame, following the commands and datarefs set by the plugin
+// nothing moves while paused and the time compression is used, as in x-plane
+void FlightModel_Step
+  (
+  float Seconds  // length of the frame
+  )
+{
+  // the view commands work while paused
+  if (StuckHead == FALSE)
+  {
+    float HeadY = Stub_GetDataf("sim/graphics/view/pilots_head_y");
+    if (Stub_IsCommandHeld("sim/general/down")) HeadY -= HEAD_SPEED * Seconds;
+    if (Stub_IsCommandHeld("sim/general/up")) HeadY += HEAD_SPEED * Seconds;
+    Stub_SetDataf("sim/graphics/view/pilots_head_y", HeadY);
+  }
+
+  float SimSeconds = 0;
+  if (Stub_GetDatai("sim/time/paused") == 0)
+  {
+    SimSeconds = Seconds * Stub_GetDataf("sim/time/sim_speed_actual") * Stub_GetDatai("sim/time/ground_speed");
+  }
+  if (SimSeconds <= 0)
+  {
+    WriteDatarefs();
+    return;
+  }
+
+  // the engines follow the throttles and reversers set by the plugin
+  float ReverseDeceleration = 0;
+  float ForwardThrust = 0;
+  bool ThrottleDown = Stub_IsCommandHeld("sim/engines/throttle_down");
+  for (int e = 0; e < FLIGHT_MODEL_NUM_ENGINES; e++)
+  {
+    int PropMode = Stub_GetDatavi("sim/cockpit2/engine/actuators/prop_mode", e);
+    Throttle[e] = Stub_GetDatavf("sim/cockpit2/engine/actuators/throttle_ratio", e);
+    if (StuckThrottle)
+    {
+      Throttle[e] = StuckThrottlePosition[e];
+    }
+    else if (ThrottleDown && (PropMode != PROP_MODE_REVERSE))
+    {
+      Throttle[e] = MoveTowards(Throttle[e], 0, THROTTLE_SPEED * SimSeconds);
+    }
+
+    Reverser[e] = MoveTowards(Reverser[e], PropMode == PROP_MODE_REVERSE ? 1.0f : 0, REVERSER_SPEED * SimSeconds);
+    if ((PropMode == PROP_MODE_REVERSE) && (Reverser[e] >= REVERSER_DEPLOYED) && (Failed[e] == FALSE))
+    {
+      ReverseDeceleration += REVERSE_DECELERATION * Throttle[e];
+    }
+    else if ((PropMode != PROP_MODE_REVERSE) && (Failed[e] == FALSE))
+    {
+      ForwardThrust += Throttle[e] / FLIGHT_MODEL_NUM_ENGINES;
+    }
+  }
+
+  if (Airborne)
+  {
+    GroundSpeed = MoveTowards(GroundSpeed, TargetSpeed, AIR_ACCELERATION * SimSeconds);
+    Altitude += VerticalSpeed * SimSeconds;
+    if (Altitude <= 0)
+    {
+      Altitude = 0;
+      Airborne = FALSE;
+      TouchdownSinkRate = -VerticalSpeed;
+      VerticalSpeed = 0;
+      TimeOnGround = 0;
+    }
+  }
+  else if (TakingOff)
+  {
+    GroundSpeed += TAKEOFF_ACCELERATION * ForwardThrust * SimSeconds;
+    if (GroundSpeed >= RotationSpeed)
+    {
+      TakingOff = FALSE;
+      Airborne = TRUE;
+      VerticalSpeed = TakeoffClimbRate;
+      TargetSpeed = GroundSpeed;
+    }
+  }
+  else
+  {
+    TimeOnGround += SimSeconds;
+
+    float Brakes = Stub_GetDataf("sim/cockpit2/controls/left_brake_ratio");
+    float RightBrake = Stub_GetDataf("sim/cockpit2/controls/right_brake_ratio");
+    float ParkingBrake = Stub_GetDataf("sim/cockpit2/controls/parking_brake_ratio");
+    if (RightBrake > Brakes) Brakes = RightBrake;
+    if (ParkingBrake > Brakes) Brakes = ParkingBrake;
+
+    float Deceleration = ROLLING_DECELERATION + BRAKE_DECELERATION * Brakes + ReverseDeceleration;
+    GroundSpeed = MoveTowards(GroundSpeed, 0, Deceleration * SimSeconds);
+  }
+
+  FlightTime += SimSeconds;
+  WriteDatarefs();
+}
+
+// returns TRUE if the aircraft is on the ground and stopped
+bool FlightModel_IsStopped
+  (
+  void
+  )
+{
+  return (Airborne == FALSE) && (GroundSpeed == 0);
+}
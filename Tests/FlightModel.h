@@ -0,0 +1,90 @@
+#ifndef _FLIGHTMODELH_
+#define _FLIGHTMODELH_
+
+#include "Global.h"
+
+// height of the pilots head when nothing has moved it, in m
+#define FLIGHT_MODEL_HEAD_Y 0.6f
+// number of engines of the aircraft
+#define FLIGHT_MODEL_NUM_ENGINES 2
+
+// places the aircraft on the runway, stopped with the engines at idle
+// the aircraft is a two engined 737 that the landing throttle manager knows
+extern void FlightModel_Init
+  (
+  void
+  );
+
+// puts the aircraft on an approach to the runway
+extern void FlightModel_StartApproach
+  (
+  float Altitude,    // height above the ground in m
+  float Airspeed,    // indicated airspeed in knots
+  float SinkRate,    // m/s, also the sink rate at touch down
+  float Flaps,       // flap angle in degrees
+  float GearRatio,   // 0 = up to 1 = down
+  float Throttle     // 0 = idle to 1 = full
+  );
+
+// starts a take off roll at full throttle, the aircraft lifts off and climbs when it
+// reaches the rotation speed
+extern void FlightModel_Takeoff
+  (
+  float RotationSpeed,  // indicated airspeed in knots
+  float ClimbRate       // m/s after lifting off
+  );
+
+// changes the climb rate and the airspeed while flying
+// the climb rate changes at once and the airspeed changes gradually
+extern void FlightModel_Fly
+  (
+  float ClimbRate,  // m/s, negative to descend
+  float Airspeed    // indicated airspeed in knots
+  );
+
+// sets the flaps, gear and throttles, as the pilot would
+extern void FlightModel_Configure
+  (
+  float Flaps,      // flap angle in degrees
+  float GearRatio,  // 0 = up to 1 = down
+  float Throttle    // 0 = idle to 1 = full
+  );
+
+// sets the throttles to full and climbs away
+extern void FlightModel_GoAround
+  (
+  void
+  );
+
+// stops an engine
+extern void FlightModel_FailEngine
+  (
+  int Engine
+  );
+
+// stops the throttles from moving, as a hardware throttle would
+extern void FlightModel_SetStuckThrottle
+  (
+  bool Stuck
+  );
+
+// stops the head from moving, as the user or another plugin would
+extern void FlightModel_SetStuckHead
+  (
+  bool Stuck
+  );
+
+// moves the aircraft on by one frame, following the commands and datarefs set by the plugin
+// nothing moves while paused and the time compression is used, as in x-plane
+extern void FlightModel_Step
+  (
+  float Seconds  // length of the frame
+  );
+
+// returns TRUE if the aircraft is on the ground and stopped
+extern bool FlightModel_IsStopped
+  (
+  void
+  );
+
+#endif // _FLIGHTMODELH_
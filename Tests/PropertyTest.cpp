@@ -0,0 +1,669 @@
+// PROPERTY TEST
+
+// Runs the plugin against the XPLM stub with random sequences of frames,
+// user actions, x-plane messages and failures, and checks after every frame
+// that the state machines keep their promises:
+//   - no command is left held when nothing is using it, and nothing is held
+//     after a new flight starts or the plugin is disabled
+//   - no state is waited in for longer than its timeout
+//   - the head is back where it started at the end of the touch down motion
+//   - nothing at all is done while the plugin is disabled
+//   - the controls stay within their ranges and the SDK is used correctly
+// Each random input is a string of bytes that is decoded into the actions,
+// so the same code runs from a seed on the command line or under libFuzzer
+// The inputs are run in sessions of a few hours of x-plane time, each in a
+// new process, and a failure can be repeated by starting at the first seed
+// of its session
+// Usage: PropertyTest [seconds to run] [first seed]
+// Build with FUZZER=1 and clang -fsanitize=fuzzer for libFuzzer instead
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "XPLMStub.h"
+#include "FlightModel.h"
+#include "Config.h"
+#include "HeadCompositor.h"
+#include "HeadBaseline.h"
+#include "Timing.h"
+
+#ifndef FUZZER
+#define FUZZER 0
+#endif
+
+// configuration section
+// length of a frame, in seconds
+#define FRAME_TIME (1.0f / 90.0f)
+// bytes in each random input
+#define INPUT_SIZE 64
+// default time to run for, in seconds
+#define DEFAULT_RUN_TIME 60
+// longest session, in seconds of x-plane time
+#define SESSION_LENGTH (4 * 3600.0)
+// allowance for the frame rate and state machine interval when timing states, in seconds
+#define STATE_TIME_MARGIN 0.1
+// largest distance from the start of the touch down motion that the head can be left, in m
+#define HEAD_RESTORE_TOLERANCE 0.02f
+// shortest time the plugin leaves between phrases, see Speech.cpp
+#define MIN_SPEECH_GAP (1.5 - 0.01)
+// propeller modes
+#define PROP_MODE_NORMAL  1
+#define PROP_MODE_REVERSE 3
+
+// states of the landing throttle manager, see LandingThrottleManager.cpp
+#define LTM_WAIT_FOR_USER           0
+#define LTM_START                   1
+#define LTM_THROTTLE_DOWN           2
+#define LTM_WAIT_FOR_IDLE_THROTTLE  3
+#define LTM_APPLY_REVERSE           5
+
+// states of the head motion, see HeadMotion.cpp
+#define HEAD_START               0
+#define HEAD_WAIT_FOR_FLYING     1
+#define HEAD_WAIT_FOR_LANDING    2
+#define HEAD_TOUCHDOWN           3
+#define HEAD_MOVE_UP             4
+#define HEAD_RESTORING_POSITION  5
+#define HEAD_WAIT_FOR_NOSE       6
+
+// the actions that a random input is made of
+typedef enum _action_t
+{
+  ACTION_RUN_FRAMES,
+  ACTION_RUN_MORE_FRAMES,
+  ACTION_RUN_MANY_FRAMES,
+  ACTION_ENABLE_MANAGER,
+  ACTION_DISARM_MANAGER,
+  ACTION_AUTOBRAKE,
+  ACTION_PARKING_BRAKE,
+  ACTION_TOGGLE_HEAD_MOTION,
+  ACTION_CONTROL_DATAREF,
+  ACTION_MESSAGE,
+  ACTION_DISABLE,
+  ACTION_FAIL_ENGINE,
+  ACTION_STUCK_THROTTLE,
+  ACTION_STUCK_HEAD,
+  ACTION_GO_AROUND,
+  ACTION_MENU_ITEM,
+  NUM_ACTIONS
+} action_t;
+
+// what a session ran
+typedef struct _session_t
+{
+  unsigned long long NextSeed;  // seed after the last input
+  unsigned long long Frames;
+  int Inputs;
+} session_t;
+
+// a random input being decoded
+typedef struct _input_t
+{
+  const uint8_t *Data;
+  size_t Size;
+  size_t Position;
+} input_t;
+
+static bool Started = FALSE;
+static unsigned long long Seed;
+static unsigned long long SessionSeed;
+static unsigned long long Frames;
+
+// what was seen on the last frame
+static int ManagerState;
+static int HeadState;
+static double ManagerStateTime;
+static double HeadStateTime;
+static int IdleFrames;
+// TRUE if the touch down motion was stopped before it could finish
+static bool MotionInterrupted;
+static bool HeadStuck;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// reports a broken invariant and stops
+static void Fail
+  (
+  const char *Format,
+  ...
+  )
+{
+  va_list Args;
+  va_start(Args, Format);
+  fprintf(stderr, "FAIL seed %llu frame %llu (session from seed %llu): ", Seed, Frames, SessionSeed);
+  vfprintf(stderr, Format, Args);
+  fprintf(stderr, "\n");
+  va_end(Args);
+#if FUZZER == 1
+  abort();
+#else
+  // the plugin's file watchers are still running so don't clean up
+  fflush(NULL);
+  _exit(1);
+#endif
+}
+
+// gets the next byte of an input
+// returns the byte, or 0 when the input has run out
+static unsigned int NextByte
+  (
+  input_t *Input
+  )
+{
+  if (Input->Position >= Input->Size) return 0;
+  return Input->Data[Input->Position++];
+}
+
+// starts watching the states again, after anything that can change them without a frame
+static void RestartStateTimes
+  (
+  void
+  )
+{
+  ManagerState = Stub_GetDatai("xvrtools/landing_throttle_manager/state");
+  HeadState = Stub_GetDatai("xvrtools/head_motion/state");
+  ManagerStateTime = Stub_GetTime();
+  HeadStateTime = Stub_GetTime();
+  IdleFrames = 0;
+}
+
+// checks that nothing is left held or moved, after a new flight or the plugin being disabled
+static void CheckReleased
+  (
+  const char *Cause
+  )
+{
+  if (Stub_GetNumHeldCommands() != 0) Fail("%d commands held after %s", Stub_GetNumHeldCommands(), Cause);
+  if ((Stub_GetDataf("sim/cockpit2/controls/left_brake_ratio") != 0) || (Stub_GetDataf("sim/cockpit2/controls/right_brake_ratio") != 0))
+  {
+    Fail("brakes left on after %s", Cause);
+  }
+  for (int e = 0; e < FLIGHT_MODEL_NUM_ENGINES; e++)
+  {
+    if (Stub_GetDatavi("sim/cockpit2/engine/actuators/prop_mode", e) != PROP_MODE_NORMAL) Fail("engine %d left in reverse after %s", e, Cause);
+  }
+  if (Stub_GetDatai("xvrtools/landing_throttle_manager/state") != LTM_WAIT_FOR_USER) Fail("throttle manager still active after %s", Cause);
+}
+
+// checks the invariants that hold after every frame
+static void CheckFrame
+  (
+  unsigned long long LoopCallsBefore
+  )
+{
+  if (Stub_GetErrors() != 0) Fail("SDK misused: %s", Stub_DescribeErrors());
+  if (Stub_GetNumLoopCalls() == LoopCallsBefore) Fail("flight loop not called while enabled");
+  if (Stub_GetMinSpeechGap() < MIN_SPEECH_GAP) Fail("phrases spoken %.3fs apart", Stub_GetMinSpeechGap());
+
+  // the controls stay within their ranges
+  static const char *Ratios[] =
+  {
+    "sim/cockpit2/controls/left_brake_ratio",
+    "sim/cockpit2/controls/right_brake_ratio",
+    "sim/cockpit2/controls/parking_brake_ratio"
+  };
+  for (int r = 0; r < 3; r++)
+  {
+    float Ratio = Stub_GetDataf(Ratios[r]);
+    if ((Ratio < 0) || (Ratio > 1.0f)) Fail("%s is %f", Ratios[r], Ratio);
+  }
+  for (int e = 0; e < FLIGHT_MODEL_NUM_ENGINES; e++)
+  {
+    float Throttle = Stub_GetDatavf("sim/cockpit2/engine/actuators/throttle_ratio", e);
+    if ((Throttle < 0) || (Throttle > 1.0f)) Fail("throttle %d is %f", e, Throttle);
+    int PropMode = Stub_GetDatavi("sim/cockpit2/engine/actuators/prop_mode", e);
+    if ((PropMode != PROP_MODE_NORMAL) && (PropMode != PROP_MODE_REVERSE)) Fail("prop mode %d is %d", e, PropMode);
+  }
+
+  // no state is waited in for longer than its timeout
+  const config_t *Config = Config_Get();
+  double Now = Stub_GetTime();
+  int NewManagerState = Stub_GetDatai("xvrtools/landing_throttle_manager/state");
+  if (NewManagerState != ManagerState)
+  {
+    ManagerState = NewManagerState;
+    ManagerStateTime = Now;
+  }
+  double ManagerLimit = 0;
+  switch (ManagerState)
+  {
+    case LTM_START:
+    case LTM_THROTTLE_DOWN:
+    case LTM_APPLY_REVERSE:
+      ManagerLimit = 2 * Config->ThrottleManagerInterval;
+      break;
+
+    case LTM_WAIT_FOR_IDLE_THROTTLE:
+      ManagerLimit = Config->IdleThrottleTimeout + 2 * Config->ThrottleManagerInterval;
+      break;
+  }
+  if ((ManagerLimit > 0) && (Now - ManagerStateTime > ManagerLimit + STATE_TIME_MARGIN))
+  {
+    Fail("throttle manager in state %d for %.2fs", ManagerState, Now - ManagerStateTime);
+  }
+
+  int NewHeadState = Stub_GetDatai("xvrtools/head_motion/state");
+  if (NewHeadState != HeadState)
+  {
+    // the head is back where it started at the end of the motion
+    if ((HeadState == HEAD_RESTORING_POSITION) && ((NewHeadState == HEAD_WAIT_FOR_FLYING) || (NewHeadState == HEAD_WAIT_FOR_NOSE)) &&
+      (MotionInterrupted == FALSE) && (HeadStuck == FALSE))
+    {
+      float Distance = HeadCompositor_GetBaseAxis(HEAD_Y) - HeadBaseline_GetAxis(HEAD_Y);
+      if ((Distance > HEAD_RESTORE_TOLERANCE) || (Distance < -HEAD_RESTORE_TOLERANCE)) Fail("head left %.3fm from where it started", Distance);
+    }
+    if (NewHeadState == HEAD_TOUCHDOWN) MotionInterrupted = FALSE;
+    HeadState = NewHeadState;
+    HeadStateTime = Now;
+  }
+  double HeadLimit = 0;
+  switch (HeadState)
+  {
+    case HEAD_TOUCHDOWN:
+      HeadLimit = Config->HeadMoveTimeout;
+      break;
+
+    case HEAD_MOVE_UP:
+      HeadLimit = Config->HeadMotionFastInterval;
+      break;
+
+    case HEAD_RESTORING_POSITION:
+      HeadLimit = 2 * Config->HeadMoveTimeout;
+      break;
+  }
+  if ((HeadLimit > 0) && (Now - HeadStateTime > HeadLimit + STATE_TIME_MARGIN))
+  {
+    Fail("head motion in state %d for %.2fs", HeadState, Now - HeadStateTime);
+  }
+
+  // nothing is held when nothing is using it
+  bool HeadMoving = (HeadState == HEAD_TOUCHDOWN) || (HeadState == HEAD_MOVE_UP) || (HeadState == HEAD_RESTORING_POSITION);
+  if ((ManagerState == LTM_WAIT_FOR_USER) && (HeadMoving == FALSE))
+  {
+    if ((++IdleFrames >= 2) && (Stub_GetNumHeldCommands() != 0))
+    {
+      Fail("commands held while idle: down %d, up %d, throttle down %d", Stub_IsCommandHeld("sim/general/down"),
+        Stub_IsCommandHeld("sim/general/up"), Stub_IsCommandHeld("sim/engines/throttle_down"));
+    }
+  }
+  else
+  {
+    IdleFrames = 0;
+  }
+}
+
+// runs a number of frames, checking after each one
+static void RunFrames
+  (
+  int Count
+  )
+{
+  for (int f = 0; f < Count; f++)
+  {
+    FlightModel_Step(FRAME_TIME);
+    unsigned long long LoopCalls = Stub_GetNumLoopCalls();
+    Stub_RunFrame(FRAME_TIME);
+    Stub_DrawWindows();
+    Frames++;
+    CheckFrame(LoopCalls);
+  }
+}
+
+// disables the plugin for a number of frames then enables it again
+static void RunDisabled
+  (
+  int Count
+  )
+{
+  XPluginDisable();
+  CheckReleased("disable");
+  if (Stub_GetNumScheduledLoops() != 0) Fail("%d flight loops scheduled while disabled", Stub_GetNumScheduledLoops());
+  if (Stub_GetNumHandlers() != 0) Fail("%d command handlers registered while disabled", Stub_GetNumHandlers());
+  if (Stub_GetNumVisibleWindows() != 0) Fail("%d windows shown while disabled", Stub_GetNumVisibleWindows());
+  MotionInterrupted = TRUE;
+
+  // a disabled plugin costs nothing
+  for (int f = 0; f < Count; f++)
+  {
+    FlightModel_Step(FRAME_TIME);
+    unsigned long long Calls = Stub_GetNumCalls();
+    unsigned long long LoopCalls = Stub_GetNumLoopCalls();
+    Stub_RunFrame(FRAME_TIME);
+    Stub_DrawWindows();
+    Frames++;
+    if (Stub_GetNumCalls() != Calls) Fail("%llu SDK calls while disabled", Stub_GetNumCalls() - Calls);
+    if (Stub_GetNumLoopCalls() != LoopCalls) Fail("flight loop called while disabled");
+  }
+
+  XPluginEnable();
+  RestartStateTimes();
+}
+
+// places the aircraft for a new flight and starts a random approach
+static void StartFlight
+  (
+  input_t *Input
+  )
+{
+  FlightModel_Init();
+  HeadStuck = FALSE;
+  MotionInterrupted = TRUE;
+  XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_PLANE_LOADED, (void *)0);
+  XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_AIRPORT_LOADED, NULL);
+  CheckReleased("new flight");
+  RestartStateTimes();
+
+  float Altitude = 5.0f + NextByte(Input) * 0.3f;
+  float Airspeed = 120.0f + NextByte(Input) * 0.25f;
+  float SinkRate = 0.2f + NextByte(Input) * 0.011f;
+  static const float FlapSettings[] = { 15.0f, 30.0f, 30.0f, 40.0f };
+  float Flaps = FlapSettings[NextByte(Input) & 3];
+  float GearRatio = (NextByte(Input) & 7) ? 1.0f : 0.5f;
+  float Throttle = NextByte(Input) / 400.0f;
+  FlightModel_StartApproach(Altitude, Airspeed, SinkRate, Flaps, GearRatio, Throttle);
+}
+
+// sends a random message from x-plane
+static void SendMessage
+  (
+  unsigned int Choice
+  )
+{
+  switch (Choice % 6)
+  {
+    case 0:
+      XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_PLANE_CRASHED, NULL);
+      CheckReleased("crash");
+      MotionInterrupted = TRUE;
+      break;
+
+    case 1:
+      XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_SCENERY_LOADED, NULL);
+      MotionInterrupted = TRUE;
+      break;
+
+    case 2:
+      XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_ENTERED_VR, NULL);
+      break;
+
+    case 3:
+      XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_EXITING_VR, NULL);
+      break;
+
+    case 4:
+      // another aircraft, which is not ours
+      XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_PLANE_LOADED, (void *)1);
+      break;
+
+    case 5:
+      XPluginReceiveMessage(XPLM_PLUGIN_XPLANE, XPLM_MSG_PLANE_UNLOADED, (void *)0);
+      CheckReleased("unload");
+      MotionInterrupted = TRUE;
+      break;
+  }
+  RestartStateTimes();
+}
+
+// runs one random input from the start of a flight
+static void RunInput
+  (
+  const uint8_t *Data,
+  size_t Size
+  )
+{
+  static const char *AutobrakeItems[] = { "Off", "Low", "Medium", "High" };
+  static const char *BrakeCommands[] =
+  {
+    "XVRTools//Parking Brake//Release",
+    "XVRTools//Parking Brake//Hold",
+    "XVRTools//Parking Brake//Pulse"
+  };
+  static const char *Controls[] =
+  {
+    "xvrtools/control/landing_throttle_manager_arm",
+    "xvrtools/control/touchdown_motion_enable",
+    "xvrtools/control/parking_brake_release"
+  };
+
+  // most of the time is spent flying, with the odd action and failure
+  static const action_t Actions[] =
+  {
+    ACTION_RUN_FRAMES, ACTION_RUN_FRAMES, ACTION_RUN_FRAMES, ACTION_RUN_FRAMES, ACTION_RUN_FRAMES, ACTION_RUN_FRAMES,
+    ACTION_RUN_MORE_FRAMES, ACTION_RUN_MORE_FRAMES, ACTION_RUN_MORE_FRAMES, ACTION_RUN_MORE_FRAMES,
+    ACTION_RUN_MANY_FRAMES, ACTION_RUN_MANY_FRAMES,
+    ACTION_ENABLE_MANAGER, ACTION_ENABLE_MANAGER, ACTION_ENABLE_MANAGER, ACTION_ENABLE_MANAGER,
+    ACTION_DISARM_MANAGER, ACTION_AUTOBRAKE, ACTION_AUTOBRAKE, ACTION_PARKING_BRAKE, ACTION_TOGGLE_HEAD_MOTION,
+    ACTION_CONTROL_DATAREF, ACTION_MESSAGE, ACTION_DISABLE, ACTION_FAIL_ENGINE, ACTION_STUCK_THROTTLE,
+    ACTION_STUCK_HEAD, ACTION_GO_AROUND, ACTION_MENU_ITEM
+  };
+  const unsigned int NumActions = sizeof(Actions) / sizeof(action_t);
+
+  input_t Input = { Data, Size, 0 };
+  StartFlight(&Input);
+
+  while (Input.Position < Input.Size)
+  {
+    action_t Action = Actions[NextByte(&Input) % NumActions];
+    unsigned int Value = NextByte(&Input);
+
+    switch (Action)
+    {
+      case ACTION_RUN_FRAMES:
+        RunFrames(1 + (Value & 63));
+        break;
+
+      case ACTION_RUN_MORE_FRAMES:
+        RunFrames(1 + Value);
+        break;
+
+      case ACTION_RUN_MANY_FRAMES:
+        RunFrames(1 + Value * 4);
+        break;
+
+      case ACTION_ENABLE_MANAGER:
+        Stub_TriggerCommand("XVRTools//Landing Throttle Manager//Enable");
+        break;
+
+      case ACTION_DISARM_MANAGER:
+        Stub_ChooseMenuItem("Landing Throttle Manager", "Stop and disable");
+        break;
+
+      case ACTION_AUTOBRAKE:
+        Stub_ChooseMenuItem("Autobrake", AutobrakeItems[Value & 3]);
+        break;
+
+      case ACTION_PARKING_BRAKE:
+        Stub_TriggerCommand(BrakeCommands[Value % 3]);
+        break;
+
+      case ACTION_TOGGLE_HEAD_MOTION:
+        Stub_ChooseMenuItem("Head Motion", "Enable touch-down motion");
+        MotionInterrupted = TRUE;
+        break;
+
+      case ACTION_CONTROL_DATAREF:
+        Stub_SetDatai(Controls[Value % 3], (Value >> 2) & 1);
+        if (Value % 3 == 1) MotionInterrupted = TRUE;
+        break;
+
+      case ACTION_MESSAGE:
+        if (Value % 8 == 7)
+        {
+          StartFlight(&Input);
+        }
+        else
+        {
+          SendMessage(Value);
+        }
+        break;
+
+      case ACTION_DISABLE:
+        RunDisabled(1 + (Value & 127));
+        break;
+
+      case ACTION_FAIL_ENGINE:
+        FlightModel_FailEngine(Value & 1);
+        break;
+
+      case ACTION_STUCK_THROTTLE:
+        FlightModel_SetStuckThrottle((Value & 1) != 0);
+        break;
+
+      case ACTION_STUCK_HEAD:
+        FlightModel_SetStuckHead(TRUE);
+        HeadStuck = TRUE;
+        break;
+
+      case ACTION_GO_AROUND:
+        FlightModel_GoAround();
+        break;
+
+      case ACTION_MENU_ITEM:
+        Stub_ChooseMenuItemIndex(Value);
+        MotionInterrupted = TRUE;
+        RestartStateTimes();
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  // let the flight finish
+  RunFrames(90 * 20);
+}
+
+// starts the stub and the plugin, once for all inputs
+static void StartPlugin
+  (
+  void
+  )
+{
+  if (!Stub_StartPlugin()) exit(1);
+  FlightModel_Init();
+  Started = TRUE;
+}
+
+#if FUZZER == 0
+
+// makes the next random number (xorshift64*)
+static unsigned long long Random
+  (
+  unsigned long long *State
+  )
+{
+  *State ^= *State >> 12;
+  *State ^= *State << 25;
+  *State ^= *State >> 27;
+  return *State * 2685821657736338717ull;
+}
+
+
+// makes the random input for a seed
+static void MakeInput
+  (
+  unsigned long long InputSeed,
+  uint8_t *Data  // filled with INPUT_SIZE bytes
+  )
+{
+  unsigned long long State = InputSeed * 0x9E3779B97F4A7C15ull + 1;
+  for (int b = 0; b < INPUT_SIZE; b++) Data[b] = (uint8_t)(Random(&State) >> 56);
+}
+
+// runs inputs in a new process, so the plugin starts from nothing as it would when x-plane starts
+// x-plane's elapsed time is a float, so each session is kept to a realistic length
+// returns TRUE if all of the inputs passed
+static bool RunSession
+  (
+  unsigned long long FirstSeed,  // seed of the first input
+  double EndTime,                // time to stop after, unless the session ends first
+  session_t *Result              // filled with what was run
+  )
+{
+  int Pipe[2];
+  if (pipe(Pipe) != 0) return FALSE;
+
+  pid_t Child = fork();
+  if (Child < 0) return FALSE;
+  if (Child == 0)
+  {
+    close(Pipe[0]);
+    SessionSeed = FirstSeed;
+    StartPlugin();
+
+    uint8_t Data[INPUT_SIZE];
+    Result->Inputs = 0;
+    for (Seed = FirstSeed; (Result->Inputs == 0) || ((Stub_GetTime() < SESSION_LENGTH) && (Timing_GetTime() < EndTime)); Seed++)
+    {
+      MakeInput(Seed, Data);
+      RunInput(Data, INPUT_SIZE);
+      Result->Inputs++;
+    }
+    Result->NextSeed = Seed;
+    Result->Frames = Frames;
+
+    Stub_StopPlugin();
+    bool Written = write(Pipe[1], Result, sizeof(session_t)) == sizeof(session_t);
+    _exit(Written ? 0 : 1);
+  }
+
+  close(Pipe[1]);
+  bool Read = read(Pipe[0], Result, sizeof(session_t)) == sizeof(session_t);
+  close(Pipe[0]);
+  int Status;
+  waitpid(Child, &Status, 0);
+  return Read && WIFEXITED(Status) && (WEXITSTATUS(Status) == 0);
+}
+
+
+#endif // FUZZER
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PROGRAM
+
+#if FUZZER == 1
+
+// called by libFuzzer with each input
+extern "C" int LLVMFuzzerTestOneInput
+  (
+  const uint8_t *Data,
+  size_t Size
+  )
+{
+  if (Started == FALSE) StartPlugin();
+  RunInput(Data, Size);
+  return 0;
+}
+
+#else
+
+int main
+  (
+  int argc,
+  char **argv
+  )
+{
+  double RunTime = argc > 1 ? atof(argv[1]) : DEFAULT_RUN_TIME;
+  unsigned long long NextSeed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+
+  double StartTime = Timing_GetTime();
+  unsigned long long TotalFrames = 0;
+  int TotalInputs = 0;
+  do
+  {
+    session_t Session;
+    if (!RunSession(NextSeed, StartTime + RunTime, &Session)) return 1;
+    NextSeed = Session.NextSeed;
+    TotalFrames += Session.Frames;
+    TotalInputs += Session.Inputs;
+  } while (Timing_GetTime() - StartTime < RunTime);
+
+  double Elapsed = Timing_GetTime() - StartTime;
+  printf("PASS %d inputs, %llu frames in %.1fs, %.2f million frames per minute\n", TotalInputs, TotalFrames, Elapsed, TotalFrames / Elapsed * 60.0 / 1e6);
+  return 0;
+}
+
+#endif // FUZZER
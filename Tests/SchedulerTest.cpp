@@ -0,0 +1,232 @@
+// SCHEDULER TEST
+
+// Checks that the SDK's XPCProcess wrapper still works now that it runs as a
+// task of the plugin's scheduler instead of a flight loop of its own:
+//   - a process started for a time runs at that interval
+//   - a process started for a number of frames runs every that many frames
+//   - a process can stop itself from inside its processing
+//   - nothing runs while the plugin is disabled and it carries on afterwards
+//   - a deleted process doesn't run again and its task can be used again
+// Each test runs in its own process so the plugin starts from nothing
+// Usage: SchedulerTest
+
+#include <stdlib.h>
+#include <math.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "XPLMStub.h"
+#include "Scheduler.h"
+#include "XPCProcessing.h"
+
+// configuration section
+// length of a frame, in seconds
+#define FRAME_TIME (1.0f / 90.0f)
+
+// a process that counts how often it runs
+class CountingProcess : public XPCProcess
+{
+public:
+  CountingProcess() : Calls(0), LastElapsed(0), StopAfter(0) {}
+
+  virtual void DoProcessing
+    (
+    float inElapsedSinceLastCall,
+    float inElapsedTimeSinceLastFlightLoop,
+    int inCounter
+    )
+  {
+    Calls++;
+    LastElapsed = inElapsedSinceLastCall;
+    if ((StopAfter > 0) && (Calls >= StopAfter)) StopProcess();
+  }
+
+  int Calls;
+  float LastElapsed;  // time since the process last ran, as given to it
+  int StopAfter;      // number of calls after which it stops itself, 0 to keep going
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// reports a failed check and stops
+static void Fail
+  (
+  const char *Format,
+  ...
+  )
+{
+  va_list Args;
+  va_start(Args, Format);
+  fprintf(stderr, "FAIL at %.3fs: ", Stub_GetTime());
+  vfprintf(stderr, Format, Args);
+  fprintf(stderr, "\n");
+  va_end(Args);
+  // the plugin's file watchers are still running so don't clean up
+  fflush(NULL);
+  _exit(1);
+}
+
+// runs a number of frames of the plugin
+static void RunFrames
+  (
+  int Count
+  )
+{
+  for (int f = 0; f < Count; f++) Stub_RunFrame(FRAME_TIME);
+}
+
+// waits for a process to finish
+// returns TRUE if it passed
+static bool WaitFor
+  (
+  pid_t Child
+  )
+{
+  int Status;
+  if (waitpid(Child, &Status, 0) != Child) return FALSE;
+  return WIFEXITED(Status) && (WEXITSTATUS(Status) == 0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TESTS
+
+// a process started for a time runs at that interval
+static void TestTime
+  (
+  void
+  )
+{
+  CountingProcess Process;
+  RunFrames(90);
+  if (Process.Calls != 0) Fail("process ran %d times before it was started", Process.Calls);
+
+  Process.StartProcessTime(0.5f);
+  RunFrames(90 * 10);
+  if (abs(Process.Calls - 20) > 1) Fail("process ran %d times in 10s at 0.5s intervals", Process.Calls);
+  if (fabs(Process.LastElapsed - 0.5f) > FRAME_TIME) Fail("process was given %fs since it last ran", Process.LastElapsed);
+}
+
+// a process started for a number of frames runs every that many frames
+static void TestCycles
+  (
+  void
+  )
+{
+  CountingProcess Process;
+  Process.StartProcessCycles(3);
+  RunFrames(90);
+  if (abs(Process.Calls - 30) > 1) Fail("process ran %d times in 90 frames at 3 frame intervals", Process.Calls);
+
+  Process.StartProcessCycles(1);
+  int Before = Process.Calls;
+  RunFrames(90);
+  if (Process.Calls - Before != 90) Fail("process ran %d times in 90 frames at every frame", Process.Calls - Before);
+}
+
+// a process can stop itself from inside its processing
+static void TestStop
+  (
+  void
+  )
+{
+  CountingProcess Process;
+  Process.StopAfter = 5;
+  Process.StartProcessCycles(1);
+  RunFrames(90);
+  if (Process.Calls != 5) Fail("process ran %d times after stopping itself after 5", Process.Calls);
+
+  // and be stopped from outside
+  Process.StopAfter = 0;
+  Process.StartProcessCycles(1);
+  RunFrames(10);
+  Process.StopProcess();
+  int Before = Process.Calls;
+  RunFrames(90);
+  if (Process.Calls != Before) Fail("process ran %d times after it was stopped", Process.Calls - Before);
+}
+
+// nothing runs while the plugin is disabled and it carries on afterwards
+static void TestDisabled
+  (
+  void
+  )
+{
+  CountingProcess Process;
+  Process.StartProcessCycles(1);
+  RunFrames(10);
+
+  XPluginDisable();
+  int Before = Process.Calls;
+  RunFrames(90);
+  if (Process.Calls != Before) Fail("process ran %d times while the plugin was disabled", Process.Calls - Before);
+
+  XPluginEnable();
+  RunFrames(90);
+  if (Process.Calls - Before < 89) Fail("process ran %d times in 90 frames after the plugin was enabled", Process.Calls - Before);
+}
+
+// a deleted process doesn't run again and its task can be used again
+static void TestDelete
+  (
+  void
+  )
+{
+  CountingProcess *First = new CountingProcess;
+  First->StartProcessCycles(1);
+  RunFrames(10);
+  delete First;
+  RunFrames(10);
+
+  // more processes than there is room for tasks, one at a time
+  for (int p = 0; p < 2 * SCHEDULER_MAX_TASKS; p++)
+  {
+    CountingProcess Process;
+    Process.StartProcessCycles(1);
+    RunFrames(10);
+    if (Process.Calls != 10) Fail("process %d ran %d times in 10 frames", p, Process.Calls);
+  }
+}
+
+// runs a test in a new process with the plugin started
+// returns TRUE if it passed
+static bool RunTest
+  (
+  const char *Name,
+  void (*Test)(void)
+  )
+{
+  pid_t Child = fork();
+  if (Child == 0)
+  {
+    if (!Stub_StartPlugin()) _exit(1);
+    Test();
+    if (Stub_GetErrors() != 0) Fail("SDK misused: %s", Stub_DescribeErrors());
+    Stub_StopPlugin();
+    _exit(0);
+  }
+
+  bool Passed = (Child > 0) && WaitFor(Child);
+  printf("%s %s\n", Passed ? "PASS" : "FAIL", Name);
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PROGRAM
+
+int main
+  (
+  int argc,
+  char **argv
+  )
+{
+  bool Passed = TRUE;
+  Passed &= RunTest("process time", TestTime);
+  Passed &= RunTest("process cycles", TestCycles);
+  Passed &= RunTest("process stop", TestStop);
+  Passed &= RunTest("process while disabled", TestDisabled);
+  Passed &= RunTest("process delete", TestDelete);
+  return Passed ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+// STATUS WINDOW TEST
+
+// Checks that the status window only lays out its text when the published
+// state or the settings change, and that drawing it only draws the lines
+// that were laid out:
+//   - every draw draws the same lines and makes no other SDK calls than
+//     getting the window's position and setting the graphics state
+//   - changing a setting without a new settings version isn't shown, and is
+//     once the version changes
+//   - changing the published state without a new version isn't shown, and
+//     is once the version changes
+//   - closing the window with its close button unchecks the menu item and
+//     is remembered in the settings
+// Each test runs in its own process so the plugin starts from nothing
+// Usage: StatusWindowTest
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "XPLMStub.h"
+#include "StatusWindow.h"
+#include "SharedData.h"
+#include "Settings.h"
+
+// configuration section
+// length of a frame, in seconds
+#define FRAME_TIME (1.0f / 90.0f)
+// longest time for closing the window to be noticed, in seconds
+#define CLOSE_TIME 1.0f
+// number of times the window is drawn for each check
+#define NUM_DRAWS 90
+// SDK calls made by a draw besides drawing the lines
+#define DRAW_OVERHEAD_CALLS 2
+// most lines that are kept to compare and their longest length
+#define MAX_LINES       32
+#define MAX_LINE_LENGTH 128
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// reports a failed check and stops
+static void Fail
+  (
+  const char *Format,
+  ...
+  )
+{
+  va_list Args;
+  va_start(Args, Format);
+  fprintf(stderr, "FAIL at %.3fs: ", Stub_GetTime());
+  vfprintf(stderr, Format, Args);
+  fprintf(stderr, "\n");
+  va_end(Args);
+  // the plugin's file watchers are still running so don't clean up
+  fflush(NULL);
+  _exit(1);
+}
+
+// draws the windows and gets the line that starts with some text
+// returns an empty string if there is no such line
+static const char *DrawLine
+  (
+  const char *Start
+  )
+{
+  Stub_DrawWindows();
+  for (int s = 0; s < Stub_GetNumStrings(); s++)
+  {
+    const char *Line = Stub_GetString(s);
+    if (strncmp(Line, Start, strlen(Start)) == 0) return Line;
+  }
+  return "";
+}
+
+// draws the windows a number of times and checks the line that starts with some text is always the same
+static void CheckLine
+  (
+  const char *Start,
+  const char *Expected  // the whole line
+  )
+{
+  for (int d = 0; d < NUM_DRAWS; d++)
+  {
+    const char *Line = DrawLine(Start);
+    if (strcmp(Line, Expected) != 0) Fail("drew \"%s\" instead of \"%s\"", Line, Expected);
+  }
+}
+
+// waits for a process to finish
+// returns TRUE if it passed
+static bool WaitFor
+  (
+  pid_t Child
+  )
+{
+  int Status;
+  if (waitpid(Child, &Status, 0) != Child) return FALSE;
+  return WIFEXITED(Status) && (WEXITSTATUS(Status) == 0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TESTS
+
+// every draw draws the same lines and makes no other SDK calls
+static void TestReplay
+  (
+  void
+  )
+{
+  Stub_DrawWindows();
+  int NumLines = Stub_GetNumStrings();
+  if (NumLines == 0) Fail("no lines were drawn");
+
+  char Lines[MAX_LINES][MAX_LINE_LENGTH];
+  if (NumLines > MAX_LINES) Fail("%d lines were drawn", NumLines);
+  for (int l = 0; l < NumLines; l++) snprintf(Lines[l], sizeof(Lines[l]), "%s", Stub_GetString(l));
+
+  for (int d = 0; d < NUM_DRAWS; d++)
+  {
+    unsigned long long Calls = Stub_GetNumCalls();
+    Stub_DrawWindows();
+    Calls = Stub_GetNumCalls() - Calls;
+
+    if (Stub_GetNumStrings() != NumLines) Fail("drew %d lines instead of %d", Stub_GetNumStrings(), NumLines);
+    for (int l = 0; l < NumLines; l++)
+    {
+      if (strcmp(Stub_GetString(l), Lines[l]) != 0) Fail("drew \"%s\" instead of \"%s\"", Stub_GetString(l), Lines[l]);
+    }
+    if (Calls != (unsigned long long)(NumLines + DRAW_OVERHEAD_CALLS))
+    {
+      Fail("drawing %d lines made %llu SDK calls", NumLines, Calls);
+    }
+  }
+}
+
+// a setting is only shown once the settings version changes
+static void TestSettingsVersion
+  (
+  void
+  )
+{
+  settings_t *Settings = Settings_Get();
+  Settings->GSeatEnabled = FALSE;
+  Settings_Changed();
+  CheckLine("G-seat:", "G-seat: off");
+
+  unsigned int Version = Settings_GetVersion();
+  Settings->GSeatEnabled = TRUE;
+  CheckLine("G-seat:", "G-seat: off");
+  if (Settings_GetVersion() != Version) Fail("drawing changed the settings version");
+
+  Settings_Changed();
+  CheckLine("G-seat:", "G-seat: on");
+}
+
+// the published state is only shown once its version changes
+static void TestDataVersion
+  (
+  void
+  )
+{
+  SharedData_SetLanding(1.5f, 1.2f);
+  CheckLine("Last landing:", "Last landing: 1.5 m/s (295 fpm), 1.20 G");
+
+  // changed behind the module's back, as if a version had been missed
+  unsigned int Version = SharedData_GetVersion();
+  shared_data_t *Data = (shared_data_t *)SharedData_Get();
+  Data->LastSinkRate = 0.5f;
+  CheckLine("Last landing:", "Last landing: 1.5 m/s (295 fpm), 1.20 G");
+  if (SharedData_GetVersion() != Version) Fail("drawing changed the shared data version");
+
+  SharedData_SetLanding(0.5f, 1.1f);
+  CheckLine("Last landing:", "Last landing: 0.5 m/s (98 fpm), 1.10 G");
+}
+
+// closing the window with its close button is the same as hiding it from the menu
+static void TestClose
+  (
+  void
+  )
+{
+  if (!Stub_IsMenuItemChecked("Status Window", "Show")) Fail("menu item isn't checked while the window is showing");
+
+  Stub_CloseWindows();
+  for (int f = 0; f < (int)(CLOSE_TIME / FRAME_TIME); f++) Stub_RunFrame(FRAME_TIME);
+  if (Stub_IsMenuItemChecked("Status Window", "Show")) Fail("menu item is still checked after the window was closed");
+  if (Settings_Get()->StatusWindowVisible) Fail("settings still show the window after it was closed");
+
+  Stub_ChooseMenuItem("Status Window", "Show");
+  if (Stub_GetNumVisibleWindows() != 1) Fail("window isn't showing after choosing it from the menu");
+  if (!Stub_IsMenuItemChecked("Status Window", "Show")) Fail("menu item isn't checked after showing the window");
+  if (!Settings_Get()->StatusWindowVisible) Fail("settings don't show the window after showing it");
+
+  // and stays shown
+  for (int f = 0; f < (int)(CLOSE_TIME / FRAME_TIME); f++) Stub_RunFrame(FRAME_TIME);
+  if (Stub_GetNumVisibleWindows() != 1) Fail("window was hidden again");
+  if (!Stub_IsMenuItemChecked("Status Window", "Show")) Fail("menu item was unchecked again");
+}
+
+// runs a test in a new process with the plugin started and the status window showing
+// returns TRUE if it passed
+static bool RunTest
+  (
+  const char *Name,
+  void (*Test)(void)
+  )
+{
+  // so the results so far aren't printed again by the test
+  fflush(stdout);
+  pid_t Child = fork();
+  if (Child == 0)
+  {
+    if (!Stub_StartPlugin()) _exit(1);
+    Stub_RunFrame(FRAME_TIME);
+    StatusWindow_SetVisible(TRUE);
+    if (Stub_GetNumVisibleWindows() != 1) Fail("%d windows are showing", Stub_GetNumVisibleWindows());
+    Test();
+    if (Stub_GetErrors() != 0) Fail("SDK misused: %s", Stub_DescribeErrors());
+    Stub_StopPlugin();
+    _exit(0);
+  }
+
+  bool Passed = (Child > 0) && WaitFor(Child);
+  printf("%s %s\n", Passed ? "PASS" : "FAIL", Name);
+  return Passed;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PROGRAM
+
+int main
+  (
+  int argc,
+  char **argv
+  )
+{
+  bool Passed = TRUE;
+  Passed &= RunTest("draw replays the lines", TestReplay);
+  Passed &= RunTest("settings version", TestSettingsVersion);
+  Passed &= RunTest("shared data version", TestDataVersion);
+  Passed &= RunTest("close button", TestClose);
+  return Passed ? 0 : 1;
+}
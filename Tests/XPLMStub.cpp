@@ -0,0 +1,1523 @@
+// XPLM STUB
+
+// Stands in for x-plane so the plugin can be run by the tests, on Linux and
+// without a simulator
+// Only the parts of the SDK that the plugin uses are here. Datarefs and sim
+// commands are made the first time they are looked up, so the tests can set
+// any of them, and hold their values until they are changed. Flight loops
+// are called by Stub_RunFrame in the way x-plane calls them, using the time
+// of the stub rather than the computer's clock, so a test runs as fast as it
+// can and gives the same result every time
+// The stub also checks how the plugin uses the SDK: commands ended without
+// being begun, handlers registered twice and so on are counted as errors,
+// and every call to the SDK is counted so a test can check that nothing at
+// all is done while the plugin is disabled
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <dirent.h>
+#include "XPLMStub.h"
+#include "XPLMDisplay.h"
+#include "XPLMGraphics.h"
+
+// most of each thing the plugin can make
+#define MAX_DATAREFS 128
+#define MAX_COMMANDS 64
+#define MAX_HANDLERS 4
+#define MAX_LOOPS    16
+#define MAX_MENUS    32
+#define MAX_ITEMS    16
+#define MAX_WINDOWS  8
+#define MAX_STRINGS  32
+// size of the name look up table, a power of two larger than the datarefs and commands together
+#define HASH_SIZE 512
+// longest path of a file and of the folder it is in
+#define MAX_PATH_LENGTH   512
+#define MAX_FOLDER_LENGTH 256
+// longest string dataref
+#define MAX_BYTES 256
+// longest string that is drawn
+#define MAX_STRING_LENGTH 128
+
+// size of the screen, in boxels
+#define SCREEN_WIDTH  1920
+#define SCREEN_HEIGHT 1080
+
+// a dataref
+typedef struct _stub_dataref_t
+{
+  char Name[STUB_MAX_NAME];
+  int Int;
+  float Float;
+  int IntArray[STUB_MAX_ARRAY];
+  float FloatArray[STUB_MAX_ARRAY];
+  char Bytes[MAX_BYTES];
+  // accessors registered by the plugin, only int and float are used
+  bool Registered;
+  XPLMGetDatai_f ReadInt;
+  XPLMSetDatai_f WriteInt;
+  XPLMGetDataf_f ReadFloat;
+  XPLMSetDataf_f WriteFloat;
+  void *ReadRefcon;
+  void *WriteRefcon;
+} stub_dataref_t;
+
+// a handler registered for a command
+typedef struct _stub_handler_t
+{
+  XPLMCommandCallback_f Handler;  // NULL when the slot is free
+  int Before;
+  void *Refcon;
+} stub_handler_t;
+
+// a command
+typedef struct _stub_command_t
+{
+  char Name[STUB_MAX_NAME];
+  bool Held;
+  stub_handler_t Handlers[MAX_HANDLERS];
+} stub_command_t;
+
+// a flight loop
+typedef struct _stub_loop_t
+{
+  bool Created;
+  XPLMFlightLoop_f Callback;
+  void *Refcon;
+  bool Scheduled;
+  bool InFrames;               // TRUE if it is due after a number of frames rather than a time
+  double NextTime;
+  unsigned long long NextFrame;
+  double LastCall;
+  int Counter;
+} stub_loop_t;
+
+// a menu item
+typedef struct _stub_item_t
+{
+  char Name[STUB_MAX_NAME];
+  void *ItemRef;
+  bool Checked;
+} stub_item_t;
+
+// a menu
+typedef struct _stub_menu_t
+{
+  char Name[STUB_MAX_NAME];
+  XPLMMenuHandler_f Handler;
+  void *MenuRef;
+  int NumItems;
+  stub_item_t Items[MAX_ITEMS];
+} stub_menu_t;
+
+// a window
+typedef struct _stub_window_t
+{
+  bool Visible;
+  XPLMDrawWindow_f Draw;
+  void *Refcon;
+  int Left;
+  int Top;
+  int Right;
+  int Bottom;
+} stub_window_t;
+
+// an entry of the name look up table
+typedef struct _stub_name_t
+{
+  const char *Name;  // NULL when the entry is free
+  bool IsCommand;
+  int Index;
+} stub_name_t;
+
+static stub_dataref_t Datarefs[MAX_DATAREFS];
+static int NumDatarefs;
+static stub_command_t Commands[MAX_COMMANDS];
+static int NumCommands;
+static stub_name_t Names[HASH_SIZE];
+static stub_loop_t Loops[MAX_LOOPS];
+static int NumLoops;
+static stub_menu_t Menus[MAX_MENUS];
+static int NumMenus;
+static stub_window_t Windows[MAX_WINDOWS];
+static int NumWindows;
+// strings drawn by the last Stub_DrawWindows
+static char Strings[MAX_STRINGS][MAX_STRING_LENGTH];
+static int NumStrings;
+
+static double Now;
+static float FrameTime;
+static unsigned long long Frame;
+static unsigned long long NumLoopCalls;
+static unsigned long long NumCalls;
+
+static int NumSpoken;
+static double LastSpoken;
+static double MinSpeechGap;
+
+static int Errors[NUM_STUB_ERRORS];
+static char ErrorText[256];
+
+static char Folder[MAX_FOLDER_LENGTH];
+static FILE *Log = NULL;
+
+// counts a call to the SDK
+#define CALL() (NumCalls++)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// calculates a hash of a name (FNV-1a)
+static unsigned int HashName
+  (
+  const char *Name
+  )
+{
+  unsigned int Hash = 2166136261u;
+  while (*Name)
+  {
+    Hash = (Hash ^ (unsigned char)*Name++) * 16777619u;
+  }
+  return Hash;
+}
+
+// finds a dataref or command by name, making it if it doesn't exist
+// returns the index in its table, or -1 if there is no more space
+static int FindName
+  (
+  const char *Name,
+  bool IsCommand
+  )
+{
+  unsigned int Slot = HashName(Name) & (HASH_SIZE - 1);
+  while (Names[Slot].Name != NULL)
+  {
+    if ((Names[Slot].IsCommand == IsCommand) && (strcmp(Names[Slot].Name, Name) == 0)) return Names[Slot].Index;
+    Slot = (Slot + 1) & (HASH_SIZE - 1);
+  }
+
+  int Index;
+  if (IsCommand)
+  {
+    if (NumCommands == MAX_COMMANDS) return -1;
+    Index = NumCommands++;
+    memset(&Commands[Index], 0, sizeof(stub_command_t));
+    strcpy_s(Commands[Index].Name, STUB_MAX_NAME, Name);
+    Names[Slot].Name = Commands[Index].Name;
+  }
+  else
+  {
+    if (NumDatarefs == MAX_DATAREFS) return -1;
+    Index = NumDatarefs++;
+    memset(&Datarefs[Index], 0, sizeof(stub_dataref_t));
+    strcpy_s(Datarefs[Index].Name, STUB_MAX_NAME, Name);
+    Names[Slot].Name = Datarefs[Index].Name;
+  }
+  Names[Slot].IsCommand = IsCommand;
+  Names[Slot].Index = Index;
+  return Index;
+}
+
+// finds a dataref by name, making it if it doesn't exist
+static stub_dataref_t *GetDataref
+  (
+  const char *Name
+  )
+{
+  int Index = FindName(Name, FALSE);
+  return Index < 0 ? NULL : &Datarefs[Index];
+}
+
+// finds a command by name, making it if it doesn't exist
+static stub_command_t *GetCommand
+  (
+  const char *Name
+  )
+{
+  int Index = FindName(Name, TRUE);
+  return Index < 0 ? NULL : &Commands[Index];
+}
+
+// counts a problem with the way the SDK is used
+static void AddError
+  (
+  stub_error_t Error
+  )
+{
+  Errors[Error]++;
+}
+
+// calls the handlers of a command for one phase
+// returns the number of handlers that were called
+static int CallHandlers
+  (
+  stub_command_t *Command,
+  XPLMCommandPhase Phase
+  )
+{
+  int Called = 0;
+
+  // handlers that want the command first are called first, any of them can stop the rest
+  for (int Before = 1; Before >= 0; Before--)
+  {
+    for (int h = 0; h < MAX_HANDLERS; h++)
+    {
+      stub_handler_t *Handler = &Command->Handlers[h];
+      if ((Handler->Handler == NULL) || (Handler->Before != Before)) continue;
+      Called++;
+      if (Handler->Handler((XPLMCommandRef)Command, Phase, Handler->Refcon) == 0) return Called;
+    }
+  }
+
+  return Called;
+}
+
+// finds a menu by name
+// returns the menu, or NULL if there isn't one
+static stub_menu_t *FindMenu
+  (
+  const char *Name
+  )
+{
+  for (int m = 0; m < NumMenus; m++)
+  {
+    if (strcmp(Menus[m].Name, Name) == 0) return &Menus[m];
+  }
+  return NULL;
+}
+
+// finds an item of a menu by name
+// returns the item index, or -1 if there isn't one
+static int FindItem
+  (
+  const stub_menu_t *Menu,
+  const char *Name
+  )
+{
+  for (int i = 0; i < Menu->NumItems; i++)
+  {
+    if (strcmp(Menu->Items[i].Name, Name) == 0) return i;
+  }
+  return -1;
+}
+
+// gets a window from its ID
+// returns the window, or NULL if the ID isn't a window
+static stub_window_t *GetWindow
+  (
+  XPLMWindowID WindowId
+  )
+{
+  intptr_t Index = (intptr_t)WindowId - 1;
+  if ((Index < 0) || (Index >= NumWindows))
+  {
+    AddError(STUB_ERROR_BAD_HANDLE);
+    return NULL;
+  }
+  return &Windows[Index];
+}
+
+// gets a menu from its ID
+// returns the menu, or NULL if the ID isn't a menu
+static stub_menu_t *GetMenu
+  (
+  XPLMMenuID MenuId
+  )
+{
+  intptr_t Index = (intptr_t)MenuId - 1;
+  if ((Index < 0) || (Index >= NumMenus))
+  {
+    AddError(STUB_ERROR_BAD_HANDLE);
+    return NULL;
+  }
+  return &Menus[Index];
+}
+
+// gets a flight loop from its ID
+// returns the flight loop, or NULL if it isn't one or has been destroyed
+static stub_loop_t *GetLoop
+  (
+  XPLMFlightLoopID LoopId
+  )
+{
+  stub_loop_t *Loop = (stub_loop_t *)LoopId;
+  if ((Loop == NULL) || (Loop->Created == FALSE))
+  {
+    AddError(STUB_ERROR_BAD_HANDLE);
+    return NULL;
+  }
+  return Loop;
+}
+
+// sets when a flight loop is next called, in the same way as the return value of the callback
+static void ScheduleLoop
+  (
+  stub_loop_t *Loop,
+  float Interval,  // seconds, a negative number of frames or 0 to stop
+  double From      // time the interval is counted from
+  )
+{
+  Loop->Scheduled = (Interval != 0);
+  Loop->InFrames = (Interval < 0);
+  if (Interval > 0) Loop->NextTime = From + Interval;
+  if (Interval < 0) Loop->NextFrame = Frame + (unsigned long long)(-Interval + 0.5f);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// STUB API
+
+// starts the stub with no datarefs, commands, flight loops, menus or windows
+void Stub_Init
+  (
+  const char *LogFolder  // folder used for the preferences, the log and the profile report
+  )
+{
+  memset(Names, 0, sizeof(Names));
+  NumDatarefs = 0;
+  NumCommands = 0;
+  NumLoops = 0;
+  NumMenus = 0;
+  NumWindows = 0;
+  NumStrings = 0;
+
+  Now = 0;
+  FrameTime = 0;
+  Frame = 0;
+  NumLoopCalls = 0;
+  NumCalls = 0;
+  NumSpoken = 0;
+  LastSpoken = 0;
+  MinSpeechGap = 1e9;
+  memset(Errors, 0, sizeof(Errors));
+
+  strcpy_s(Folder, MAX_FOLDER_LENGTH, LogFolder);
+  char Path[MAX_PATH_LENGTH];
+  sprintf_s(Path, MAX_PATH_LENGTH, "%s/Log.txt", Folder);
+  if (Log != NULL) fclose(Log);
+  Log = fopen(Path, "w");
+
+  // the plugins menu
+  strcpy_s(Menus[0].Name, STUB_MAX_NAME, "Plugins");
+  Menus[0].Handler = NULL;
+  Menus[0].NumItems = 0;
+  NumMenus = 1;
+
+  // the time runs at the normal rate until a test changes it
+  Stub_SetDataf("sim/time/sim_speed_actual", 1.0f);
+  Stub_SetDatai("sim/time/ground_speed", 1);
+  Stub_SetDatai("sim/time/paused", 0);
+}
+
+// starts the stub in a new folder, then starts and enables the plugin with its clock reading the stub
+// returns TRUE for success, FALSE for error
+bool Stub_StartPlugin
+  (
+  void
+  )
+{
+  char NewFolder[] = "/tmp/XVRToolsTestXXXXXX";
+  if (mkdtemp(NewFolder) == NULL)
+  {
+    fprintf(stderr, "Unable to make a folder for the test\n");
+    return FALSE;
+  }
+  Stub_Init(NewFolder);
+
+  char Name[256];
+  char Signature[256];
+  char Description[256];
+  if (!XPluginStart(Name, Signature, Description))
+  {
+    fprintf(stderr, "Plugin failed to start: %s\n", Description);
+    return FALSE;
+  }
+  XPluginEnable();
+  Clock_SetSource(Stub_ReadClock);
+
+  return TRUE;
+}
+
+// disables and stops the plugin and removes the folder made by Stub_StartPlugin
+void Stub_StopPlugin
+  (
+  void
+  )
+{
+  XPluginDisable();
+  XPluginStop();
+
+  if (Log != NULL) fclose(Log);
+  Log = NULL;
+
+  DIR *Directory = opendir(Folder);
+  if (Directory == NULL) return;
+  struct dirent *Entry;
+  while ((Entry = readdir(Directory)) != NULL)
+  {
+    if (Entry->d_name[0] == '.') continue;
+    char Path[MAX_PATH_LENGTH];
+    sprintf_s(Path, MAX_PATH_LENGTH, "%s/%s", Folder, Entry->d_name);
+    unlink(Path);
+  }
+  closedir(Directory);
+  rmdir(Folder);
+}
+
+// runs one frame, the time moves on and the flight loops that are due are called
+void Stub_RunFrame
+  (
+  float Seconds  // length of the frame
+  )
+{
+  Now += Seconds;
+  FrameTime = Seconds;
+  Frame++;
+
+  // loops made by a callback aren't due until the next frame
+  int Count = NumLoops;
+  for (int l = 0; l < Count; l++)
+  {
+    stub_loop_t *Loop = &Loops[l];
+    if ((Loop->Created == FALSE) || (Loop->Scheduled == FALSE)) continue;
+    if (Loop->InFrames ? (Frame < Loop->NextFrame) : (Now < Loop->NextTime)) continue;
+
+    float SinceLastCall = (float)(Now - Loop->LastCall);
+    Loop->LastCall = Now;
+    NumLoopCalls++;
+    float Interval = Loop->Callback(SinceLastCall, Seconds, ++Loop->Counter, Loop->Refcon);
+    // the loop may have been destroyed by the callback
+    if (Loop->Created) ScheduleLoop(Loop, Interval, Now);
+  }
+}
+
+// gets the time since the stub was started
+// returns the time in seconds
+double Stub_GetTime
+  (
+  void
+  )
+{
+  return Now;
+}
+
+// reads the time from the stub instead of the computer's clock, see Clock_SetSource
+// the pause and time compression come from the usual x-plane datarefs
+void Stub_ReadClock
+  (
+  clock_sample_t *Sample
+  )
+{
+  Sample->Wall = Now;
+  Sample->Paused = Stub_GetDatai("sim/time/paused") != 0;
+  Sample->SimRate = Stub_GetDataf("sim/time/sim_speed_actual") * Stub_GetDatai("sim/time/ground_speed");
+}
+
+// sets the value of a dataref as x-plane would, accessors registered by the plugin are called
+void Stub_SetDataf
+  (
+  const char *Name,
+  float Value
+  )
+{
+  stub_dataref_t *Dataref = GetDataref(Name);
+  if (Dataref == NULL) return;
+  if (Dataref->Registered)
+  {
+    if (Dataref->WriteFloat != NULL) Dataref->WriteFloat(Dataref->WriteRefcon, Value);
+    return;
+  }
+  Dataref->Float = Value;
+}
+
+void Stub_SetDatai
+  (
+  const char *Name,
+  int Value
+  )
+{
+  stub_dataref_t *Dataref = GetDataref(Name);
+  if (Dataref == NULL) return;
+  if (Dataref->Registered)
+  {
+    if (Dataref->WriteInt != NULL) Dataref->WriteInt(Dataref->WriteRefcon, Value);
+    return;
+  }
+  Dataref->Int = Value;
+}
+
+void Stub_SetDatavf
+  (
+  const char *Name,
+  const float *Values,
+  int Count
+  )
+{
+  stub_dataref_t *Dataref = GetDataref(Name);
+  if (Dataref == NULL) return;
+  for (int v = 0; (v < Count) && (v < STUB_MAX_ARRAY); v++) Dataref->FloatArray[v] = Values[v];
+}
+
+void Stub_SetDatavi
+  (
+  const char *Name,
+  const int *Values,
+  int Count
+  )
+{
+  stub_dataref_t *Dataref = GetDataref(Name);
+  if (Dataref == NULL) return;
+  for (int v = 0; (v < Count) && (v < STUB_MAX_ARRAY); v++) Dataref->IntArray[v] = Values[v];
+}
+
+void Stub_SetDatab
+  (
+  const char *Name,
+  const char *Text
+  )
+{
+  stub_dataref_t *Dataref = GetDataref(Name);
+  if (Dataref == NULL) return;
+  strcpy_s(Dataref->Bytes, MAX_BYTES, Text);
+}
+
+// gets the value of a dataref, accessors registered by the plugin are called
+float Stub_GetDataf
+  (
+  const char *Name
+  )
+{
+  stub_dataref_t *Dataref = GetDataref(Name);
+  if (Dataref == NULL) return 0;
+  if (Dataref->Registered) return Dataref->ReadFloat != NULL ? Dataref->ReadFloat(Dataref->ReadRefcon) : 0;
+  return Dataref->Float;
+}
+
+int Stub_GetDatai
+  (
+  const char *Name
+  )
+{
+  stub_dataref_t *Dataref = GetDataref(Name);
+  if (Dataref == NULL) return 0;
+  if (Dataref->Registered) return Dataref->ReadInt != NULL ? Dataref->ReadInt(Dataref->ReadRefcon) : 0;
+  return Dataref->Int;
+}
+
+float Stub_GetDatavf
+  (
+  const char *Name,
+  int Index
+  )
+{
+  stub_dataref_t *Dataref = GetDataref(Name);
+  if ((Dataref == NULL) || (Index < 0) || (Index >= STUB_MAX_ARRAY)) return 0;
+  return Dataref->FloatArray[Index];
+}
+
+int Stub_GetDatavi
+  (
+  const char *Name,
+  int Index
+  )
+{
+  stub_dataref_t *Dataref = GetDataref(Name);
+  if ((Dataref == NULL) || (Index < 0) || (Index >= STUB_MAX_ARRAY)) return 0;
+  return Dataref->IntArray[Index];
+}
+
+// presses and releases a command as the user would, the registered handlers are called
+// returns the number of handlers that were called
+int Stub_TriggerCommand
+  (
+  const char *Name
+  )
+{
+  stub_command_t *Command = GetCommand(Name);
+  if (Command == NULL) return 0;
+  int Called = CallHandlers(Command, xplm_CommandBegin);
+  CallHandlers(Command, xplm_CommandEnd);
+  return Called;
+}
+
+// returns TRUE if the plugin is holding a command down
+bool Stub_IsCommandHeld
+  (
+  const char *Name
+  )
+{
+  stub_command_t *Command = GetCommand(Name);
+  return (Command != NULL) && Command->Held;
+}
+
+// gets the number of commands the plugin is holding down
+int Stub_GetNumHeldCommands
+  (
+  void
+  )
+{
+  int Held = 0;
+  for (int c = 0; c < NumCommands; c++)
+  {
+    if (Commands[c].Held) Held++;
+  }
+  return Held;
+}
+
+// gets the number of command handlers registered by the plugin
+int Stub_GetNumHandlers
+  (
+  void
+  )
+{
+  int Registered = 0;
+  for (int c = 0; c < NumCommands; c++)
+  {
+    for (int h = 0; h < MAX_HANDLERS; h++)
+    {
+      if (Commands[c].Handlers[h].Handler != NULL) Registered++;
+    }
+  }
+  return Registered;
+}
+
+// chooses a menu item as the user would
+// returns TRUE if the item was found
+bool Stub_ChooseMenuItem
+  (
+  const char *MenuName,
+  const char *ItemName
+  )
+{
+  stub_menu_t *Menu = FindMenu(MenuName);
+  if ((Menu == NULL) || (Menu->Handler == NULL)) return FALSE;
+  int Item = FindItem(Menu, ItemName);
+  if (Item < 0) return FALSE;
+  Menu->Handler(Menu->MenuRef, Menu->Items[Item].ItemRef);
+  return TRUE;
+}
+
+// chooses one of all of the menu items that have a handler
+// returns TRUE if there are any such items
+bool Stub_ChooseMenuItemIndex
+  (
+  unsigned int Index  // wraps round the number of items
+  )
+{
+  unsigned int Total = 0;
+  for (int m = 0; m < NumMenus; m++)
+  {
+    if (Menus[m].Handler != NULL) Total += Menus[m].NumItems;
+  }
+  if (Total == 0) return FALSE;
+
+  Index %= Total;
+  for (int m = 0; m < NumMenus; m++)
+  {
+    stub_menu_t *Menu = &Menus[m];
+    if (Menu->Handler == NULL) continue;
+    if (Index < (unsigned int)Menu->NumItems)
+    {
+      Menu->Handler(Menu->MenuRef, Menu->Items[Index].ItemRef);
+      return TRUE;
+    }
+    Index -= Menu->NumItems;
+  }
+  return FALSE;
+}
+
+// returns TRUE if a menu item has a check mark
+bool Stub_IsMenuItemChecked
+  (
+  const char *MenuName,
+  const char *ItemName
+  )
+{
+  stub_menu_t *Menu = FindMenu(MenuName);
+  if (Menu == NULL) return FALSE;
+  int Item = FindItem(Menu, ItemName);
+  return (Item >= 0) && Menu->Items[Item].Checked;
+}
+
+// calls the draw callbacks of the visible windows, as x-plane does once per frame
+void Stub_DrawWindows
+  (
+  void
+  )
+{
+  NumStrings = 0;
+  for (int w = 0; w < NumWindows; w++)
+  {
+    if (Windows[w].Visible && (Windows[w].Draw != NULL)) Windows[w].Draw((XPLMWindowID)(intptr_t)(w + 1), Windows[w].Refcon);
+  }
+}
+
+// closes the visible windows with their close buttons, as the user would
+void Stub_CloseWindows
+  (
+  void
+  )
+{
+  for (int w = 0; w < NumWindows; w++) Windows[w].Visible = FALSE;
+}
+
+// gets the number of windows the plugin is showing
+int Stub_GetNumVisibleWindows
+  (
+  void
+  )
+{
+  int Visible = 0;
+  for (int w = 0; w < NumWindows; w++)
+  {
+    if (Windows[w].Visible) Visible++;
+  }
+  return Visible;
+}
+
+// gets the number of strings drawn by the last Stub_DrawWindows
+int Stub_GetNumStrings
+  (
+  void
+  )
+{
+  return NumStrings;
+}
+
+// gets a string drawn by the last Stub_DrawWindows, in the order they were drawn
+// returns an empty string if there is no such string
+const char *Stub_GetString
+  (
+  int Index
+  )
+{
+  if ((Index < 0) || (Index >= NumStrings)) return "";
+  return Strings[Index];
+}
+
+// gets the number of flight loops that are scheduled to run
+int Stub_GetNumScheduledLoops
+  (
+  void
+  )
+{
+  int Scheduled = 0;
+  for (int l = 0; l < NumLoops; l++)
+  {
+    if (Loops[l].Created && Loops[l].Scheduled) Scheduled++;
+  }
+  return Scheduled;
+}
+
+// gets the number of flight loop callbacks that have been made
+unsigned long long Stub_GetNumLoopCalls
+  (
+  void
+  )
+{
+  return NumLoopCalls;
+}
+
+// gets the number of calls the plugin has made to the SDK
+unsigned long long Stub_GetNumCalls
+  (
+  void
+  )
+{
+  return NumCalls;
+}
+
+// gets the number of times the plugin has spoken
+int Stub_GetNumSpoken
+  (
+  void
+  )
+{
+  return NumSpoken;
+}
+
+// gets the shortest time between the start of two phrases
+// returns the time in seconds, or a large number if fewer than two have been spoken
+double Stub_GetMinSpeechGap
+  (
+  void
+  )
+{
+  return MinSpeechGap;
+}
+
+// gets the number of problems found in the way the plugin uses the SDK
+int Stub_GetErrors
+  (
+  void
+  )
+{
+  int Total = 0;
+  for (int e = 0; e < NUM_STUB_ERRORS; e++) Total += Errors[e];
+  return Total;
+}
+
+// describes the problems found, or an empty string if there are none
+const char *Stub_DescribeErrors
+  (
+  void
+  )
+{
+  static const char *ErrorNames[NUM_STUB_ERRORS] =
+  {
+    "command ended that wasn't begun",
+    "command begun twice",
+    "command handler registered twice",
+    "unknown command handler unregistered",
+    "dataref accessors registered twice",
+    "bad handle"
+  };
+
+  ErrorText[0] = '\0';
+  for (int e = 0; e < NUM_STUB_ERRORS; e++)
+  {
+    if (Errors[e] == 0) continue;
+    char Line[80];
+    sprintf_s(Line, 80, "%s%s x%d", ErrorText[0] ? ", " : "", ErrorNames[e], Errors[e]);
+    strcat_s(ErrorText, 256, Line);
+  }
+  return ErrorText;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SDK
+
+// data access
+XPLMDataRef XPLMFindDataRef
+  (
+  const char *inDataRefName
+  )
+{
+  CALL();
+  return (XPLMDataRef)GetDataref(inDataRefName);
+}
+
+int XPLMGetDatai
+  (
+  XPLMDataRef inDataRef
+  )
+{
+  CALL();
+  stub_dataref_t *Dataref = (stub_dataref_t *)inDataRef;
+  if (Dataref->Registered) return Dataref->ReadInt != NULL ? Dataref->ReadInt(Dataref->ReadRefcon) : 0;
+  return Dataref->Int;
+}
+
+void XPLMSetDatai
+  (
+  XPLMDataRef inDataRef,
+  int inValue
+  )
+{
+  CALL();
+  stub_dataref_t *Dataref = (stub_dataref_t *)inDataRef;
+  if (Dataref->Registered)
+  {
+    if (Dataref->WriteInt != NULL) Dataref->WriteInt(Dataref->WriteRefcon, inValue);
+    return;
+  }
+  Dataref->Int = inValue;
+}
+
+float XPLMGetDataf
+  (
+  XPLMDataRef inDataRef
+  )
+{
+  CALL();
+  stub_dataref_t *Dataref = (stub_dataref_t *)inDataRef;
+  if (Dataref->Registered) return Dataref->ReadFloat != NULL ? Dataref->ReadFloat(Dataref->ReadRefcon) : 0;
+  return Dataref->Float;
+}
+
+void XPLMSetDataf
+  (
+  XPLMDataRef inDataRef,
+  float inValue
+  )
+{
+  CALL();
+  stub_dataref_t *Dataref = (stub_dataref_t *)inDataRef;
+  if (Dataref->Registered)
+  {
+    if (Dataref->WriteFloat != NULL) Dataref->WriteFloat(Dataref->WriteRefcon, inValue);
+    return;
+  }
+  Dataref->Float = inValue;
+}
+
+int XPLMGetDatavf
+  (
+  XPLMDataRef inDataRef,
+  float *outValues,
+  int inOffset,
+  int inMax
+  )
+{
+  CALL();
+  stub_dataref_t *Dataref = (stub_dataref_t *)inDataRef;
+  if (outValues == NULL) return STUB_MAX_ARRAY;
+  int Count = 0;
+  for (int v = inOffset; (v < STUB_MAX_ARRAY) && (Count < inMax); v++) outValues[Count++] = Dataref->FloatArray[v];
+  return Count;
+}
+
+void XPLMSetDatavf
+  (
+  XPLMDataRef inDataRef,
+  float *inValues,
+  int inoffset,
+  int inCount
+  )
+{
+  CALL();
+  stub_dataref_t *Dataref = (stub_dataref_t *)inDataRef;
+  for (int v = 0; (v < inCount) && (inoffset + v < STUB_MAX_ARRAY); v++) Dataref->FloatArray[inoffset + v] = inValues[v];
+}
+
+int XPLMGetDatavi
+  (
+  XPLMDataRef inDataRef,
+  int *outValues,
+  int inOffset,
+  int inMax
+  )
+{
+  CALL();
+  stub_dataref_t *Dataref = (stub_dataref_t *)inDataRef;
+  if (outValues == NULL) return STUB_MAX_ARRAY;
+  int Count = 0;
+  for (int v = inOffset; (v < STUB_MAX_ARRAY) && (Count < inMax); v++) outValues[Count++] = Dataref->IntArray[v];
+  return Count;
+}
+
+void XPLMSetDatavi
+  (
+  XPLMDataRef inDataRef,
+  int *inValues,
+  int inoffset,
+  int inCount
+  )
+{
+  CALL();
+  stub_dataref_t *Dataref = (stub_dataref_t *)inDataRef;
+  for (int v = 0; (v < inCount) && (inoffset + v < STUB_MAX_ARRAY); v++) Dataref->IntArray[inoffset + v] = inValues[v];
+}
+
+int XPLMGetDatab
+  (
+  XPLMDataRef inDataRef,
+  void *outValue,
+  int inOffset,
+  int inMaxBytes
+  )
+{
+  CALL();
+  stub_dataref_t *Dataref = (stub_dataref_t *)inDataRef;
+  if (outValue == NULL) return MAX_BYTES;
+  int Count = 0;
+  for (int b = inOffset; (b < MAX_BYTES) && (Count < inMaxBytes); b++) ((char *)outValue)[Count++] = Dataref->Bytes[b];
+  return Count;
+}
+
+XPLMDataRef XPLMRegisterDataAccessor
+  (
+  const char *inDataName,
+  XPLMDataTypeID inDataType,
+  int inIsWritable,
+  XPLMGetDatai_f inReadInt,
+  XPLMSetDatai_f inWriteInt,
+  XPLMGetDataf_f inReadFloat,
+  XPLMSetDataf_f inWriteFloat,
+  XPLMGetDatad_f inReadDouble,
+  XPLMSetDatad_f inWriteDouble,
+  XPLMGetDatavi_f inReadIntArray,
+  XPLMSetDatavi_f inWriteIntArray,
+  XPLMGetDatavf_f inReadFloatArray,
+  XPLMSetDatavf_f inWriteFloatArray,
+  XPLMGetDatab_f inReadData,
+  XPLMSetDatab_f inWriteData,
+  void *inReadRefcon,
+  void *inWriteRefcon
+  )
+{
+  CALL();
+  stub_dataref_t *Dataref = GetDataref(inDataName);
+  if (Dataref == NULL) return NULL;
+  if (Dataref->Registered) AddError(STUB_ERROR_ACCESSOR_TWICE);
+
+  Dataref->Registered = TRUE;
+  Dataref->ReadInt = inReadInt;
+  Dataref->WriteInt = inIsWritable ? inWriteInt : NULL;
+  Dataref->ReadFloat = inReadFloat;
+  Dataref->WriteFloat = inIsWritable ? inWriteFloat : NULL;
+  Dataref->ReadRefcon = inReadRefcon;
+  Dataref->WriteRefcon = inWriteRefcon;
+  return (XPLMDataRef)Dataref;
+}
+
+void XPLMUnregisterDataAccessor
+  (
+  XPLMDataRef inDataRef
+  )
+{
+  CALL();
+  stub_dataref_t *Dataref = (stub_dataref_t *)inDataRef;
+  if ((Dataref == NULL) || (Dataref->Registered == FALSE))
+  {
+    AddError(STUB_ERROR_BAD_HANDLE);
+    return;
+  }
+  Dataref->Registered = FALSE;
+}
+
+// menus
+XPLMMenuID XPLMFindPluginsMenu
+  (
+  void
+  )
+{
+  CALL();
+  return (XPLMMenuID)(intptr_t)1;
+}
+
+XPLMMenuID XPLMCreateMenu
+  (
+  const char *inName,
+  XPLMMenuID inParentMenu,
+  int inParentItem,
+  XPLMMenuHandler_f inHandler,
+  void *inMenuRef
+  )
+{
+  CALL();
+  if (NumMenus == MAX_MENUS) return NULL;
+  stub_menu_t *Menu = &Menus[NumMenus++];
+  strcpy_s(Menu->Name, STUB_MAX_NAME, inName);
+  Menu->Handler = inHandler;
+  Menu->MenuRef = inMenuRef;
+  Menu->NumItems = 0;
+  return (XPLMMenuID)(intptr_t)NumMenus;
+}
+
+int XPLMAppendMenuItem
+  (
+  XPLMMenuID inMenu,
+  const char *inItemName,
+  void *inItemRef,
+  int inDeprecatedAndIgnored
+  )
+{
+  CALL();
+  stub_menu_t *Menu = GetMenu(inMenu);
+  if ((Menu == NULL) || (Menu->NumItems == MAX_ITEMS)) return -1;
+  stub_item_t *Item = &Menu->Items[Menu->NumItems];
+  strcpy_s(Item->Name, STUB_MAX_NAME, inItemName);
+  Item->ItemRef = inItemRef;
+  Item->Checked = FALSE;
+  return Menu->NumItems++;
+}
+
+void XPLMCheckMenuItem
+  (
+  XPLMMenuID inMenu,
+  int index,
+  XPLMMenuCheck inCheck
+  )
+{
+  CALL();
+  stub_menu_t *Menu = GetMenu(inMenu);
+  if ((Menu == NULL) || (index < 0) || (index >= Menu->NumItems))
+  {
+    AddError(STUB_ERROR_BAD_HANDLE);
+    return;
+  }
+  Menu->Items[index].Checked = (inCheck == xplm_Menu_Checked);
+}
+
+// processing
+float XPLMGetElapsedTime
+  (
+  void
+  )
+{
+  CALL();
+  return (float)Now;
+}
+
+XPLMFlightLoopID XPLMCreateFlightLoop
+  (
+  XPLMCreateFlightLoop_t *inParams
+  )
+{
+  CALL();
+  if (NumLoops == MAX_LOOPS) return NULL;
+  stub_loop_t *Loop = &Loops[NumLoops++];
+  Loop->Created = TRUE;
+  Loop->Callback = inParams->callbackFunc;
+  Loop->Refcon = inParams->refcon;
+  Loop->Scheduled = FALSE;
+  Loop->LastCall = Now;
+  Loop->Counter = 0;
+  return (XPLMFlightLoopID)Loop;
+}
+
+void XPLMDestroyFlightLoop
+  (
+  XPLMFlightLoopID inFlightLoopID
+  )
+{
+  CALL();
+  stub_loop_t *Loop = GetLoop(inFlightLoopID);
+  if (Loop == NULL) return;
+  Loop->Created = FALSE;
+  Loop->Scheduled = FALSE;
+}
+
+void XPLMScheduleFlightLoop
+  (
+  XPLMFlightLoopID inFlightLoopID,
+  float inInterval,
+  int inRelativeToNow
+  )
+{
+  CALL();
+  stub_loop_t *Loop = GetLoop(inFlightLoopID);
+  if (Loop == NULL) return;
+  ScheduleLoop(Loop, inInterval, inRelativeToNow ? Now : Loop->LastCall);
+}
+
+// commands
+XPLMCommandRef XPLMFindCommand
+  (
+  const char *inName
+  )
+{
+  CALL();
+  return (XPLMCommandRef)GetCommand(inName);
+}
+
+XPLMCommandRef XPLMCreateCommand
+  (
+  const char *inName,
+  const char *inDescription
+  )
+{
+  CALL();
+  return (XPLMCommandRef)GetCommand(inName);
+}
+
+void XPLMCommandBegin
+  (
+  XPLMCommandRef inCommand
+  )
+{
+  CALL();
+  stub_command_t *Command = (stub_command_t *)inCommand;
+  if (Command->Held) AddError(STUB_ERROR_BEGUN_TWICE);
+  Command->Held = TRUE;
+  CallHandlers(Command, xplm_CommandBegin);
+}
+
+void XPLMCommandEnd
+  (
+  XPLMCommandRef inCommand
+  )
+{
+  CALL();
+  stub_command_t *Command = (stub_command_t *)inCommand;
+  if (Command->Held == FALSE) AddError(STUB_ERROR_END_NOT_BEGUN);
+  Command->Held = FALSE;
+  CallHandlers(Command, xplm_CommandEnd);
+}
+
+void XPLMCommandOnce
+  (
+  XPLMCommandRef inCommand
+  )
+{
+  CALL();
+  stub_command_t *Command = (stub_command_t *)inCommand;
+  CallHandlers(Command, xplm_CommandBegin);
+  CallHandlers(Command, xplm_CommandEnd);
+}
+
+void XPLMRegisterCommandHandler
+  (
+  XPLMCommandRef inComand,
+  XPLMCommandCallback_f inHandler,
+  int inBefore,
+  void *inRefcon
+  )
+{
+  CALL();
+  stub_command_t *Command = (stub_command_t *)inComand;
+  if (Command == NULL)
+  {
+    AddError(STUB_ERROR_BAD_HANDLE);
+    return;
+  }
+
+  stub_handler_t *Free = NULL;
+  for (int h = 0; h < MAX_HANDLERS; h++)
+  {
+    stub_handler_t *Handler = &Command->Handlers[h];
+    if ((Handler->Handler == inHandler) && (Handler->Before == inBefore) && (Handler->Refcon == inRefcon))
+    {
+      AddError(STUB_ERROR_HANDLER_TWICE);
+      return;
+    }
+    if ((Handler->Handler == NULL) && (Free == NULL)) Free = Handler;
+  }
+  if (Free == NULL) return;
+  Free->Handler = inHandler;
+  Free->Before = inBefore;
+  Free->Refcon = inRefcon;
+}
+
+void XPLMUnregisterCommandHandler
+  (
+  XPLMCommandRef inComand,
+  XPLMCommandCallback_f inHandler,
+  int inBefore,
+  void *inRefcon
+  )
+{
+  CALL();
+  stub_command_t *Command = (stub_command_t *)inComand;
+  if (Command != NULL)
+  {
+    for (int h = 0; h < MAX_HANDLERS; h++)
+    {
+      stub_handler_t *Handler = &Command->Handlers[h];
+      if ((Handler->Handler == inHandler) && (Handler->Before == inBefore) && (Handler->Refcon == inRefcon))
+      {
+        Handler->Handler = NULL;
+        return;
+      }
+    }
+  }
+  AddError(STUB_ERROR_HANDLER_UNKNOWN);
+}
+
+// utilities
+void XPLMSpeakString
+  (
+  const char *inString
+  )
+{
+  CALL();
+  if ((NumSpoken > 0) && (Now - LastSpoken < MinSpeechGap)) MinSpeechGap = Now - LastSpoken;
+  LastSpoken = Now;
+  NumSpoken++;
+}
+
+void XPLMDebugString
+  (
+  const char *inString
+  )
+{
+  CALL();
+  if (Log != NULL) fputs(inString, Log);
+}
+
+void XPLMGetSystemPath
+  (
+  char *outSystemPath
+  )
+{
+  CALL();
+  sprintf_s(outSystemPath, MAX_PATH_LENGTH, "%s/", Folder);
+}
+
+void XPLMGetPrefsPath
+  (
+  char *outPrefsPath
+  )
+{
+  CALL();
+  sprintf_s(outPrefsPath, MAX_PATH_LENGTH, "%s/X-Plane.prf", Folder);
+}
+
+const char *XPLMGetDirectorySeparator
+  (
+  void
+  )
+{
+  CALL();
+  return "/";
+}
+
+char *XPLMExtractFileAndPath
+  (
+  char *inFullPath
+  )
+{
+  CALL();
+  char *Separator = strrchr(inFullPath, '/');
+  if (Separator == NULL) return inFullPath;
+  *Separator = '\0';
+  return Separator + 1;
+}
+
+// windows
+XPLMWindowID XPLMCreateWindowEx
+  (
+  XPLMCreateWindow_t *inParams
+  )
+{
+  CALL();
+  if (NumWindows == MAX_WINDOWS) return NULL;
+  stub_window_t *Window = &Windows[NumWindows++];
+  Window->Visible = inParams->visible != 0;
+  Window->Draw = inParams->drawWindowFunc;
+  Window->Refcon = inParams->refcon;
+  Window->Left = inParams->left;
+  Window->Top = inParams->top;
+  Window->Right = inParams->right;
+  Window->Bottom = inParams->bottom;
+  return (XPLMWindowID)(intptr_t)NumWindows;
+}
+
+void XPLMSetWindowIsVisible
+  (
+  XPLMWindowID inWindowID,
+  int inIsVisible
+  )
+{
+  CALL();
+  stub_window_t *Window = GetWindow(inWindowID);
+  if (Window != NULL) Window->Visible = inIsVisible != 0;
+}
+
+int XPLMGetWindowIsVisible
+  (
+  XPLMWindowID inWindowID
+  )
+{
+  CALL();
+  stub_window_t *Window = GetWindow(inWindowID);
+  return (Window != NULL) && Window->Visible;
+}
+
+void XPLMSetWindowPositioningMode
+  (
+  XPLMWindowID inWindowID,
+  XPLMWindowPositioningMode inPositioningMode,
+  int inMonitorIndex
+  )
+{
+  CALL();
+  GetWindow(inWindowID);
+}
+
+void XPLMSetWindowGeometry
+  (
+  XPLMWindowID inWindowID,
+  int inLeft,
+  int inTop,
+  int inRight,
+  int inBottom
+  )
+{
+  CALL();
+  stub_window_t *Window = GetWindow(inWindowID);
+  if (Window == NULL) return;
+  Window->Left = inLeft;
+  Window->Top = inTop;
+  Window->Right = inRight;
+  Window->Bottom = inBottom;
+}
+
+void XPLMSetWindowGeometryVR
+  (
+  XPLMWindowID inWindowID,
+  int widthBoxels,
+  int heightBoxels
+  )
+{
+  CALL();
+  stub_window_t *Window = GetWindow(inWindowID);
+  if (Window == NULL) return;
+  Window->Right = Window->Left + widthBoxels;
+  Window->Bottom = Window->Top - heightBoxels;
+}
+
+void XPLMGetWindowGeometry
+  (
+  XPLMWindowID inWindowID,
+  int *outLeft,
+  int *outTop,
+  int *outRight,
+  int *outBottom
+  )
+{
+  CALL();
+  stub_window_t *Window = GetWindow(inWindowID);
+  if (Window == NULL) return;
+  if (outLeft != NULL) *outLeft = Window->Left;
+  if (outTop != NULL) *outTop = Window->Top;
+  if (outRight != NULL) *outRight = Window->Right;
+  if (outBottom != NULL) *outBottom = Window->Bottom;
+}
+
+void XPLMSetWindowTitle
+  (
+  XPLMWindowID inWindowID,
+  const char *inWindowTitle
+  )
+{
+  CALL();
+  GetWindow(inWindowID);
+}
+
+void XPLMGetScreenBoundsGlobal
+  (
+  int *outLeft,
+  int *outTop,
+  int *outRight,
+  int *outBottom
+  )
+{
+  CALL();
+  if (outLeft != NULL) *outLeft = 0;
+  if (outTop != NULL) *outTop = SCREEN_HEIGHT;
+  if (outRight != NULL) *outRight = SCREEN_WIDTH;
+  if (outBottom != NULL) *outBottom = 0;
+}
+
+// graphics
+void XPLMDrawString
+  (
+  float *inColorRGB,
+  int inXOffset,
+  int inYOffset,
+  char *inChar,
+  int *inWordWrapWidth,
+  XPLMFontID inFontID
+  )
+{
+  CALL();
+  if (NumStrings < MAX_STRINGS) snprintf(Strings[NumStrings++], MAX_STRING_LENGTH, "%s", inChar);
+}
+
+void XPLMSetGraphicsState
+  (
+  int inEnableFog,
+  int inNumberTexUnits,
+  int inEnableLighting,
+  int inEnableAlphaTesting,
+  int inEnableAlphaBlending,
+  int inEnableDepthTesting,
+  int inEnableDepthWriting
+  )
+{
+  CALL();
+}
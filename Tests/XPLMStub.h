@@ -0,0 +1,240 @@
+#ifndef _XPLMSTUBH_
+#define _XPLMSTUBH_
+
+#include "Global.h"
+#include "Clock.h"
+
+// longest dataref and command name
+#define STUB_MAX_NAME 128
+// most values in an array dataref
+#define STUB_MAX_ARRAY 16
+
+// problems found in the way the plugin uses the SDK, counted by Stub_GetErrors
+typedef enum _stub_error_t
+{
+  STUB_ERROR_END_NOT_BEGUN,       // a command was ended that wasn't begun
+  STUB_ERROR_BEGUN_TWICE,         // a command was begun while it was already held
+  STUB_ERROR_HANDLER_TWICE,       // the same command handler was registered twice
+  STUB_ERROR_HANDLER_UNKNOWN,     // a command handler was unregistered that wasn't registered
+  STUB_ERROR_ACCESSOR_TWICE,      // a dataref was registered that already has accessors
+  STUB_ERROR_BAD_HANDLE,          // a NULL or destroyed handle was used
+  NUM_STUB_ERRORS
+} stub_error_t;
+
+// the plugin's callbacks, in Main.cpp
+PLUGIN_API int XPluginStart(char *outName, char *outSig, char *outDesc);
+PLUGIN_API void XPluginStop(void);
+PLUGIN_API void XPluginDisable(void);
+PLUGIN_API int XPluginEnable(void);
+PLUGIN_API void XPluginReceiveMessage(XPLMPluginID inFromWho, int inMessage, void *inParam);
+
+// starts the stub with no datarefs, commands, flight loops, menus or windows
+extern void Stub_Init
+  (
+  const char *Folder  // folder used for the preferences, the log and the profile report
+  );
+
+// starts the stub in a new folder, then starts and enables the plugin with its clock reading the stub
+// returns TRUE for success, FALSE for error
+extern bool Stub_StartPlugin
+  (
+  void
+  );
+
+// disables and stops the plugin and removes the folder made by Stub_StartPlugin
+extern void Stub_StopPlugin
+  (
+  void
+  );
+
+// runs one frame, the time moves on and the flight loops that are due are called
+extern void Stub_RunFrame
+  (
+  float Seconds  // length of the frame
+  );
+
+// gets the time since the stub was started
+// returns the time in seconds
+extern double Stub_GetTime
+  (
+  void
+  );
+
+// reads the time from the stub instead of the computer's clock, see Clock_SetSource
+// the pause and time compression come from the usual x-plane datarefs
+extern void Stub_ReadClock
+  (
+  clock_sample_t *Sample
+  );
+
+// sets the value of a dataref as x-plane would, accessors registered by the plugin are called
+extern void Stub_SetDataf
+  (
+  const char *Name,
+  float Value
+  );
+extern void Stub_SetDatai
+  (
+  const char *Name,
+  int Value
+  );
+extern void Stub_SetDatavf
+  (
+  const char *Name,
+  const float *Values,
+  int Count
+  );
+extern void Stub_SetDatavi
+  (
+  const char *Name,
+  const int *Values,
+  int Count
+  );
+extern void Stub_SetDatab
+  (
+  const char *Name,
+  const char *Text
+  );
+
+// gets the value of a dataref, accessors registered by the plugin are called
+extern float Stub_GetDataf
+  (
+  const char *Name
+  );
+extern int Stub_GetDatai
+  (
+  const char *Name
+  );
+extern float Stub_GetDatavf
+  (
+  const char *Name,
+  int Index
+  );
+extern int Stub_GetDatavi
+  (
+  const char *Name,
+  int Index
+  );
+
+// presses and releases a command as the user would, the registered handlers are called
+// returns the number of handlers that were called
+extern int Stub_TriggerCommand
+  (
+  const char *Name
+  );
+
+// returns TRUE if the plugin is holding a command down
+extern bool Stub_IsCommandHeld
+  (
+  const char *Name
+  );
+
+// gets the number of commands the plugin is holding down
+extern int Stub_GetNumHeldCommands
+  (
+  void
+  );
+
+// gets the number of command handlers registered by the plugin
+extern int Stub_GetNumHandlers
+  (
+  void
+  );
+
+// chooses a menu item as the user would
+// returns TRUE if the item was found
+extern bool Stub_ChooseMenuItem
+  (
+  const char *MenuName,
+  const char *ItemName
+  );
+
+// chooses one of all of the menu items that have a handler
+// returns TRUE if there are any such items
+extern bool Stub_ChooseMenuItemIndex
+  (
+  unsigned int Index  // wraps round the number of items
+  );
+
+// returns TRUE if a menu item has a check mark
+extern bool Stub_IsMenuItemChecked
+  (
+  const char *MenuName,
+  const char *ItemName
+  );
+
+// calls the draw callbacks of the visible windows, as x-plane does once per frame
+extern void Stub_DrawWindows
+  (
+  void
+  );
+
+// closes the visible windows with their close buttons, as the user would
+extern void Stub_CloseWindows
+  (
+  void
+  );
+
+// gets the number of windows the plugin is showing
+extern int Stub_GetNumVisibleWindows
+  (
+  void
+  );
+
+// gets the number of strings drawn by the last Stub_DrawWindows
+extern int Stub_GetNumStrings
+  (
+  void
+  );
+
+// gets a string drawn by the last Stub_DrawWindows, in the order they were drawn
+// returns an empty string if there is no such string
+extern const char *Stub_GetString
+  (
+  int Index
+  );
+
+// gets the number of flight loops that are scheduled to run
+extern int Stub_GetNumScheduledLoops
+  (
+  void
+  );
+
+// gets the number of flight loop callbacks that have been made
+extern unsigned long long Stub_GetNumLoopCalls
+  (
+  void
+  );
+
+// gets the number of calls the plugin has made to the SDK
+extern unsigned long long Stub_GetNumCalls
+  (
+  void
+  );
+
+// gets the number of times the plugin has spoken
+extern int Stub_GetNumSpoken
+  (
+  void
+  );
+
+// gets the shortest time between the start of two phrases
+// returns the time in seconds, or a large number if fewer than two have been spoken
+extern double Stub_GetMinSpeechGap
+  (
+  void
+  );
+
+// gets the number of problems found in the way the plugin uses the SDK
+extern int Stub_GetErrors
+  (
+  void
+  );
+
+// describes the problems found, or an empty string if there are none
+extern const char *Stub_DescribeErrors
+  (
+  void
+  );
+
+#endif // _XPLMSTUBH_
@@ -0,0 +1,286 @@
+// TEXT WINDOW
+
+// Small windows of text for showing information to the user, in VR when it
+// is in use. The windows follow the user into and out of VR
+// The lines are worked out by the module that owns the window, when what
+// they show changes. Drawing, which x-plane does every frame, just draws the
+// lines
+
+#include <stdarg.h>
+#include "XPLMGraphics.h"
+#include "TextWindow.h"
+#include "Diagnostic.h"
+
+// most windows that can be created
+#define MAX_WINDOWS 4
+// space between the edge of the window and the text
+#define MARGIN 10
+// distance between lines
+#define LINE_HEIGHT 16
+
+static float NormalColor[3]    = { 1.0f, 1.0f, 1.0f };
+static float HighlightColor[3] = { 1.0f, 0.7f, 0.0f };
+
+static XPLMDataRef VREnabledRef = NULL;
+
+// all of the windows, so they can be moved into and out of VR
+static text_window_t *Windows[MAX_WINDOWS];
+static int NumWindows = 0;
+// windows that were hidden when the plugin was disabled, to show again when enabled
+static bool HiddenByDisable[MAX_WINDOWS];
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL FUNCTIONS
+
+// puts a window in VR or on the monitor
+static void PositionWindow
+  (
+  text_window_t *TextWindow,
+  bool InVR                   // TRUE if VR is in use
+  )
+{
+  if (InVR)
+  {
+    XPLMSetWindowPositioningMode(TextWindow->Window, xplm_WindowVR, -1);
+    XPLMSetWindowGeometryVR(TextWindow->Window, TextWindow->Width, TextWindow->Height);
+  }
+  else
+  {
+    int Left, Top, Right, Bottom;
+    XPLMGetScreenBoundsGlobal(&Left, &Top, &Right, &Bottom);
+
+    Left += TextWindow->ScreenX;
+    Top -= TextWindow->ScreenY;
+    XPLMSetWindowPositioningMode(TextWindow->Window, xplm_WindowPositionFree, -1);
+    XPLMSetWindowGeometry(TextWindow->Window, Left, Top, Left + TextWindow->Width, Top - TextWindow->Height);
+  }
+}
+
+// draws a window, called by x-plane every frame while it is visible
+static void DrawWindow
+  (
+  XPLMWindowID inWindowID,
+  void *inRefcon              // the text window
+  )
+{
+  text_window_t *TextWindow = (text_window_t *)inRefcon;
+
+  if (TextWindow->BeforeDraw != NULL) TextWindow->BeforeDraw();
+
+  int Left, Top, Right, Bottom;
+  XPLMGetWindowGeometry(inWindowID, &Left, &Top, &Right, &Bottom);
+
+  XPLMSetGraphicsState(0, 0, 0, 0, 1, 0, 0);
+  for (int l = 0; l < TextWindow->NumLines; l++)
+  {
+    text_window_line_t *Line = &TextWindow->Lines[l];
+    XPLMDrawString(Line->Highlight ? HighlightColor : NormalColor, Left + Line->X, Top - Line->Y,
+      Line->Text, NULL, xplmFont_Proportional);
+  }
+}
+
+// called when a window is clicked, the clicks are used so they don't go through to the cockpit
+static int HandleMouseClick
+  (
+  XPLMWindowID inWindowID,
+  int x,
+  int y,
+  XPLMMouseStatus inMouse,
+  void *inRefcon              // the text window
+  )
+{
+  text_window_t *TextWindow = (text_window_t *)inRefcon;
+
+  if (TextWindow->CloseOnClick && (inMouse == xplm_MouseUp)) XPLMSetWindowIsVisible(inWindowID, 0);
+  return 1;
+}
+
+// called when a key is pressed while a window has focus
+static void HandleKey
+  (
+  XPLMWindowID inWindowID,
+  char inKey,
+  XPLMKeyFlags inFlags,
+  char inVirtualKey,
+  void *inRefcon,
+  int losingFocus
+  )
+{
+}
+
+// called to get the cursor over a window
+static XPLMCursorStatus HandleCursor
+  (
+  XPLMWindowID inWindowID,
+  int x,
+  int y,
+  void *inRefcon
+  )
+{
+  return xplm_CursorDefault;
+}
+
+// called when the mouse wheel is used over a window, passed on to x-plane
+static int HandleMouseWheel
+  (
+  XPLMWindowID inWindowID,
+  int x,
+  int y,
+  int wheel,
+  int clicks,
+  void *inRefcon
+  )
+{
+  return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MODULE API
+
+// creates a hidden window
+// the structure must stay in place while the plugin runs
+// returns TRUE for success, FALSE for error
+int TextWindow_Create
+  (
+  text_window_t *TextWindow,
+  int Width,                  // boxels
+  int Height,
+  int ScreenX,                // position on the monitor from the top left of the screen
+  int ScreenY,
+  bool CloseOnClick,          // TRUE to hide the window when it is clicked
+  void (*BeforeDraw)(void)    // called before drawing to update the lines, or NULL
+  )
+{
+  if (NumWindows >= MAX_WINDOWS) return FALSE;
+
+  if (VREnabledRef == NULL)
+  {
+    VREnabledRef = XPLMFindDataRef("sim/graphics/VR/enabled");
+    if (VREnabledRef == NULL)
+    {
+      return FALSE;
+    }
+  }
+
+  TextWindow->Width = Width;
+  TextWindow->Height = Height;
+  TextWindow->ScreenX = ScreenX;
+  TextWindow->ScreenY = ScreenY;
+  TextWindow->CloseOnClick = CloseOnClick;
+  TextWindow->BeforeDraw = BeforeDraw;
+  TextWindow->NumLines = 0;
+
+  XPLMCreateWindow_t Params;
+  Params.structSize = sizeof(Params);
+  Params.left = 0;
+  Params.top = Height;
+  Params.right = Width;
+  Params.bottom = 0;
+  Params.visible = 0;
+  Params.drawWindowFunc = DrawWindow;
+  Params.handleMouseClickFunc = HandleMouseClick;
+  Params.handleKeyFunc = HandleKey;
+  Params.handleCursorFunc = HandleCursor;
+  Params.handleMouseWheelFunc = HandleMouseWheel;
+  Params.refcon = TextWindow;
+  Params.decorateAsFloatingWindow = xplm_WindowDecorationRoundRectangle;
+  Params.layer = xplm_WindowLayerFloatingWindows;
+  Params.handleRightClickFunc = HandleMouseClick;
+  TextWindow->Window = XPLMCreateWindowEx(&Params);
+  if (TextWindow->Window == NULL)
+  {
+    return FALSE;
+  }
+  XPLMSetWindowTitle(TextWindow->Window, PLUGIN_NAME);
+
+  Windows[NumWindows++] = TextWindow;
+
+  return TRUE;
+}
+
+// removes all of the lines
+void TextWindow_Clear
+  (
+  text_window_t *TextWindow
+  )
+{
+  TextWindow->NumLines = 0;
+}
+
+// adds a line below the others, does nothing if there are already too many
+void TextWindow_AddLine
+  (
+  text_window_t *TextWindow,
+  int Indent,                 // boxels from the margin
+  bool Highlight,             // TRUE to draw it in the highlight color
+  const char *Format,
+  ...
+  )
+{
+  if (TextWindow->NumLines >= TEXT_WINDOW_MAX_LINES) return;
+
+  text_window_line_t *Line = &TextWindow->Lines[TextWindow->NumLines];
+  va_list Args;
+  va_start(Args, Format);
+  vsnprintf(Line->Text, TEXT_WINDOW_MAX_LINE_LENGTH, Format, Args);
+  va_end(Args);
+
+  Line->X = MARGIN + Indent;
+  Line->Y = MARGIN + ((TextWindow->NumLines + 1) * LINE_HEIGHT);
+  Line->Highlight = Highlight;
+  TextWindow->NumLines++;
+}
+
+// shows or hides a window, it is shown in VR if VR is in use
+void TextWindow_SetVisible
+  (
+  text_window_t *TextWindow,
+  bool Visible                // TRUE to show
+  )
+{
+  if (Visible) PositionWindow(TextWindow, XPLMGetDatai(VREnabledRef) != 0);
+  XPLMSetWindowIsVisible(TextWindow->Window, Visible);
+}
+
+// returns TRUE if a window is showing, it may have been closed by the user
+bool TextWindow_IsVisible
+  (
+  text_window_t *TextWindow
+  )
+{
+  return XPLMGetWindowIsVisible(TextWindow->Window) != 0;
+}
+
+// called when an event is published, see Events.cpp
+void TextWindow_HandleEvent
+  (
+  const event_t *Event
+  )
+{
+  // move the windows into or out of VR with the user, VR is still enabled when exiting
+  if ((Event->Type == EVENT_ENTERED_VR) || (Event->Type == EVENT_EXITING_VR))
+  {
+    for (int w = 0; w < NumWindows; w++)
+    {
+      if (TextWindow_IsVisible(Windows[w])) PositionWindow(Windows[w], Event->Type == EVENT_ENTERED_VR);
+    }
+  }
+  // nothing is shown while disabled
+  else if (Event->Type == EVENT_PLUGIN_DISABLED)
+  {
+    for (int w = 0; w < NumWindows; w++)
+    {
+      HiddenByDisable[w] = TextWindow_IsVisible(Windows[w]);
+      if (HiddenByDisable[w]) TextWindow_SetVisible(Windows[w], FALSE);
+    }
+  }
+  else if (Event->Type == EVENT_PLUGIN_ENABLED)
+  {
+    for (int w = 0; w < NumWindows; w++)
+    {
+      if (HiddenByDisable[w]) TextWindow_SetVisible(Windows[w], TRUE);
+      HiddenByDisable[w] = FALSE;
+    }
+  }
+}
@@ -0,0 +1,87 @@
+#ifndef _TEXTWINDOWH_
+#define _TEXTWINDOWH_
+
+#include "Global.h"
+#include "XPLMDisplay.h"
+#include "Events.h"
+
+// most lines in a window
+#define TEXT_WINDOW_MAX_LINES 12
+// longest line
+#define TEXT_WINDOW_MAX_LINE_LENGTH 64
+// indent for the details of a line, in boxels
+#define TEXT_WINDOW_INDENT 12
+
+// a line of text and where it goes, relative to the top left of the window
+typedef struct _text_window_line_t
+{
+  char Text[TEXT_WINDOW_MAX_LINE_LENGTH];
+  int X;
+  int Y;
+  bool Highlight;
+} text_window_line_t;
+
+// a window that shows lines of text, in VR when VR is in use
+typedef struct _text_window_t
+{
+  XPLMWindowID Window;
+  int Width;                  // boxels
+  int Height;
+  int ScreenX;                // position on the monitor from the top left of the screen
+  int ScreenY;
+  bool CloseOnClick;          // TRUE to hide the window when it is clicked
+  void (*BeforeDraw)(void);   // called before drawing to update the lines, or NULL
+  text_window_line_t Lines[TEXT_WINDOW_MAX_LINES];
+  int NumLines;
+} text_window_t;
+
+// creates a hidden window
+// the structure must stay in place while the plugin runs
+// returns TRUE for success, FALSE for error
+extern int TextWindow_Create
+  (
+  text_window_t *TextWindow,
+  int Width,                  // boxels
+  int Height,
+  int ScreenX,                // position on the monitor from the top left of the screen
+  int ScreenY,
+  bool CloseOnClick,          // TRUE to hide the window when it is clicked
+  void (*BeforeDraw)(void)    // called before drawing to update the lines, or NULL
+  );
+
+// removes all of the lines
+extern void TextWindow_Clear
+  (
+  text_window_t *TextWindow
+  );
+
+// adds a line below the others, does nothing if there are already too many
+extern void TextWindow_AddLine
+  (
+  text_window_t *TextWindow,
+  int Indent,                 // boxels from the margin
+  bool Highlight,             // TRUE to draw it in the highlight color
+  const char *Format,
+  ...
+  );
+
+// shows or hides a window, it is shown in VR if VR is in use
+extern void TextWindow_SetVisible
+  (
+  text_window_t *TextWindow,
+  bool Visible                // TRUE to show
+  );
+
+// returns TRUE if a window is showing, it may have been closed by the user
+extern bool TextWindow_IsVisible
+  (
+  text_window_t *TextWindow
+  );
+
+// called when an event is published, see Events.cpp
+extern void TextWindow_HandleEvent
+  (
+  const event_t *Event
+  );
+
+#endif // _TEXTWINDOWH_
@@ -0,0 +1,17 @@
+// TIMING
+
+// High resolution timer for measuring the execution time of the plugin
+// XPLMGetElapsedTime() only changes once per frame so it can't be used for this
+
+#include <chrono>
+#include "Timing.h"
+
+// gets a high resolution time for measuring how long our code takes
+// returns the time in seconds from an arbitrary starting point
+double Timing_GetTime
+  (
+  void
+  )
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,13 @@
+#ifndef _TIMINGH_
+#define _TIMINGH_
+
+#include "Global.h"
+
+// gets a high resolution time for measuring how long our code takes
+// returns the time in seconds from an arbitrary starting point
+extern double Timing_GetTime
+  (
+  void
+  );
+
+#endif // _TIMINGH_